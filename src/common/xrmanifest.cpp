@@ -0,0 +1,394 @@
+#include "xrmanifest.h"
+
+#include <string.h>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+/*** Code ********************************/
+
+#if defined(_WIN32)
+
+bool manifest_map(const char *file, manifest_map_t *out_map) {
+	out_map->data    = nullptr;
+	out_map->size    = 0;
+	out_map->mapped  = false;
+	out_map->file    = nullptr;
+	out_map->mapping = nullptr;
+	HANDLE handle = CreateFileA(file, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (handle == INVALID_HANDLE_VALUE) return false;
+
+	LARGE_INTEGER size = {};
+	if (!GetFileSizeEx(handle, &size) || size.QuadPart == 0) {
+		CloseHandle(handle);
+		return false;
+	}
+	if (size.QuadPart <= MANIFEST_INLINE_SIZE) {
+		DWORD read = 0;
+		bool  ok   = ReadFile(handle, out_map->inline_data, (DWORD)size.QuadPart, &read, nullptr) && read == (DWORD)size.QuadPart;
+		CloseHandle(handle);
+		out_map->data = ok ? out_map->inline_data : nullptr;
+		out_map->size = ok ? (size_t)read : 0;
+		return ok;
+	}
+	HANDLE mapping = CreateFileMappingA(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	void  *data    = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+	if (data == nullptr) {
+		if (mapping) CloseHandle(mapping);
+		CloseHandle(handle);
+		return false;
+	}
+	out_map->data    = (const char *)data;
+	out_map->size    = (size_t)size.QuadPart;
+	out_map->mapped  = true;
+	out_map->file    = handle;
+	out_map->mapping = mapping;
+	return true;
+}
+
+///////////////////////////////////////////
+
+void manifest_unmap(manifest_map_t *map) {
+	if (map->mapped) {
+		UnmapViewOfFile(map->data);
+		CloseHandle((HANDLE)map->mapping);
+		CloseHandle((HANDLE)map->file);
+	}
+	map->data    = nullptr;
+	map->size    = 0;
+	map->mapped  = false;
+	map->file    = nullptr;
+	map->mapping = nullptr;
+}
+
+#else
+
+bool manifest_map(const char *file, manifest_map_t *out_map) {
+	out_map->data   = nullptr;
+	out_map->size   = 0;
+	out_map->mapped = false;
+	int fd = open(file, O_RDONLY | O_CLOEXEC);
+	if (fd < 0) return false;
+
+	// Read straight away, and only stat if the file didn't fit
+	ssize_t count = read(fd, out_map->inline_data, MANIFEST_INLINE_SIZE);
+	if (count < 0) {
+		close(fd);
+		return false;
+	}
+	if (count < MANIFEST_INLINE_SIZE) {
+		close(fd);
+		out_map->data = out_map->inline_data;
+		out_map->size = (size_t)count;
+		return count > 0;
+	}
+
+	struct stat info;
+	if (fstat(fd, &info) != 0 || info.st_size == 0) {
+		close(fd);
+		return false;
+	}
+	void *data = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (data == MAP_FAILED) return false;
+
+	out_map->data   = (const char *)data;
+	out_map->size   = (size_t)info.st_size;
+	out_map->mapped = true;
+	return true;
+}
+
+///////////////////////////////////////////
+
+void manifest_unmap(manifest_map_t *map) {
+	if (map->mapped) munmap((void *)map->data, map->size);
+	map->data   = nullptr;
+	map->size   = 0;
+	map->mapped = false;
+}
+
+#endif
+
+///////////////////////////////////////////
+
+bool manifest_load_runtime(const char *file, runtime_manifest_t *out_manifest) {
+	manifest_map_t map;
+	if (!manifest_map(file, &map)) {
+		*out_manifest = {};
+		return false;
+	}
+	bool result = manifest_parse_runtime(map.data, map.size, out_manifest);
+	manifest_unmap(&map);
+	return result;
+}
+
+///////////////////////////////////////////
+
+bool manifest_parse_runtime(const char *data, size_t size, runtime_manifest_t *out_manifest) {
+	*out_manifest = {};
+	json_scan_t scan = json_scan_begin(data, size);
+	json_str_t  key, value;
+
+	if (!json_object_open(&scan)) return false;
+	while (json_object_next(&scan, &key)) {
+		if (json_str_is(key, "file_format_version") && json_string(&scan, &value)) {
+			json_str_copy(value, out_manifest->file_format_version, sizeof(out_manifest->file_format_version));
+		} else if (json_str_is(key, "runtime") && json_object_open(&scan)) {
+			while (json_object_next(&scan, &key)) {
+				if (json_str_is(key, "name") && json_string(&scan, &value)) {
+					json_str_copy(value, out_manifest->name, sizeof(out_manifest->name));
+				} else if (json_str_is(key, "library_path") && json_string(&scan, &value)) {
+					json_str_copy(value, out_manifest->library_path, sizeof(out_manifest->library_path));
+				} else if (json_str_is(key, "functions") && json_object_open(&scan)) {
+					while (json_object_next(&scan, &key)) {
+						if (json_str_is(key, "xrNegotiateLoaderRuntimeInterface") && json_string(&scan, &value))
+							json_str_copy(value, out_manifest->negotiate_function, sizeof(out_manifest->negotiate_function));
+						else json_skip(&scan);
+					}
+				} else json_skip(&scan);
+			}
+		} else json_skip(&scan);
+	}
+	return !scan.error;
+}
+
+///////////////////////////////////////////
+
+bool manifest_load_layer(const char *file, layer_manifest_t *out_manifest) {
+	manifest_map_t map;
+	if (!manifest_map(file, &map)) {
+		*out_manifest = {};
+		return false;
+	}
+	bool result = manifest_parse_layer(map.data, map.size, out_manifest);
+	manifest_unmap(&map);
+	return result;
+}
+
+///////////////////////////////////////////
+
+bool manifest_parse_layer(const char *data, size_t size, layer_manifest_t *out_manifest) {
+	*out_manifest = {};
+	json_scan_t scan = json_scan_begin(data, size);
+	json_str_t  key, value;
+
+	if (!json_object_open(&scan)) return false;
+	while (json_object_next(&scan, &key)) {
+		if (json_str_is(key, "file_format_version") && json_string(&scan, &value)) {
+			json_str_copy(value, out_manifest->file_format_version, sizeof(out_manifest->file_format_version));
+		} else if (json_str_is(key, "api_layer") && json_object_open(&scan)) {
+			while (json_object_next(&scan, &key)) {
+				if (json_str_is(key, "name") && json_string(&scan, &value)) {
+					json_str_copy(value, out_manifest->name, sizeof(out_manifest->name));
+				} else if (json_str_is(key, "library_path") && json_string(&scan, &value)) {
+					json_str_copy(value, out_manifest->library_path, sizeof(out_manifest->library_path));
+				} else if (json_str_is(key, "api_version") && json_string(&scan, &value)) {
+					json_str_copy(value, out_manifest->api_version, sizeof(out_manifest->api_version));
+				} else if (json_str_is(key, "implementation_version") && json_string(&scan, &value)) {
+					json_str_copy(value, out_manifest->implementation_version, sizeof(out_manifest->implementation_version));
+				} else if (json_str_is(key, "description") && json_string(&scan, &value)) {
+					json_str_copy(value, out_manifest->description, sizeof(out_manifest->description));
+				} else if (json_str_is(key, "disable_environment") && json_string(&scan, &value)) {
+					json_str_copy(value, out_manifest->disable_environment, sizeof(out_manifest->disable_environment));
+				} else if (json_str_is(key, "enable_environment") && json_string(&scan, &value)) {
+					json_str_copy(value, out_manifest->enable_environment, sizeof(out_manifest->enable_environment));
+				} else json_skip(&scan);
+			}
+		} else json_skip(&scan);
+	}
+	return !scan.error && out_manifest->name[0] != '\0';
+}
+
+///////////////////////////////////////////
+
+json_scan_t json_scan_begin(const char *data, size_t size) {
+	json_scan_t result = { data, data + size, false };
+	// Skip a UTF-8 byte order mark, some Windows tools like to write one
+	if (size >= 3 && (uint8_t)data[0] == 0xEF && (uint8_t)data[1] == 0xBB && (uint8_t)data[2] == 0xBF)
+		result.at += 3;
+	return result;
+}
+
+///////////////////////////////////////////
+
+static char json_peek(json_scan_t *scan) {
+	while (scan->at < scan->end && (*scan->at == ' ' || *scan->at == '\t' || *scan->at == '\n' || *scan->at == '\r'))
+		scan->at++;
+	return scan->at < scan->end ? *scan->at : '\0';
+}
+
+///////////////////////////////////////////
+
+bool json_object_open(json_scan_t *scan) {
+	if (scan->error) return false;
+	if (json_peek(scan) != '{') return false;
+	scan->at++;
+	return true;
+}
+
+///////////////////////////////////////////
+
+bool json_object_next(json_scan_t *scan, json_str_t *out_key) {
+	if (scan->error) return false;
+
+	char ch = json_peek(scan);
+	if (ch == ',') {
+		scan->at++;
+		ch = json_peek(scan);
+	}
+	if (ch == '}') {
+		scan->at++;
+		return false;
+	}
+	if (!json_string(scan, out_key) || json_peek(scan) != ':') {
+		scan->error = true;
+		return false;
+	}
+	scan->at++;
+	return true;
+}
+
+///////////////////////////////////////////
+
+bool json_string(json_scan_t *scan, json_str_t *out_str) {
+	if (scan->error) return false;
+	if (json_peek(scan) != '"') return false;
+
+	const char *start = ++scan->at;
+	while (scan->at < scan->end && *scan->at != '"') {
+		if (*scan->at == '\\') scan->at++;
+		scan->at++;
+	}
+	if (scan->at >= scan->end) {
+		scan->error = true;
+		return false;
+	}
+	out_str->start  = start;
+	out_str->length = (size_t)(scan->at - start);
+	scan->at++;
+	return true;
+}
+
+///////////////////////////////////////////
+
+bool json_skip(json_scan_t *scan) {
+	if (scan->error) return false;
+
+	// Iterative, so a hostile file can't blow the stack with nesting
+	int32_t depth = 0;
+	do {
+		char ch = json_peek(scan);
+		if (ch == '\0') {
+			scan->error = true;
+			return false;
+		} else if (ch == '"') {
+			json_str_t str;
+			if (!json_string(scan, &str)) return false;
+		} else if (ch == '{' || ch == '[') {
+			depth++;
+			scan->at++;
+		} else if (ch == '}' || ch == ']') {
+			depth--;
+			scan->at++;
+		} else if (ch == ',' || ch == ':') {
+			if (depth == 0) { scan->error = true; return false; }
+			scan->at++;
+		} else {
+			// Numbers, true, false, null
+			while (scan->at < scan->end && strchr(",:]} \t\r\n", *scan->at) == nullptr)
+				scan->at++;
+		}
+		if (depth < 0) {
+			scan->error = true;
+			return false;
+		}
+	} while (depth > 0);
+	return true;
+}
+
+///////////////////////////////////////////
+
+bool json_str_is(json_str_t str, const char *text) {
+	size_t len = strlen(text);
+	return str.length == len && memcmp(str.start, text, len) == 0;
+}
+
+///////////////////////////////////////////
+
+static int32_t json_hex4(const char *at) {
+	int32_t result = 0;
+	for (int32_t i = 0; i < 4; i++) {
+		char    ch    = at[i];
+		int32_t digit =
+			ch >= '0' && ch <= '9' ? ch - '0'      :
+			ch >= 'a' && ch <= 'f' ? ch - 'a' + 10 :
+			ch >= 'A' && ch <= 'F' ? ch - 'A' + 10 : -1;
+		if (digit < 0) return -1;
+		result = result * 16 + digit;
+	}
+	return result;
+}
+
+///////////////////////////////////////////
+
+bool json_str_copy(json_str_t str, char *dest, size_t dest_size) {
+	const char *at  = str.start;
+	const char *end = str.start + str.length;
+	size_t      out = 0;
+
+	while (at < end) {
+		char     bytes[4];
+		int32_t  count = 1;
+		if (*at != '\\') {
+			bytes[0] = *at++;
+		} else if (at + 1 < end) {
+			char esc = at[1];
+			at += 2;
+			switch (esc) {
+			case 'b': bytes[0] = '\b'; break;
+			case 'f': bytes[0] = '\f'; break;
+			case 'n': bytes[0] = '\n'; break;
+			case 'r': bytes[0] = '\r'; break;
+			case 't': bytes[0] = '\t'; break;
+			case 'u': {
+				int32_t code = end - at >= 4 ? json_hex4(at) : -1;
+				if (code < 0) { dest[0] = '\0'; return false; }
+				at += 4;
+				// Surrogate pair
+				if (code >= 0xD800 && code <= 0xDBFF && end - at >= 6 && at[0] == '\\' && at[1] == 'u') {
+					int32_t low = json_hex4(at + 2);
+					if (low >= 0xDC00 && low <= 0xDFFF) {
+						code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+						at  += 6;
+					}
+				}
+				if      (code < 0x80)    { bytes[0] = (char)code; }
+				else if (code < 0x800)   { bytes[0] = (char)(0xC0 | (code >> 6));  bytes[1] = (char)(0x80 | (code & 0x3F)); count = 2; }
+				else if (code < 0x10000) { bytes[0] = (char)(0xE0 | (code >> 12)); bytes[1] = (char)(0x80 | ((code >> 6) & 0x3F)); bytes[2] = (char)(0x80 | (code & 0x3F)); count = 3; }
+				else                     { bytes[0] = (char)(0xF0 | (code >> 18)); bytes[1] = (char)(0x80 | ((code >> 12) & 0x3F)); bytes[2] = (char)(0x80 | ((code >> 6) & 0x3F)); bytes[3] = (char)(0x80 | (code & 0x3F)); count = 4; }
+			} break;
+			default: bytes[0] = esc; break; // \" \\ \/
+			}
+		} else {
+			break;
+		}
+
+		// Too long for the destination, leave it empty rather than cut short
+		if (out + count + 1 > dest_size) {
+			if (dest_size > 0) dest[0] = '\0';
+			return false;
+		}
+		memcpy(&dest[out], bytes, count);
+		out += count;
+	}
+	if (dest_size > 0) dest[out] = '\0';
+	return true;
+}
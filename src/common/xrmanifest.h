@@ -0,0 +1,77 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+// A forward-only JSON scanner for OpenXR manifests. It walks the file in
+// place, skips everything it isn't asked about, and only ever copies the
+// few strings we want into caller-provided buffers, so parsing a manifest
+// never touches the heap.
+
+/*** Types *******************************/
+
+typedef struct json_scan_t {
+	const char *at;
+	const char *end;
+	bool        error;
+} json_scan_t;
+
+typedef struct json_str_t {
+	const char *start; // Raw contents between the quotes, escapes intact
+	size_t      length;
+} json_str_t;
+
+// Manifests are usually well under a page, and for those a mapping costs
+// more in syscalls and page faults than the parse itself. Small files are
+// read into the inline buffer instead, and only larger ones get mapped.
+#define MANIFEST_INLINE_SIZE 16384
+
+typedef struct manifest_map_t {
+	const char *data;
+	size_t      size;
+	bool        mapped;
+#if defined(_WIN32)
+	void       *file;
+	void       *mapping;
+#endif
+	char        inline_data[MANIFEST_INLINE_SIZE];
+} manifest_map_t;
+
+typedef struct runtime_manifest_t {
+	char file_format_version[16];
+	char name               [64];
+	char library_path       [1024];
+	char negotiate_function [128]; // functions.xrNegotiateLoaderRuntimeInterface
+} runtime_manifest_t;
+
+typedef struct layer_manifest_t {
+	char file_format_version   [16];
+	char name                  [256];
+	char library_path          [1024];
+	char api_version           [16];
+	char implementation_version[16];
+	char description           [256];
+	char disable_environment   [128]; // Implicit layers turn off when this is set
+	char enable_environment    [128]; // Implicit layers with one only turn on when it's set
+} layer_manifest_t;
+
+/*** Signatures **************************/
+
+bool manifest_map   (const char *file, manifest_map_t *out_map);
+void manifest_unmap (manifest_map_t *map);
+
+bool manifest_parse_runtime(const char *data, size_t size, runtime_manifest_t *out_manifest);
+bool manifest_load_runtime (const char *file, runtime_manifest_t *out_manifest);
+bool manifest_parse_layer  (const char *data, size_t size, layer_manifest_t *out_manifest);
+bool manifest_load_layer   (const char *file, layer_manifest_t *out_manifest);
+
+// json_object_open and json_string leave the scanner where it was if the
+// value is some other type, so the caller can json_skip it.
+json_scan_t json_scan_begin (const char *data, size_t size);
+bool        json_object_open(json_scan_t *scan);
+bool        json_object_next(json_scan_t *scan, json_str_t *out_key);
+bool        json_string     (json_scan_t *scan, json_str_t *out_str);
+bool        json_skip       (json_scan_t *scan);
+bool        json_str_is     (json_str_t str, const char *text);
+bool        json_str_copy   (json_str_t str, char *dest, size_t dest_size);
@@ -0,0 +1,527 @@
+#include "xrprefetch.h"
+#include "xrpreflight.h"
+#include "xrmanifest.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <limits.h>
+#include <link.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
+
+/*** Types *******************************/
+
+#if defined(__linux__)
+
+// What ld.so needs to know about a library to find its dependencies
+struct elf_deps_t {
+	uint16_t machine;
+	char    *strings;      // .dynstr, null terminated
+	size_t   strings_size;
+	uint64_t needed[128];  // Offsets into strings
+	int32_t  needed_count;
+	int64_t  rpath;        // Offset into strings, or -1
+	int64_t  runpath;
+};
+
+// /etc/ld.so.cache, the index ldconfig builds of the system library
+// folders. Only the current format is understood, it's the one glibc has
+// written on its own since 2.32, and older ones still write it after the
+// legacy table.
+struct ld_cache_t {
+	char       *data;
+	size_t      size;
+	const char *base;      // String offsets are relative to this
+	const char *entries;
+	uint32_t    count;
+};
+
+const char    ld_cache_magic_old[] = "ld.so-1.7.0";
+const char    ld_cache_magic_new[] = "glibc-ld.so.cache1.1";
+const size_t  ld_cache_header_new  = 48;
+const size_t  ld_cache_entry_new   = 24; // int32 flags, uint32 key, uint32 value, uint32 osversion, uint64 hwcap
+const size_t  ld_cache_entry_old   = 12;
+
+#if __SIZEOF_POINTER__ == 8
+const uint8_t elf_class_native = ELFCLASS64;
+#else
+const uint8_t elf_class_native = ELFCLASS32;
+#endif
+
+#endif
+
+/*** Signatures **************************/
+
+static bool prefetch_add_file(prefetch_set_t *set, const char *file);
+#if defined(__linux__)
+static void prefetch_add_needed(prefetch_set_t *set, int32_t first);
+static bool elf_read_deps      (const char *file, elf_deps_t *out_deps);
+static bool elf_machine_is     (const char *file, uint16_t machine);
+static bool ld_cache_load      (ld_cache_t *out_cache);
+static bool ld_cache_find      (const ld_cache_t *cache, const char *name, uint16_t machine, char *out_file, size_t out_file_size);
+static bool prefetch_search    (const char *dirs, const char *origin, const char *name, uint16_t machine, char *out_file, size_t out_file_size);
+#endif
+
+/*** Code ********************************/
+
+bool prefetch_add_runtime(prefetch_set_t *set, const runtime_t *runtime) {
+	char library[1024];
+	if (!runtime_library_path(runtime, library, sizeof(library)))
+		return false;
+
+	int32_t first = set->count;
+	bool    bare  = strchr(library, '/') == nullptr;
+#if defined(_WIN32)
+	bare = bare && strchr(library, '\\') == nullptr;
+	if (bare) {
+		char found[1024];
+		if (SearchPathA(nullptr, library, nullptr, sizeof(found), found, nullptr) == 0)
+			return false;
+		snprintf(library, sizeof(library), "%s", found);
+	}
+	prefetch_add_file(set, library);
+	return true;
+#else
+	if (bare) {
+		// Found the same way as one of its dependencies would be
+		ld_cache_t cache = {};
+		char       found[1024];
+		ld_cache_load(&cache);
+		bool ok =
+			prefetch_search(getenv("LD_LIBRARY_PATH"), "", library, EM_NONE, found, sizeof(found)) ||
+			ld_cache_find  (&cache, library, EM_NONE, found, sizeof(found)) ||
+			prefetch_search("/lib:/usr/lib:/lib64:/usr/lib64", "", library, EM_NONE, found, sizeof(found));
+		free(cache.data);
+		if (!ok) return false;
+		snprintf(library, sizeof(library), "%s", found);
+	}
+	if (!prefetch_add_file(set, library)) {
+		// Either missing, or already in the set along with what it needs
+		struct stat info;
+		return stat(library, &info) == 0;
+	}
+	prefetch_add_needed(set, first);
+	return true;
+#endif
+}
+
+///////////////////////////////////////////
+
+bool prefetch_add_active(prefetch_set_t *set) {
+	runtime_t runtime = {};
+	if (!runtime_active_file(runtime.file, sizeof(runtime.file)))
+		return false;
+
+	runtime_manifest_t manifest;
+	if (!manifest_load_runtime(runtime.file, &manifest))
+		return false;
+	runtime.present = true;
+	snprintf(runtime.library_path, sizeof(runtime.library_path), "%s", manifest.library_path);
+	return prefetch_add_runtime(set, &runtime);
+}
+
+///////////////////////////////////////////
+
+static bool prefetch_add_file(prefetch_set_t *set, const char *file) {
+	// Paths that don't fit are skipped, a truncated one is some other file
+	char canonical[1024];
+#if defined(_WIN32)
+	DWORD length = GetFullPathNameA(file, sizeof(canonical), canonical, nullptr);
+	if (length == 0 || length >= sizeof(canonical)) return false;
+#else
+	char resolved[PATH_MAX];
+	if (realpath(file, resolved) == nullptr) return false;
+	if (snprintf(canonical, sizeof(canonical), "%s", resolved) >= (int)sizeof(canonical)) return false;
+#endif
+	for (int32_t i = 0; i < set->count; i++) {
+		if (strcmp(set->files[i], canonical) == 0) return false;
+	}
+
+	struct stat info;
+	if (stat(canonical, &info) != 0) return false;
+
+	if (set->count >= set->capacity) {
+		set->capacity = set->capacity == 0 ? 32 : set->capacity * 2;
+		set->files    = (char **)realloc(set->files, sizeof(char *) * set->capacity);
+	}
+	set->files[set->count++] = strdup(canonical);
+	set->bytes += (int64_t)info.st_size;
+	return true;
+}
+
+///////////////////////////////////////////
+
+void prefetch_free(prefetch_set_t *set) {
+	for (int32_t i = 0; i < set->count; i++) free(set->files[i]);
+	free(set->files);
+	*set = {};
+}
+
+///////////////////////////////////////////
+
+#if defined(_WIN32)
+
+prefetch_result_t prefetch_run(const prefetch_set_t *set) {
+	prefetch_result_t result = {};
+	LARGE_INTEGER freq, start, end;
+	QueryPerformanceFrequency(&freq);
+	QueryPerformanceCounter  (&start);
+
+	// No readahead call here, but a sequential read fills the standby list
+	// just the same.
+	const DWORD chunk_size = 1024 * 1024;
+	void       *chunk      = malloc(chunk_size);
+	for (int32_t i = 0; i < set->count; i++) {
+		HANDLE file = CreateFileA(set->files[i], GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+		if (file == INVALID_HANDLE_VALUE) continue;
+		DWORD read = 0;
+		while (ReadFile(file, chunk, chunk_size, &read, nullptr) && read > 0)
+			result.bytes += read;
+		CloseHandle(file);
+		result.file_count += 1;
+	}
+	free(chunk);
+
+	QueryPerformanceCounter(&end);
+	result.ms = (float)((end.QuadPart - start.QuadPart) * 1000.0 / freq.QuadPart);
+	return result;
+}
+
+void    prefetch_evict   (const prefetch_set_t *) { }
+int64_t prefetch_resident(const prefetch_set_t *) { return -1; }
+
+#else
+
+prefetch_result_t prefetch_run(const prefetch_set_t *set) {
+	prefetch_result_t result = {};
+	timespec start, end;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+
+	for (int32_t i = 0; i < set->count; i++) {
+		int fd = open(set->files[i], O_RDONLY | O_CLOEXEC);
+		if (fd < 0) continue;
+		struct stat info;
+		if (fstat(fd, &info) == 0) {
+			// readahead only queues the reads, so all the files are in
+			// flight at once while the caller gets on with loading.
+			#if defined(__linux__)
+			if (readahead(fd, 0, (size_t)info.st_size) != 0)
+			#endif
+				posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+			result.bytes      += (int64_t)info.st_size;
+			result.file_count += 1;
+		}
+		close(fd);
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	result.ms = (float)((end.tv_sec - start.tv_sec) * 1000.0 + (end.tv_nsec - start.tv_nsec) / 1000000.0);
+	return result;
+}
+
+///////////////////////////////////////////
+
+void prefetch_evict(const prefetch_set_t *set) {
+	for (int32_t i = 0; i < set->count; i++) {
+		int fd = open(set->files[i], O_RDONLY | O_CLOEXEC);
+		if (fd < 0) continue;
+		posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+		close(fd);
+	}
+}
+
+///////////////////////////////////////////
+
+int64_t prefetch_resident(const prefetch_set_t *set) {
+	int64_t result    = 0;
+	size_t  page_size = (size_t)sysconf(_SC_PAGESIZE);
+	for (int32_t i = 0; i < set->count; i++) {
+		int fd = open(set->files[i], O_RDONLY | O_CLOEXEC);
+		if (fd < 0) continue;
+		struct stat info;
+		void       *data = MAP_FAILED;
+		if (fstat(fd, &info) == 0 && info.st_size > 0)
+			data = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+		close(fd);
+		if (data == MAP_FAILED) continue;
+
+		size_t         pages = ((size_t)info.st_size + page_size - 1) / page_size;
+		unsigned char *vec   = (unsigned char *)malloc(pages);
+		if (mincore(data, (size_t)info.st_size, vec) == 0) {
+			for (size_t p = 0; p < pages; p++) {
+				if (vec[p] & 1) result += (int64_t)page_size;
+			}
+		}
+		free(vec);
+		munmap(data, (size_t)info.st_size);
+	}
+	return result;
+}
+
+#endif
+
+///////////////////////////////////////////
+
+#if defined(__linux__)
+
+// Walks the set from `first` on, adding each library's dependencies to
+// the end, so by the time it runs out the whole closure is in.
+static void prefetch_add_needed(prefetch_set_t *set, int32_t first) {
+	ld_cache_t cache = {};
+	ld_cache_load(&cache);
+
+	uint16_t machine = EM_NONE;
+	for (int32_t i = first; i < set->count; i++) {
+		elf_deps_t deps;
+		if (!elf_read_deps(set->files[i], &deps)) continue;
+		if (machine == EM_NONE) machine = deps.machine;
+
+		char origin[1024];
+		snprintf(origin, sizeof(origin), "%s", set->files[i]);
+		char *slash = strrchr(origin, '/');
+		if (slash) *slash = '\0';
+
+		// Same order as ld.so: DT_RPATH (only without a DT_RUNPATH),
+		// LD_LIBRARY_PATH, DT_RUNPATH, the cache, then the defaults. The
+		// RPATHs of the libraries that loaded this one are ignored.
+		for (int32_t n = 0; n < deps.needed_count; n++) {
+			const char *name = &deps.strings[deps.needed[n]];
+			char        found[1024];
+			bool        ok;
+			if (strchr(name, '/')) {
+				snprintf(found, sizeof(found), "%s", name);
+				ok = elf_machine_is(found, machine);
+			} else {
+				ok =
+					(deps.runpath < 0 && deps.rpath >= 0 && prefetch_search(&deps.strings[deps.rpath], origin, name, machine, found, sizeof(found))) ||
+					prefetch_search(getenv("LD_LIBRARY_PATH"), origin, name, machine, found, sizeof(found)) ||
+					(deps.runpath >= 0 && prefetch_search(&deps.strings[deps.runpath], origin, name, machine, found, sizeof(found))) ||
+					ld_cache_find  (&cache, name, machine, found, sizeof(found)) ||
+					prefetch_search("/lib:/usr/lib:/lib64:/usr/lib64", origin, name, machine, found, sizeof(found));
+			}
+			if (ok) prefetch_add_file(set, found);
+		}
+		free(deps.strings);
+	}
+	free(cache.data);
+}
+
+///////////////////////////////////////////
+
+static bool elf_read_header(int fd, ElfW(Ehdr) *out_header) {
+	return
+		pread(fd, out_header, sizeof(*out_header), 0) == (ssize_t)sizeof(*out_header) &&
+		memcmp(out_header->e_ident, ELFMAG, SELFMAG) == 0 &&
+		out_header->e_ident[EI_CLASS] == elf_class_native;
+}
+
+///////////////////////////////////////////
+
+static bool elf_machine_is(const char *file, uint16_t machine) {
+	int fd = open(file, O_RDONLY | O_CLOEXEC);
+	if (fd < 0) return false;
+	ElfW(Ehdr) header;
+	bool result = elf_read_header(fd, &header) && (machine == EM_NONE || header.e_machine == machine);
+	close(fd);
+	return result;
+}
+
+///////////////////////////////////////////
+
+static bool elf_read_deps(const char *file, elf_deps_t *out_deps) {
+	*out_deps = {};
+	out_deps->rpath   = -1;
+	out_deps->runpath = -1;
+
+	int fd = open(file, O_RDONLY | O_CLOEXEC);
+	if (fd < 0) return false;
+
+	ElfW(Ehdr) header;
+	ElfW(Phdr) phdrs[64];
+	if (!elf_read_header(fd, &header) ||
+		header.e_phentsize != sizeof(ElfW(Phdr)) ||
+		header.e_phnum == 0 || header.e_phnum > 64 ||
+		pread(fd, phdrs, sizeof(ElfW(Phdr)) * header.e_phnum, (off_t)header.e_phoff) != (ssize_t)(sizeof(ElfW(Phdr)) * header.e_phnum)) {
+		close(fd);
+		return false;
+	}
+	out_deps->machine = header.e_machine;
+
+	const ElfW(Phdr) *dynamic = nullptr;
+	for (int32_t i = 0; i < header.e_phnum; i++) {
+		if (phdrs[i].p_type == PT_DYNAMIC) dynamic = &phdrs[i];
+	}
+	if (dynamic == nullptr || dynamic->p_filesz == 0 || dynamic->p_filesz > 64 * 1024) {
+		close(fd);
+		return dynamic == nullptr; // Static, so nothing needed
+	}
+
+	size_t      dyn_count = dynamic->p_filesz / sizeof(ElfW(Dyn));
+	ElfW(Dyn)  *dyn       = (ElfW(Dyn) *)malloc(dyn_count * sizeof(ElfW(Dyn)));
+	uint64_t    strtab    = 0;
+	uint64_t    strsz     = 0;
+	if (pread(fd, dyn, dyn_count * sizeof(ElfW(Dyn)), (off_t)dynamic->p_offset) != (ssize_t)(dyn_count * sizeof(ElfW(Dyn)))) {
+		free(dyn);
+		close(fd);
+		return false;
+	}
+	for (size_t i = 0; i < dyn_count && dyn[i].d_tag != DT_NULL; i++) {
+		switch (dyn[i].d_tag) {
+		case DT_NEEDED:
+			if (out_deps->needed_count < (int32_t)(sizeof(out_deps->needed)/sizeof(out_deps->needed[0])))
+				out_deps->needed[out_deps->needed_count++] = dyn[i].d_un.d_val;
+			break;
+		case DT_STRTAB:  strtab            = dyn[i].d_un.d_ptr; break;
+		case DT_STRSZ:   strsz             = dyn[i].d_un.d_val; break;
+		case DT_RPATH:   out_deps->rpath   = (int64_t)dyn[i].d_un.d_val; break;
+		case DT_RUNPATH: out_deps->runpath = (int64_t)dyn[i].d_un.d_val; break;
+		}
+	}
+	free(dyn);
+
+	// DT_STRTAB is an address, find the file offset of the segment it's in
+	int64_t strtab_offset = -1;
+	for (int32_t i = 0; i < header.e_phnum; i++) {
+		if (phdrs[i].p_type == PT_LOAD && strtab >= phdrs[i].p_vaddr && strtab < phdrs[i].p_vaddr + phdrs[i].p_filesz)
+			strtab_offset = (int64_t)(strtab - phdrs[i].p_vaddr + phdrs[i].p_offset);
+	}
+	if (strtab_offset < 0 || strsz == 0 || strsz > 4 * 1024 * 1024) {
+		close(fd);
+		return false;
+	}
+	out_deps->strings      = (char *)malloc(strsz + 1);
+	out_deps->strings_size = strsz;
+	bool ok = pread(fd, out_deps->strings, strsz, (off_t)strtab_offset) == (ssize_t)strsz;
+	out_deps->strings[strsz] = '\0';
+	close(fd);
+
+	// Drop anything pointing outside the table
+	int32_t kept = 0;
+	for (int32_t i = 0; i < out_deps->needed_count; i++) {
+		if (out_deps->needed[i] < strsz) out_deps->needed[kept++] = out_deps->needed[i];
+	}
+	out_deps->needed_count = kept;
+	if (out_deps->rpath   >= (int64_t)strsz) out_deps->rpath   = -1;
+	if (out_deps->runpath >= (int64_t)strsz) out_deps->runpath = -1;
+
+	if (!ok) {
+		free(out_deps->strings);
+		out_deps->strings = nullptr;
+	}
+	return ok;
+}
+
+///////////////////////////////////////////
+
+static bool prefetch_search(const char *dirs, const char *origin, const char *name, uint16_t machine, char *out_file, size_t out_file_size) {
+	if (dirs == nullptr) return false;
+
+	char dir[1024];
+	while (*dirs) {
+		const char *end = strpbrk(dirs, ":;");
+		size_t      len = end ? (size_t)(end - dirs) : strlen(dirs);
+
+		// $ORIGIN and ${ORIGIN} are the folder of the library asking
+		size_t out = 0;
+		for (size_t i = 0; i < len && out + 1 < sizeof(dir); ) {
+			if      (strncmp(&dirs[i], "${ORIGIN}", 9) == 0 && i + 9 <= len) { out += snprintf(&dir[out], sizeof(dir) - out, "%s", origin); i += 9; }
+			else if (strncmp(&dirs[i], "$ORIGIN",   7) == 0 && i + 7 <= len) { out += snprintf(&dir[out], sizeof(dir) - out, "%s", origin); i += 7; }
+			else dir[out++] = dirs[i++];
+			if (out >= sizeof(dir)) out = sizeof(dir) - 1;
+		}
+		dir[out] = '\0';
+
+		// An empty entry is the current folder, as far as ld.so cares
+		if (snprintf(out_file, out_file_size, "%s/%s", out ? dir : ".", name) < (int)out_file_size &&
+			elf_machine_is(out_file, machine))
+			return true;
+		if (!end) break;
+		dirs = end + 1;
+	}
+	out_file[0] = '\0';
+	return false;
+}
+
+///////////////////////////////////////////
+
+static bool ld_cache_load(ld_cache_t *out_cache) {
+	*out_cache = {};
+	FILE *fp = fopen("/etc/ld.so.cache", "rb");
+	if (fp == nullptr) return false;
+	fseek(fp, 0, SEEK_END);
+	long size = ftell(fp);
+	fseek(fp, 0, SEEK_SET);
+	if (size <= 0 || size > 64 * 1024 * 1024) {
+		fclose(fp);
+		return false;
+	}
+	char *data = (char *)malloc((size_t)size);
+	bool  ok   = fread(data, 1, (size_t)size, fp) == (size_t)size;
+	fclose(fp);
+
+	// The legacy format puts its own table first, with the current one
+	// after it on an 8 byte boundary.
+	size_t at = 0;
+	if (ok && (size_t)size >= 16 && memcmp(data, ld_cache_magic_old, sizeof(ld_cache_magic_old) - 1) == 0) {
+		uint32_t old_count;
+		memcpy(&old_count, &data[12], sizeof(old_count));
+		at = (16 + (size_t)old_count * ld_cache_entry_old + 7) & ~(size_t)7;
+	}
+	ok = ok &&
+		at + ld_cache_header_new <= (size_t)size &&
+		memcmp(&data[at], ld_cache_magic_new, sizeof(ld_cache_magic_new) - 1) == 0;
+	uint32_t count = 0;
+	if (ok) {
+		memcpy(&count, &data[at + 20], sizeof(count));
+		ok = at + ld_cache_header_new + (size_t)count * ld_cache_entry_new <= (size_t)size;
+	}
+	if (!ok) {
+		free(data);
+		return false;
+	}
+
+	out_cache->data    = data;
+	out_cache->size    = (size_t)size;
+	out_cache->base    = &data[at];
+	out_cache->entries = &data[at + ld_cache_header_new];
+	out_cache->count   = count;
+	return true;
+}
+
+///////////////////////////////////////////
+
+static bool ld_cache_find(const ld_cache_t *cache, const char *name, uint16_t machine, char *out_file, size_t out_file_size) {
+	const char *end      = cache->data + cache->size;
+	size_t      name_len = strlen(name);
+	for (uint32_t i = 0; i < cache->count; i++) {
+		uint32_t key, value;
+		memcpy(&key,   &cache->entries[i * ld_cache_entry_new + 4], sizeof(key));
+		memcpy(&value, &cache->entries[i * ld_cache_entry_new + 8], sizeof(value));
+		const char *key_str   = cache->base + key;
+		const char *value_str = cache->base + value;
+		if (key_str + name_len >= end || value_str >= end) continue;
+		if (memcmp(key_str, name, name_len + 1) != 0) continue;
+		if (memchr(value_str, '\0', (size_t)(end - value_str)) == nullptr) continue;
+
+		// The cache lists every architecture installed, so check we
+		// found one we could actually load.
+		if (elf_machine_is(value_str, machine)) {
+			snprintf(out_file, out_file_size, "%s", value_str);
+			return true;
+		}
+	}
+	return false;
+}
+
+#endif
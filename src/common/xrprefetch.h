@@ -0,0 +1,45 @@
+#pragma once
+
+#include "xrruntime.h"
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+// Pulls runtime libraries into the page cache ahead of xrCreateInstance.
+// Loading a large runtime straight after boot is mostly page faults, one
+// small random read at a time, while reading the same files start to end
+// up front lets the disk stream them. On Linux the set also follows each
+// library's DT_NEEDED entries the way ld.so would, so the dependencies
+// come along too. Windows only gets the runtime library itself.
+
+/*** Types *******************************/
+
+typedef struct prefetch_set_t {
+	char  **files;    // Canonical paths, the runtime libraries come first
+	int32_t count;
+	int32_t capacity;
+	int64_t bytes;
+} prefetch_set_t;
+
+typedef struct prefetch_result_t {
+	int32_t file_count;
+	int64_t bytes;
+	float   ms;       // Time to issue the reads, they may still be in flight
+} prefetch_result_t;
+
+/*** Signatures **************************/
+
+// Add a runtime's library and everything it needs. Files already in the
+// set aren't added twice. Returns false if the library couldn't be found.
+bool              prefetch_add_runtime(prefetch_set_t *set, const runtime_t *runtime);
+// Same, for the runtime the loader would pick for this process.
+bool              prefetch_add_active (prefetch_set_t *set);
+prefetch_result_t prefetch_run        (const prefetch_set_t *set);
+void              prefetch_free       (prefetch_set_t *set);
+
+// For measuring: drops the set's pages from the page cache, and counts
+// how many bytes of it are cached. Pages that some process has mapped
+// can't be dropped. Linux only, prefetch_resident returns -1 elsewhere.
+void              prefetch_evict      (const prefetch_set_t *set);
+int64_t           prefetch_resident   (const prefetch_set_t *set);
@@ -0,0 +1,348 @@
+#include "xrpreflight.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#include <Psapi.h>
+#else
+#include <dlfcn.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <poll.h>
+#include <signal.h>
+#include <spawn.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+extern char **environ;
+#endif
+
+/*** Signatures **************************/
+
+static void preflight_check(const runtime_t *runtime, preflight_result_t *out_result);
+static void preflight_load (const char *library, const char *function, preflight_result_t *out_result);
+
+/*** Code ********************************/
+
+const char *preflight_status_str(preflight_ status) {
+	switch (status) {
+	case preflight_none:         return "untested";
+	case preflight_ok:           return "ok";
+	case preflight_no_manifest:  return "no manifest";
+	case preflight_no_library:   return "library missing";
+	case preflight_load_failed:  return "load failed";
+	case preflight_no_negotiate: return "no negotiate function";
+	case preflight_crashed:      return "crashed";
+	case preflight_timed_out:    return "timed out";
+	default:                     return "unknown";
+	}
+}
+
+///////////////////////////////////////////
+
+bool runtime_library_path(const runtime_t *runtime, char *out_path, size_t out_path_size) {
+	const char *lib = runtime->library_path;
+	out_path[0] = '\0';
+	if (lib[0] == '\0') return false;
+
+	// Same rules as the loader: absolute paths are used as-is, bare file
+	// names go through the system's library search, and anything else is
+	// relative to the folder the manifest is in.
+#if defined(_WIN32)
+	bool absolute = lib[0] == '\\' || lib[0] == '/' || (lib[0] != '\0' && lib[1] == ':');
+	bool bare     = strchr(lib, '\\') == nullptr && strchr(lib, '/') == nullptr;
+	if (absolute || bare) {
+		snprintf(out_path, out_path_size, "%s", lib);
+		return true;
+	}
+	char dir[1024];
+	snprintf(dir, sizeof(dir), "%s", runtime->file);
+#else
+	if (lib[0] == '/' || strchr(lib, '/') == nullptr) {
+		snprintf(out_path, out_path_size, "%s", lib);
+		return true;
+	}
+	// The loader resolves symlinks like active_runtime.json first, so the
+	// path is relative to where the manifest really lives.
+	char dir[PATH_MAX];
+	if (realpath(runtime->file, dir) == nullptr)
+		snprintf(dir, sizeof(dir), "%s", runtime->file);
+#endif
+
+	char *slash = strrchr(dir, '/');
+#if defined(_WIN32)
+	char *back  = strrchr(dir, '\\');
+	if (back > slash) slash = back;
+#endif
+	if (slash) slash[1] = '\0';
+	else       dir[0]   = '\0';
+
+	const char *rel = lib;
+	while (rel[0] == '.' && (rel[1] == '/' || rel[1] == '\\')) rel += 2;
+	return snprintf(out_path, out_path_size, "%s%s", dir, rel) < (int)out_path_size;
+}
+
+///////////////////////////////////////////
+
+// Everything that can be decided without loading anything. Returns with
+// status still preflight_none if the library needs loading.
+static void preflight_check(const runtime_t *runtime, preflight_result_t *out_result) {
+	*out_result = {};
+	if (!runtime->present || runtime->library_path[0] == '\0') {
+		out_result->status = preflight_no_manifest;
+		snprintf(out_result->reason, sizeof(out_result->reason), "%s", runtime->present
+			? "Manifest has no runtime.library_path"
+			: "Manifest not found");
+		return;
+	}
+	if (!runtime_library_path(runtime, out_result->library, sizeof(out_result->library))) {
+		out_result->status = preflight_no_library;
+		snprintf(out_result->reason, sizeof(out_result->reason), "library_path is too long");
+		return;
+	}
+
+	// Bare names are up to the system search path, so only check files
+	bool bare = strchr(out_result->library, '/') == nullptr;
+#if defined(_WIN32)
+	bare = bare && strchr(out_result->library, '\\') == nullptr;
+#endif
+	struct stat info;
+	if (!bare && stat(out_result->library, &info) != 0) {
+		out_result->status = preflight_no_library;
+		snprintf(out_result->reason, sizeof(out_result->reason), "%s doesn't exist", out_result->library);
+	}
+}
+
+///////////////////////////////////////////
+
+#if defined(_WIN32)
+
+static int64_t preflight_rss() {
+	PROCESS_MEMORY_COUNTERS counters = { sizeof(counters) };
+	return K32GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))
+		? (int64_t)counters.WorkingSetSize
+		: 0;
+}
+
+///////////////////////////////////////////
+
+static void preflight_load(const char *library, const char *function, preflight_result_t *out_result) {
+	LARGE_INTEGER freq, start, end;
+	QueryPerformanceFrequency(&freq);
+	int64_t rss_start = preflight_rss();
+	QueryPerformanceCounter(&start);
+
+	// Altered search path so the runtime's own folder is searched for its
+	// dependencies, the same way the loader opens it.
+	HMODULE module = LoadLibraryExA(library, nullptr, LOAD_WITH_ALTERED_SEARCH_PATH);
+	FARPROC proc   = module ? GetProcAddress(module, function) : nullptr;
+	DWORD   err    = GetLastError();
+
+	QueryPerformanceCounter(&end);
+	out_result->load_ms   = (float)((end.QuadPart - start.QuadPart) * 1000.0 / freq.QuadPart);
+	out_result->rss_delta = preflight_rss() - rss_start;
+
+	if (module == nullptr || proc == nullptr) {
+		out_result->status = module == nullptr ? preflight_load_failed : preflight_no_negotiate;
+		int32_t len = module == nullptr
+			? (int32_t)FormatMessageA(FORMAT_MESSAGE_FROM_SYSTEM | FORMAT_MESSAGE_IGNORE_INSERTS, nullptr, err, 0, out_result->reason, sizeof(out_result->reason), nullptr)
+			: snprintf(out_result->reason, sizeof(out_result->reason), "%s isn't exported", function);
+		while (len > 0 && (out_result->reason[len-1] == '\n' || out_result->reason[len-1] == '\r'))
+			out_result->reason[--len] = '\0';
+	} else {
+		out_result->status = preflight_ok;
+	}
+	if (module) FreeLibrary(module);
+}
+
+///////////////////////////////////////////
+
+void runtime_preflight(const runtime_t *runtime_list, int32_t runtime_count, int32_t timeout_ms, preflight_result_t *out_results) {
+	// No timeout without a separate process to kill, see the header
+	(void)timeout_ms;
+	for (int32_t i = 0; i < runtime_count; i++) {
+		preflight_check(&runtime_list[i], &out_results[i]);
+		if (out_results[i].status != preflight_none) continue;
+
+		const char *function = runtime_list[i].negotiate_function[0]
+			? runtime_list[i].negotiate_function
+			: "xrNegotiateLoaderRuntimeInterface";
+		preflight_load(out_results[i].library, function, &out_results[i]);
+	}
+}
+
+#else
+
+static int64_t preflight_rss() {
+	// Second field of statm is resident pages
+	FILE *fp = fopen("/proc/self/statm", "r");
+	if (fp == nullptr) return 0;
+	long size = 0, resident = 0;
+	if (fscanf(fp, "%ld %ld", &size, &resident) != 2) resident = 0;
+	fclose(fp);
+	return (int64_t)resident * sysconf(_SC_PAGESIZE);
+}
+
+///////////////////////////////////////////
+
+static double preflight_ms() {
+	timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return now.tv_sec * 1000.0 + now.tv_nsec / 1000000.0;
+}
+
+///////////////////////////////////////////
+
+static void preflight_load(const char *library, const char *function, preflight_result_t *out_result) {
+	int64_t rss_start = preflight_rss();
+	double  start     = preflight_ms();
+
+	// RTLD_NOW, so a missing symbol in a dependency fails here rather
+	// than on first call.
+	void *module = dlopen(library, RTLD_NOW | RTLD_LOCAL);
+	void *proc   = module ? dlsym(module, function) : nullptr;
+
+	out_result->load_ms   = (float)(preflight_ms() - start);
+	out_result->rss_delta = preflight_rss() - rss_start;
+
+	if (module == nullptr) {
+		out_result->status = preflight_load_failed;
+		const char *err = dlerror();
+		snprintf(out_result->reason, sizeof(out_result->reason), "%s", err ? err : "dlopen failed");
+	} else if (proc == nullptr) {
+		out_result->status = preflight_no_negotiate;
+		snprintf(out_result->reason, sizeof(out_result->reason), "%s isn't exported", function);
+	} else {
+		out_result->status = preflight_ok;
+	}
+	// Not unloading, the worker is about to exit anyway and some runtimes
+	// don't survive dlclose.
+}
+
+///////////////////////////////////////////
+
+void runtime_preflight_worker(const char *library, const char *function) {
+	// stdout is the pipe back to runtime_preflight. Hold on to it for the
+	// result, and point the runtime's own logging at /dev/null instead.
+	int result_fd = dup(STDOUT_FILENO);
+	int null_fd   = open("/dev/null", O_WRONLY);
+	if (null_fd >= 0) dup2(null_fd, STDOUT_FILENO);
+
+	// One write, and the result is well under PIPE_BUF, so it's atomic
+	preflight_result_t result = {};
+	snprintf(result.library, sizeof(result.library), "%s", library);
+	preflight_load(library, function, &result);
+	ssize_t written = write(result_fd, &result, sizeof(result));
+	_exit(written == (ssize_t)sizeof(result) ? 0 : 1);
+}
+
+///////////////////////////////////////////
+
+void runtime_preflight(const runtime_t *runtime_list, int32_t runtime_count, int32_t timeout_ms, preflight_result_t *out_results) {
+	pid_t *pids  = (pid_t *)malloc(sizeof(pid_t) * runtime_count);
+	int   *pipes = (int   *)malloc(sizeof(int  ) * runtime_count);
+	int32_t running = 0;
+
+	char    exe[PATH_MAX];
+	ssize_t exe_len = readlink("/proc/self/exe", exe, sizeof(exe) - 1);
+	exe[exe_len > 0 ? exe_len : 0] = '\0';
+
+	// Start everything, then wait on all of them together
+	double start = preflight_ms();
+	for (int32_t i = 0; i < runtime_count; i++) {
+		pids [i] = -1;
+		pipes[i] = -1;
+		preflight_check(&runtime_list[i], &out_results[i]);
+		if (out_results[i].status != preflight_none) continue;
+
+		const char *function = runtime_list[i].negotiate_function[0]
+			? runtime_list[i].negotiate_function
+			: "xrNegotiateLoaderRuntimeInterface";
+
+		int pipe_fd[2];
+		if (pipe2(pipe_fd, O_CLOEXEC) != 0) {
+			out_results[i].status = preflight_crashed;
+			snprintf(out_results[i].reason, sizeof(out_results[i].reason), "Couldn't create a pipe: %s", strerror(errno));
+			continue;
+		}
+		// A fresh copy of ourselves rather than a fork: we're called from a
+		// threaded GUI, and a forked child that touches dlopen or malloc can
+		// deadlock on a lock some other thread was holding.
+		const char *argv[] = { exe, "-preflightWorker", out_results[i].library, function, nullptr };
+		posix_spawn_file_actions_t actions;
+		posix_spawn_file_actions_init   (&actions);
+		posix_spawn_file_actions_adddup2(&actions, pipe_fd[1], STDOUT_FILENO);
+		posix_spawn_file_actions_addopen(&actions, STDERR_FILENO, "/dev/null", O_WRONLY, 0);
+		pid_t pid   = -1;
+		runtime_env_lock();
+		int   error = exe_len > 0
+			? posix_spawn(&pid, exe, &actions, nullptr, (char *const *)argv, environ)
+			: ENOENT;
+		runtime_env_unlock();
+		posix_spawn_file_actions_destroy(&actions);
+		close(pipe_fd[1]);
+		if (error != 0) {
+			close(pipe_fd[0]);
+			out_results[i].status = preflight_crashed;
+			snprintf(out_results[i].reason, sizeof(out_results[i].reason), "Couldn't start a worker: %s", strerror(error));
+			continue;
+		}
+		pids [i] = pid;
+		pipes[i] = pipe_fd[0];
+		running += 1;
+	}
+
+	// The result lands in the pipe before the worker exits, so reap first
+	// and read after.
+	while (running > 0) {
+		bool timed_out = timeout_ms > 0 && preflight_ms() - start > timeout_ms;
+		for (int32_t i = 0; i < runtime_count; i++) {
+			if (pids[i] < 0) continue;
+
+			int   status = 0;
+			pid_t done   = waitpid(pids[i], &status, WNOHANG);
+			if (done == 0 && !timed_out) continue;
+			if (done == 0) {
+				kill(pids[i], SIGKILL);
+				while (waitpid(pids[i], &status, 0) < 0 && errno == EINTR);
+				out_results[i].status  = preflight_timed_out;
+				out_results[i].load_ms = (float)(preflight_ms() - start);
+				snprintf(out_results[i].reason, sizeof(out_results[i].reason), "Still loading after %d ms", timeout_ms);
+			} else if (done < 0 && errno == EINTR) {
+				continue;
+			} else {
+				preflight_result_t result;
+				ssize_t count = read(pipes[i], &result, sizeof(result));
+				if (done > 0 && count == (ssize_t)sizeof(result)) {
+					out_results[i] = result;
+				} else {
+					out_results[i].status = preflight_crashed;
+					if (done > 0 && WIFSIGNALED(status))
+						snprintf(out_results[i].reason, sizeof(out_results[i].reason), "Worker died from signal %d (%s)", WTERMSIG(status), strsignal(WTERMSIG(status)));
+					else if (done > 0 && WIFEXITED(status))
+						snprintf(out_results[i].reason, sizeof(out_results[i].reason), "Worker exited with code %d before reporting", WEXITSTATUS(status));
+					else
+						snprintf(out_results[i].reason, sizeof(out_results[i].reason), "Lost track of the worker");
+				}
+			}
+			close(pipes[i]);
+			pids [i] = -1;
+			pipes[i] = -1;
+			running -= 1;
+		}
+		if (running > 0) poll(nullptr, 0, 5);
+	}
+
+	free(pids);
+	free(pipes);
+}
+
+#endif
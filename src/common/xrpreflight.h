@@ -0,0 +1,52 @@
+#pragma once
+
+#include "xrruntime.h"
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+// Load-tests runtime libraries, to catch the runtimes whose manifest is
+// fine but whose library is missing, can't resolve its dependencies, or
+// falls over on load. On Linux each runtime is loaded by its own worker,
+// a fresh copy of this executable started with -preflightWorker, all at
+// once, so a crash or a hang only takes out that worker. On Windows the
+// libraries are loaded in-process one after another, and a library that
+// crashes will take us with it.
+
+/*** Types *******************************/
+
+typedef enum preflight_ {
+	preflight_none,          // Not tested yet
+	preflight_ok,
+	preflight_no_manifest,   // Manifest missing, or had no library_path
+	preflight_no_library,    // library_path points at nothing
+	preflight_load_failed,   // dlopen/LoadLibrary failed, usually a dependency
+	preflight_no_negotiate,  // Loaded, but the negotiate function isn't exported
+	preflight_crashed,
+	preflight_timed_out,
+} preflight_;
+
+typedef struct preflight_result_t {
+	preflight_ status;
+	float      load_ms;     // Time to load the library and find the function
+	int64_t    rss_delta;   // Bytes of resident memory the load added
+	char       library[1024]; // library_path, resolved against the manifest
+	char       reason [256];
+} preflight_result_t;
+
+/*** Signatures **************************/
+
+// out_results must have room for runtime_count results. Runtimes that
+// aren't present are skipped with preflight_no_manifest.
+void        runtime_preflight     (const runtime_t *runtime_list, int32_t runtime_count, int32_t timeout_ms, preflight_result_t *out_results);
+bool        runtime_library_path  (const runtime_t *runtime, char *out_path, size_t out_path_size);
+const char *preflight_status_str  (preflight_ status);
+
+#if !defined(_WIN32)
+// Body of the worker process runtime_preflight starts: loads one library,
+// writes a preflight_result_t to stdout, and exits without returning. The
+// executable has to call this when it sees -preflightWorker <library>
+// <function> on its command line.
+void        runtime_preflight_worker(const char *library, const char *function);
+#endif
@@ -1,10 +1,17 @@
 #include "xrruntime.h"
+#include "xrmanifest.h"
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <malloc.h>
 #include <sys/stat.h>
+#include <mutex>
+
+#if defined(__linux__)
+#include <dirent.h>
+#include <unistd.h>
+#endif
 
 #ifdef _WIN32
 #define WIN32_LEAN_AND_MEAN
@@ -12,36 +19,354 @@
 #include <Windows.h>
 #endif
 
-#include <nlohmann/json.hpp>
-
 /*** Default Runtime File ****************/
 
 #include "xr_runtime_default.h"
 #include "xr_runtime_template.h"
 
+/*** Types *******************************/
+
+// Everything we learn about a runtime's manifest file while loading the
+// list, so each path only gets stat'ed once.
+struct runtime_file_t {
+	bool     exists;
+	bool     disabled;
+	uint64_t dev;
+	uint64_t ino;
+};
+
+struct runtime_list_t {
+	runtime_t      *items;
+	runtime_file_t *files;
+	int32_t         count;
+	int32_t         capacity;
+};
+
+struct layer_list_t {
+	layer_t *items;
+	int32_t  count;
+	int32_t  capacity;
+};
+
+#if defined(__linux__)
+typedef void (*discover_fn)(const char *dir, void *data);
+
+struct layer_discover_t {
+	layer_list_t *list;
+	bool          implicit;
+	const char   *subdir; // Appended to each root, null when the roots are the folders
+};
+#endif
+
+// Parsed manifest metadata, saved between runs so unchanged manifests
+// don't need reading again. An entry is only trusted when the file at that
+// path still has the same identity, size and mtime. stat follows symlinks,
+// so a retargeted link or a replaced file shows up as a new inode.
+struct manifest_cache_entry_t {
+	char     file[1024];
+	uint64_t dev;
+	uint64_t ino;
+	uint64_t size;
+	int64_t  mtime_sec;
+	int64_t  mtime_nsec;
+	char     file_format_version[16];
+	char     name[64];
+	char     library_path[1024];
+	char     negotiate_function[128];
+};
+
+struct manifest_cache_t {
+	manifest_cache_entry_t *entries;
+	uint64_t               *hashes;   // Of each entry's file path
+	int32_t                 count;
+	int32_t                 capacity;
+	bool                    dirty;
+};
+
+const uint32_t manifest_cache_magic   = 0x434d5258; // 'XRMC'
+const uint32_t manifest_cache_version = 1;
+const int32_t  manifest_cache_max     = 256;
+
+// Open addressing set of 64 bit hashes, 0 marks an empty slot.
+struct hash_set_t {
+	uint64_t *slots;
+	size_t    capacity;
+	size_t    count;
+};
+
 /*** Signatures **************************/
 
 bool file_exists(const char *file);
 char* read_file(const char* file);
 
+static void     runtime_list_add   (runtime_list_t *list, const runtime_t &runtime, bool disabled);
+static void     runtime_parse_list (runtime_list_t *list, const char *text);
+static void     layer_list_add     (layer_list_t *list, const char *file, bool implicit, bool disabled);
+static void     runtime_fill_manifest(runtime_t *runtime, manifest_cache_t *cache, const struct stat *info);
+static uint64_t hash_bytes         (const void *data, size_t size, uint64_t hash);
+static bool     hash_set_has       (const hash_set_t *set, uint64_t hash);
+static bool     hash_set_add       (hash_set_t *set, uint64_t hash);
+static void     hash_set_free      (hash_set_t *set);
+static void     manifest_cache_read (const char *file, manifest_cache_t *out_cache);
+static void     manifest_cache_write(const char *file, const manifest_cache_t *cache);
+static void     manifest_cache_free (manifest_cache_t *cache);
+#if defined(__linux__)
+static const char *runtime_home_dir  ();
+static void        runtime_discover  (runtime_list_t *list);
+static void        discover_roots    (discover_fn on_root, void *data);
+static void        discover_split    (const char *dirs, const char *fallback, discover_fn on_dir, void *data);
+static void        layer_discover_dir(const char *root, void *data);
+#elif defined(_WIN32)
+static void        layer_read_registry(layer_list_t *list, HKEY root, const char *key_path, bool implicit);
+#endif
+
 /*** Code ********************************/
 
 bool load_runtimes(const char *file, runtime_t **out_runtime_list, int32_t *out_runtime_count) {
-	const char *files[3]  = {};
-	char       *file_data = read_file(file);
-	if (file_data != nullptr) {
-		files[0] = file_data;
-		files[1] = runtime_default_list;
+	runtime_list_t list = {};
+
+	// The user's list comes first, so its names win over the defaults
+	char *file_data = read_file(file);
+	if (file_data != nullptr)
+		runtime_parse_list(&list, file_data);
+	runtime_parse_list(&list, runtime_default_list);
+	free(file_data);
+
+	#if defined(_WIN32)
+	platform_ curr_platform = platform_windows;
+	HKEY available_runtimes_key {};
+	if (RegOpenKeyExA(HKEY_LOCAL_MACHINE, "SOFTWARE\\Khronos\\OpenXR\\1\\AvailableRuntimes", 0, KEY_READ, &available_runtimes_key) == ERROR_SUCCESS && available_runtimes_key) {
+		// The actual limit is 16383 based on the registry limits:
+		//   https://learn.microsoft.com/en-us/windows/win32/sysinfo/registry-element-size-limits
+		// However, we'll stick to 1024 (including terminating null) as we need to fit in
+		// runtime_t::file
+		char path[1024];
+		// If we end up switching to wchar, this will still be a character count, not a byte count
+		DWORD path_char_count = sizeof(path);
+		DWORD value_type;
+		DWORD disabled;
+		DWORD disabled_byte_count = sizeof(disabled);
+		for (DWORD i=0; ;++i) {
+			auto res = RegEnumValueA(available_runtimes_key, i, path, &path_char_count, nullptr, &value_type, reinterpret_cast<LPBYTE>(&disabled), &disabled_byte_count);
+			if (res == ERROR_NO_MORE_ITEMS) {
+				break;
+			}
+			if (res == ERROR_SUCCESS && value_type == REG_DWORD) {
+				runtime_t runtime = {};
+				runtime.platform = curr_platform;
+				memcpy(runtime.file, path, path_char_count);
+				runtime.file[path_char_count] = '\0';
+				runtime_list_add(&list, runtime, disabled != 0);
+			}
+			path_char_count = sizeof(path);
+			disabled_byte_count = sizeof(disabled);
+		}
+		RegCloseKey(available_runtimes_key);
+	}
+	#elif defined(__linux)
+	platform_ curr_platform = platform_linux;
+
+	// On linux, we want to support the '~' path feature, esp. for SteamVR
+	const char *home = runtime_home_dir();
+	char path_tmp[1024];
+	for (int32_t i=0; i<list.count; i+=1) {
+		if (list.items[i].file[0] == '~') {
+			snprintf(path_tmp, sizeof(path_tmp), "%s%s", home, &list.items[i].file[1]);
+			strcpy(list.items[i].file, path_tmp);
+		}
+	}
+
+	// Manifests in the loader's standard locations
+	runtime_discover(&list);
+	#endif
+
+	// One stat per manifest, reused for presence, deduplication, and for
+	// checking the cached metadata is still current
+	manifest_cache_t cache = {};
+	manifest_cache_read(runtime_cache_path(), &cache);
+	for (int32_t i=0; i<list.count; i+=1) {
+		struct stat info;
+		runtime_file_t *file_info = &list.files[i];
+		file_info->exists = stat(list.items[i].file, &info) == 0;
+		if (file_info->exists) {
+			file_info->dev = (uint64_t)info.st_dev;
+			file_info->ino = (uint64_t)info.st_ino;
+			runtime_fill_manifest(&list.items[i], &cache, &info);
+		}
+	}
+	if (cache.dirty)
+		manifest_cache_write(runtime_cache_path(), &cache);
+	manifest_cache_free(&cache);
+
+	// The first present entry for each manifest file and each name wins.
+	// stat follows symlinks, so a link and its target share a key. Windows
+	// doesn't report inodes through stat, so it falls back to the path.
+	hash_set_t seen_files = {};
+	hash_set_t seen_names = {};
+	for (int32_t i=0; i<list.count; i+=1) {
+		runtime_t            *runtime   = &list.items[i];
+		const runtime_file_t *file_info = &list.files[i];
+
+		runtime->present =
+			runtime->platform == curr_platform &&
+			file_info->exists &&
+			!file_info->disabled;
+		if (!runtime->present) continue;
+
+		#if defined(_WIN32)
+		uint64_t file_key = hash_bytes(runtime->file, strlen(runtime->file), 1);
+		#else
+		uint64_t file_key = hash_bytes(&file_info->ino, sizeof(file_info->ino), hash_bytes(&file_info->dev, sizeof(file_info->dev), 1));
+		#endif
+		uint64_t name_key = hash_bytes(runtime->name, strlen(runtime->name), 2);
+
+		runtime->present =
+			!hash_set_has(&seen_files, file_key) &&
+			!hash_set_has(&seen_names, name_key);
+		if (runtime->present) {
+			hash_set_add(&seen_files, file_key);
+			hash_set_add(&seen_names, name_key);
+		}
+	}
+	hash_set_free(&seen_files);
+	hash_set_free(&seen_names);
+	free(list.files);
+
+	*out_runtime_list  = list.items;
+	*out_runtime_count = list.count;
+	return true;
+}
+
+///////////////////////////////////////////
+
+bool load_layers(layer_t **out_layer_list, int32_t *out_layer_count) {
+	layer_list_t list = {};
+
+	// Implicit layers first, that's the order the loader stacks them in
+	#if defined(_WIN32)
+	layer_read_registry(&list, HKEY_LOCAL_MACHINE, "SOFTWARE\\Khronos\\OpenXR\\1\\ApiLayers\\Implicit", true);
+	layer_read_registry(&list, HKEY_CURRENT_USER,  "SOFTWARE\\Khronos\\OpenXR\\1\\ApiLayers\\Implicit", true);
+	layer_read_registry(&list, HKEY_LOCAL_MACHINE, "SOFTWARE\\Khronos\\OpenXR\\1\\ApiLayers\\Explicit", false);
+	layer_read_registry(&list, HKEY_CURRENT_USER,  "SOFTWARE\\Khronos\\OpenXR\\1\\ApiLayers\\Explicit", false);
+	#elif defined(__linux__)
+	layer_discover_t implicit = { &list, true, "openxr/1/api_layers/implicit.d" };
+	discover_roots(layer_discover_dir, &implicit);
+
+	// XR_API_LAYER_PATH replaces the search paths for explicit layers only
+	const char      *layer_path = getenv("XR_API_LAYER_PATH");
+	layer_discover_t explicit_  = { &list, false, "openxr/1/api_layers/explicit.d" };
+	if (layer_path && layer_path[0]) {
+		explicit_.subdir = nullptr;
+		discover_split(layer_path, "", layer_discover_dir, &explicit_);
 	} else {
-		files[0] = runtime_default_list;
+		discover_roots(layer_discover_dir, &explicit_);
+	}
+	#endif
+
+	// Same rules as the runtimes: the first copy of each file and each
+	// layer name wins.
+	hash_set_t seen_files = {};
+	hash_set_t seen_names = {};
+	for (int32_t i = 0; i < list.count; i++) {
+		layer_t    *layer = &list.items[i];
+		struct stat info;
+		bool        exists = stat(layer->file, &info) == 0;
+		if (exists) manifest_load_layer(layer->file, &layer->manifest);
+
+		layer->present = layer->present && exists && layer->manifest.name[0] != '\0';
+		if (!layer->present) continue;
+
+		#if defined(_WIN32)
+		uint64_t file_key = hash_bytes(layer->file, strlen(layer->file), 1);
+		#else
+		uint64_t ino      = (uint64_t)info.st_ino;
+		uint64_t dev      = (uint64_t)info.st_dev;
+		uint64_t file_key = hash_bytes(&ino, sizeof(ino), hash_bytes(&dev, sizeof(dev), 1));
+		#endif
+		uint64_t name_key = hash_bytes(layer->manifest.name, strlen(layer->manifest.name), 2);
+
+		layer->present =
+			!hash_set_has(&seen_files, file_key) &&
+			!hash_set_has(&seen_names, name_key);
+		if (layer->present) {
+			hash_set_add(&seen_files, file_key);
+			hash_set_add(&seen_names, name_key);
+		}
 	}
-	
+	hash_set_free(&seen_files);
+	hash_set_free(&seen_names);
 
-	runtime_t *result_list  = nullptr;
-	int32_t    result_count = 0;
-	int32_t    file_id = 0;
-	const char*line    = files[0];
-	while (files[file_id] != nullptr) {
+	*out_layer_list  = list.items;
+	*out_layer_count = list.count;
+	return true;
+}
+
+///////////////////////////////////////////
+
+static void layer_list_add(layer_list_t *list, const char *file, bool implicit, bool disabled) {
+	if (list->count >= list->capacity) {
+		list->capacity = list->capacity == 0 ? 8 : list->capacity * 2;
+		list->items    = (layer_t *)realloc(list->items, sizeof(layer_t) * list->capacity);
+	}
+	layer_t *layer = &list->items[list->count++];
+	*layer = {};
+	snprintf(layer->file, sizeof(layer->file), "%s", file);
+	layer->implicit = implicit;
+	layer->present  = !disabled; // Until load_layers checks the rest
+}
+
+///////////////////////////////////////////
+
+#if defined(_WIN32)
+
+static void layer_read_registry(layer_list_t *list, HKEY root, const char *key_path, bool implicit) {
+	HKEY key = {};
+	if (RegOpenKeyExA(root, key_path, 0, KEY_READ, &key) != ERROR_SUCCESS || !key)
+		return;
+
+	// Same layout as AvailableRuntimes: the value name is the manifest
+	// path, and a non-zero DWORD disables it.
+	char  path[1024];
+	DWORD path_char_count     = sizeof(path);
+	DWORD value_type;
+	DWORD disabled;
+	DWORD disabled_byte_count = sizeof(disabled);
+	for (DWORD i=0; ;++i) {
+		auto res = RegEnumValueA(key, i, path, &path_char_count, nullptr, &value_type, reinterpret_cast<LPBYTE>(&disabled), &disabled_byte_count);
+		if (res == ERROR_NO_MORE_ITEMS) {
+			break;
+		}
+		if (res == ERROR_SUCCESS && value_type == REG_DWORD) {
+			path[path_char_count] = '\0';
+			layer_list_add(list, path, implicit, disabled != 0);
+		}
+		path_char_count     = sizeof(path);
+		disabled_byte_count = sizeof(disabled);
+	}
+	RegCloseKey(key);
+}
+
+#endif
+
+///////////////////////////////////////////
+
+static void runtime_list_add(runtime_list_t *list, const runtime_t &runtime, bool disabled) {
+	if (list->count + 1 > list->capacity) {
+		list->capacity = list->capacity < 8 ? 8 : list->capacity * 2;
+		list->items    = (runtime_t      *)realloc(list->items, sizeof(runtime_t)      * list->capacity);
+		list->files    = (runtime_file_t *)realloc(list->files, sizeof(runtime_file_t) * list->capacity);
+	}
+	list->items[list->count] = runtime;
+	list->files[list->count] = {};
+	list->files[list->count].disabled = disabled;
+	list->count += 1;
+}
+
+///////////////////////////////////////////
+
+static void runtime_parse_list(runtime_list_t *list, const char *text) {
+	const char *line = text;
+	while (line != nullptr) {
 		runtime_t runtime       = {};
 		int32_t   spaces        = 0;
 		int32_t   curr          = 0;
@@ -60,8 +385,7 @@ bool load_runtimes(const char *file, runtime_t **out_runtime_list, int32_t *out_
 				line = &line[i+1];
 				break;
 			} else if (line[i] == '\0') {
-				file_id++;
-				line = files[file_id];
+				line = nullptr;
 				break;
 			} else {
 				if      (spaces == 0) plat_name   [curr] = line[i];
@@ -76,134 +400,465 @@ bool load_runtimes(const char *file, runtime_t **out_runtime_list, int32_t *out_
 		else if (strcmp(plat_name,"linux"  ) == 0) runtime.platform = platform_linux;
 		else continue;
 
-		result_count += 1;
-		result_list = (runtime_t*)realloc(result_list, sizeof(runtime_t) * result_count);
-		result_list[result_count-1] = runtime;
+		runtime_list_add(list, runtime, false);
 	}
-	free(file_data);
+}
+
+///////////////////////////////////////////
 
+static void runtime_fill_manifest(runtime_t *runtime, manifest_cache_t *cache, const struct stat *info) {
 	#if defined(_WIN32)
-	platform_ curr_platform = platform_windows;
-	HKEY available_runtimes_key {};
-	if (RegOpenKeyExA(HKEY_LOCAL_MACHINE, "SOFTWARE\\Khronos\\OpenXR\\1\\AvailableRuntimes", 0, KEY_READ, &available_runtimes_key) == ERROR_SUCCESS && available_runtimes_key) {
-		// The actual limit is 16383 based on the registry limits:
-		//   https://learn.microsoft.com/en-us/windows/win32/sysinfo/registry-element-size-limits
-		// However, we'll stick to 1024 (including terminating null) as we need to fit in
-		// runtime_t::file
-		char path[1024];
-		// If we end up switching to wchar, this will still be a character count, not a byte count
-		DWORD path_char_count = sizeof(path);
-		DWORD value_type;
-		DWORD disabled;
-		DWORD disabled_byte_count = sizeof(disabled);
-		for (DWORD i=0; ;++i) {
-			auto res = RegEnumValueA(available_runtimes_key, i, path, &path_char_count, nullptr, &value_type, reinterpret_cast<LPBYTE>(&disabled), &disabled_byte_count);
-			if (res == ERROR_NO_MORE_ITEMS) {
-				break;
-			}
-			if (res == ERROR_SUCCESS && value_type == REG_DWORD) {
-				result_count += 1;
-				result_list = (runtime_t*)realloc(result_list, sizeof(runtime_t) * result_count);
-				auto& runtime = result_list[result_count - 1];
-				runtime.platform = curr_platform;
-				runtime.name[0] = 0;
-				memcpy(runtime.file, path, path_char_count);
-				runtime.file[path_char_count] = '\0';
-				runtime.present = file_exists(runtime.file) && !disabled;
+	int64_t mtime_sec  = (int64_t)info->st_mtime;
+	int64_t mtime_nsec = 0;
+	#else
+	int64_t mtime_sec  = (int64_t)info->st_mtim.tv_sec;
+	int64_t mtime_nsec = (int64_t)info->st_mtim.tv_nsec;
+	#endif
+
+	uint64_t                hash  = hash_bytes(runtime->file, strlen(runtime->file), 3);
+	manifest_cache_entry_t *entry = nullptr;
+	for (int32_t i = 0; i < cache->count; i++) {
+		if (cache->hashes[i] == hash && strcmp(cache->entries[i].file, runtime->file) == 0) {
+			entry = &cache->entries[i];
+			break;
+		}
+	}
+
+	bool current = entry &&
+		entry->dev        == (uint64_t)info->st_dev &&
+		entry->ino        == (uint64_t)info->st_ino &&
+		entry->size       == (uint64_t)info->st_size &&
+		entry->mtime_sec  == mtime_sec &&
+		entry->mtime_nsec == mtime_nsec;
+	if (!current) {
+		if (entry == nullptr) {
+			if (cache->count + 1 > cache->capacity) {
+				cache->capacity = cache->capacity < 16 ? 16 : cache->capacity * 2;
+				cache->entries  = (manifest_cache_entry_t *)realloc(cache->entries, sizeof(manifest_cache_entry_t) * cache->capacity);
+				cache->hashes   = (uint64_t               *)realloc(cache->hashes,  sizeof(uint64_t)               * cache->capacity);
 			}
-			path_char_count = sizeof(path);
-			disabled_byte_count = sizeof(disabled);
+			cache->hashes[cache->count] = hash;
+			entry = &cache->entries[cache->count];
+			cache->count += 1;
 		}
-		RegCloseKey(available_runtimes_key);
+
+		runtime_manifest_t manifest;
+		manifest_load_runtime(runtime->file, &manifest);
+		*entry = {};
+		memcpy(entry->file,                runtime->file,                sizeof(entry->file));
+		memcpy(entry->file_format_version, manifest.file_format_version, sizeof(entry->file_format_version));
+		memcpy(entry->name,                manifest.name,                sizeof(entry->name));
+		memcpy(entry->library_path,        manifest.library_path,        sizeof(entry->library_path));
+		memcpy(entry->negotiate_function,  manifest.negotiate_function,  sizeof(entry->negotiate_function));
+		entry->dev        = (uint64_t)info->st_dev;
+		entry->ino        = (uint64_t)info->st_ino;
+		entry->size       = (uint64_t)info->st_size;
+		entry->mtime_sec  = mtime_sec;
+		entry->mtime_nsec = mtime_nsec;
+		cache->dirty = true;
 	}
-	#elif defined(__linux)
-	platform_ curr_platform = platform_linux;
 
-	// On linux, we want to support the '~' path feature, esp. for SteamVR
-	const char *user = getenv("USER");
-	if (strcmp(user, "root") == 0)
-		user = getenv("SUDO_USER");
-		
-	char path_tmp[1024];
-	for (int32_t i=0; i<result_count; i+=1) {
-		if (result_list[i].file[0] == '~') {
-			snprintf(path_tmp, sizeof(path_tmp), "/home/%s%s", user, &result_list[i].file[1]);
-			strcpy(result_list[i].file, path_tmp);
+	memcpy(runtime->file_format_version, entry->file_format_version, sizeof(runtime->file_format_version));
+	memcpy(runtime->library_path,        entry->library_path,        sizeof(runtime->library_path));
+	memcpy(runtime->negotiate_function,  entry->negotiate_function,  sizeof(runtime->negotiate_function));
+
+	// Names from the runtime list take priority over the manifest's
+	if (!runtime->name[0])
+		memcpy(runtime->name, entry->name, sizeof(runtime->name));
+
+	if (runtime->name[0]) {
+		return;
+	}
+
+	// "name" is an optional field in the manifest, so might be legitimately be missing,
+	// or we might have had a failure. If so, let's try and put *something* there
+	auto basename_start = strrchr(runtime->file, '\\');
+	auto basename_slash = strrchr(runtime->file, '/');
+	if (basename_slash > basename_start) basename_start = basename_slash;
+	auto basename_end = strrchr(runtime->file, '.');
+	if (basename_start && basename_end > basename_start) {
+		basename_start++;
+		memcpy(runtime->name, basename_start, basename_end - basename_start);
+		runtime->name[basename_end - basename_start] = '\0';
+	} else {
+		memcpy(runtime->name, "Unknown", sizeof("Unknown"));
+	}
+}
+
+///////////////////////////////////////////
+
+static void manifest_cache_read(const char *file, manifest_cache_t *out_cache) {
+	*out_cache = {};
+	FILE *fp = fopen(file, "rb");
+	if (fp == nullptr) return;
+
+	uint32_t header[3] = {};
+	if (fread(header, sizeof(header), 1, fp) == 1 &&
+		header[0] == manifest_cache_magic   &&
+		header[1] == manifest_cache_version &&
+		header[2] <= (uint32_t)manifest_cache_max) {
+
+		int32_t count = (int32_t)header[2];
+		out_cache->capacity = count < 16 ? 16 : count;
+		out_cache->entries  = (manifest_cache_entry_t *)malloc(sizeof(manifest_cache_entry_t) * out_cache->capacity);
+		out_cache->hashes   = (uint64_t               *)malloc(sizeof(uint64_t)               * out_cache->capacity);
+		if (fread(out_cache->entries, sizeof(manifest_cache_entry_t), count, fp) == (size_t)count) {
+			out_cache->count = count;
+			for (int32_t i = 0; i < count; i++) {
+				manifest_cache_entry_t *entry = &out_cache->entries[i];
+				entry->file               [sizeof(entry->file)               - 1] = '\0';
+				entry->file_format_version[sizeof(entry->file_format_version) - 1] = '\0';
+				entry->name               [sizeof(entry->name)               - 1] = '\0';
+				entry->library_path       [sizeof(entry->library_path)       - 1] = '\0';
+				entry->negotiate_function [sizeof(entry->negotiate_function) - 1] = '\0';
+				out_cache->hashes[i] = hash_bytes(entry->file, strlen(entry->file), 3);
+			}
 		}
 	}
+	fclose(fp);
+}
+
+///////////////////////////////////////////
+
+static void manifest_cache_write(const char *file, const manifest_cache_t *cache) {
+	// Newest entries are at the end, so trim from the front if we're over
+	int32_t start = cache->count > manifest_cache_max ? cache->count - manifest_cache_max : 0;
+	int32_t count = cache->count - start;
+
+	// Write to the side and rename over, so a concurrent reader (the GUI
+	// and xrsetruntime can both be loading) never sees half a file. Each
+	// writer gets a side file of its own, as two threads or processes can
+	// be writing at once too.
+	char tmp_file[1100];
+	#if defined(_WIN32)
+	int32_t length = snprintf(tmp_file, sizeof(tmp_file), "%s.%lu.%lu.tmp", file, GetCurrentProcessId(), GetCurrentThreadId());
+	if (length < 0 || length >= (int32_t)sizeof(tmp_file)) return;
+	FILE *fp = fopen(tmp_file, "wb");
+	#else
+	int32_t length = snprintf(tmp_file, sizeof(tmp_file), "%s.XXXXXX", file);
+	if (length < 0 || length >= (int32_t)sizeof(tmp_file)) return;
+	int   fd = mkstemp(tmp_file);
+	FILE *fp = fd >= 0 ? fdopen(fd, "wb") : nullptr;
+	if (fd >= 0 && fp == nullptr) { close(fd); remove(tmp_file); }
 	#endif
-	for (int32_t i=0; i<result_count; i+=1) {
-		auto& runtime = result_list[i];
-		if (runtime.name[0] || !file_exists(runtime.file)) {
-			continue;
-		}
+	if (fp == nullptr) return;
+
+	uint32_t header[3] = { manifest_cache_magic, manifest_cache_version, (uint32_t)count };
+	bool ok =
+		fwrite(header, sizeof(header), 1, fp) == 1 &&
+		fwrite(&cache->entries[start], sizeof(manifest_cache_entry_t), count, fp) == (size_t)count;
+	ok = fclose(fp) == 0 && ok;
+
+	if (ok) {
+		#if defined(_WIN32)
+		MoveFileExA(tmp_file, file, MOVEFILE_REPLACE_EXISTING);
+		#else
+		rename(tmp_file, file);
+		#endif
+	} else {
+		remove(tmp_file);
+	}
+}
 
-		// Try to read the name rom the JSON
-		auto json = read_file(runtime.file);
-		if (!json) {
-			continue;
-		}
-		try {
-			const auto manifest = nlohmann::json::parse(json);
-			free(json);	
-			json = nullptr;
-			if (manifest.contains("runtime")) {
-				const auto& runtime_metadata = manifest.at("runtime");
-				if (runtime_metadata.contains("name")) {
-					const auto& name = runtime_metadata.at("name");
-					if (name.is_string()) {
-						auto str = name.get<std::string>();
-						// Include trailing null in copy
-						if (str.size() + 1 <= sizeof(runtime.name)) {
-							memcpy(runtime.name, str.c_str(), str.size() + 1);
-						}
-					}
-				}
-			}
-		} catch (const nlohmann::json::exception&) {
-			if (json) {
-				free(json);
-			}
+///////////////////////////////////////////
+
+static void manifest_cache_free(manifest_cache_t *cache) {
+	free(cache->entries);
+	free(cache->hashes);
+	*cache = {};
+}
+
+///////////////////////////////////////////
+
+static uint64_t hash_bytes(const void *data, size_t size, uint64_t hash) {
+	// FNV-1a, seeded so different key kinds don't collide on equal bytes
+	hash ^= 14695981039346656037ULL;
+	const uint8_t *bytes = (const uint8_t *)data;
+	for (size_t i = 0; i < size; i++)
+		hash = (hash ^ bytes[i]) * 1099511628211ULL;
+	return hash == 0 ? 1 : hash;
+}
+
+///////////////////////////////////////////
+
+static bool hash_set_has(const hash_set_t *set, uint64_t hash) {
+	if (set->capacity == 0) return false;
+	size_t mask = set->capacity - 1;
+	for (size_t i = hash & mask; set->slots[i] != 0; i = (i + 1) & mask) {
+		if (set->slots[i] == hash) return true;
+	}
+	return false;
+}
+
+///////////////////////////////////////////
+
+// Returns false if the hash was already in the set
+static bool hash_set_add(hash_set_t *set, uint64_t hash) {
+	if ((set->count + 1) * 2 > set->capacity) {
+		hash_set_t grown = {};
+		grown.capacity = set->capacity < 16 ? 16 : set->capacity * 2;
+		grown.slots    = (uint64_t *)calloc(grown.capacity, sizeof(uint64_t));
+		for (size_t i = 0; i < set->capacity; i++) {
+			if (set->slots[i]) hash_set_add(&grown, set->slots[i]);
 		}
+		free(set->slots);
+		*set = grown;
+	}
 
-		if (runtime.name[0]) {
-			continue;
+	size_t mask = set->capacity - 1;
+	for (size_t i = hash & mask; ; i = (i + 1) & mask) {
+		if (set->slots[i] == hash) return false;
+		if (set->slots[i] == 0) {
+			set->slots[i] = hash;
+			set->count += 1;
+			return true;
 		}
+	}
+}
+
+///////////////////////////////////////////
+
+static void hash_set_free(hash_set_t *set) {
+	free(set->slots);
+	*set = {};
+}
+
+///////////////////////////////////////////
+
+#if defined(__linux__)
+
+static void runtime_home_dir_build(char *out_home, size_t out_home_size) {
+	// Under sudo (as xrsetruntime usually is), use the invoking user's home
+	const char *user = getenv("USER");
+	if (user && strcmp(user, "root") == 0 && getenv("SUDO_USER")) {
+		snprintf(out_home, out_home_size, "/home/%s", getenv("SUDO_USER"));
+	} else if (getenv("HOME")) {
+		snprintf(out_home, out_home_size, "%s", getenv("HOME"));
+	} else {
+		snprintf(out_home, out_home_size, "/home/%s", user ? user : "");
+	}
+}
+
+static const char *runtime_home_dir() {
+	// Built once like runtime_config_path, as discovery can run on two
+	// threads at once.
+	static char home[512];
+	static bool built = (runtime_home_dir_build(home, sizeof(home)), true);
+	(void)built;
+	return home;
+}
+
+///////////////////////////////////////////
+
+static int discover_sort(const void *a, const void *b) {
+	return strcmp(*(const char **)a, *(const char **)b);
+}
+
+// The .json file names in a folder, sorted since readdir order isn't
+// stable and we want the list to be predictable. Names are strdup'ed.
+static int32_t discover_json(const char *dir_path, char **out_names, int32_t max_names) {
+	DIR *dir = opendir(dir_path);
+	if (dir == nullptr) return 0;
+
+	int32_t name_count = 0;
+	while (dirent *entry = readdir(dir)) {
+		const char *ext = strrchr(entry->d_name, '.');
+		if (ext == nullptr || strcmp(ext, ".json") != 0) continue;
+		if (name_count < max_names)
+			out_names[name_count++] = strdup(entry->d_name);
+	}
+	closedir(dir);
+	qsort(out_names, name_count, sizeof(char *), discover_sort);
+	return name_count;
+}
+
+///////////////////////////////////////////
 
-		// "name" is an optional field in the manifest, so might be legitimately be missing,
-		// or we might have had a failure. If so, let's try and put *something* there
-		auto basename_start = strrchr(runtime.file, '\\');
-		auto basename_end = strrchr(runtime.file, '.');
-		if (basename_start && basename_end > basename_start) {
-			basename_start++;
-			memcpy(runtime.name, basename_start, basename_end - basename_start);
-			runtime.name[basename_end - basename_start] = '\0';
-		} else {
-			memcpy(runtime.name, "Unknown", sizeof("Unknown"));
+static void discover_split(const char *dirs, const char *fallback, discover_fn on_dir, void *data) {
+	if (dirs == nullptr || dirs[0] == '\0') dirs = fallback;
+
+	char root[1024];
+	while (*dirs) {
+		const char *end = strchr(dirs, ':');
+		size_t      len = end ? (size_t)(end - dirs) : strlen(dirs);
+		if (len > 0 && len < sizeof(root)) {
+			memcpy(root, dirs, len);
+			root[len] = '\0';
+			on_dir(root, data);
 		}
+		if (!end) break;
+		dirs = end + 1;
 	}
+}
 
-	for (int32_t i=0; i<result_count; i+=1) {
-		// See if there's an earlier one
-		bool exists = false;
-		for (size_t e = 0; e < i; e++) {
-			if (result_list[e].present && strcmp(result_list[e].name, result_list[i].name) == 0) {
-				exists = true;
-				break;
-			}
+///////////////////////////////////////////
+
+static void discover_roots(discover_fn on_root, void *data) {
+	// Same order the loader searches for active_runtime.json and for API
+	// layers. Directories that show up twice are harmless, their manifests
+	// dedupe by inode.
+	char home_path[1024];
+	const char *home = runtime_home_dir();
+
+	const char *config_home = getenv("XDG_CONFIG_HOME");
+	if (config_home && config_home[0]) {
+		on_root(config_home, data);
+	} else {
+		snprintf(home_path, sizeof(home_path), "%s/.config", home);
+		on_root(home_path, data);
+	}
+	discover_split(getenv("XDG_CONFIG_DIRS"), "/etc/xdg", on_root, data);
+	on_root("/etc", data);
+
+	const char *data_home = getenv("XDG_DATA_HOME");
+	if (data_home && data_home[0]) {
+		on_root(data_home, data);
+	}
+	snprintf(home_path, sizeof(home_path), "%s/.local/share", home);
+	on_root(home_path, data);
+	discover_split(getenv("XDG_DATA_DIRS"), "/usr/local/share:/usr/share", on_root, data);
+	on_root("/usr/share", data);
+}
+
+///////////////////////////////////////////
+
+static void runtime_discover_dir(const char *root, void *data) {
+	runtime_list_t *list = (runtime_list_t *)data;
+
+	char dir_path[1024];
+	snprintf(dir_path, sizeof(dir_path), "%s/openxr/1", root);
+	char   *names[128];
+	int32_t name_count = discover_json(dir_path, names, (int32_t)(sizeof(names)/sizeof(names[0])));
+
+	for (int32_t i = 0; i < name_count; i++) {
+		// active_runtime.json is the loader's pointer to one of the others,
+		// listing it would let xrsetruntime point it at itself. Paths too long
+		// for runtime.file would name some other file, so those go too.
+		runtime_t runtime = {};
+		runtime.platform = platform_linux;
+		if (strncmp(names[i], "active_runtime", 14) != 0 &&
+			snprintf(runtime.file, sizeof(runtime.file), "%s/%s", dir_path, names[i]) < (int)sizeof(runtime.file)) {
+			runtime_list_add(list, runtime, false);
 		}
-		
-		result_list[i].present = 
-			!exists &&
-			result_list[i].platform == curr_platform && 
-			file_exists(result_list[i].file);
+		free(names[i]);
 	}
+}
 
-	*out_runtime_list  = result_list;
-	*out_runtime_count = result_count;
-	return true;
+///////////////////////////////////////////
+
+static void runtime_discover(runtime_list_t *list) {
+	discover_roots(runtime_discover_dir, list);
+}
+
+///////////////////////////////////////////
+
+static void layer_discover_dir(const char *root, void *data) {
+	layer_discover_t *discover = (layer_discover_t *)data;
+
+	char dir_path[1024];
+	if (discover->subdir) snprintf(dir_path, sizeof(dir_path), "%s/%s", root, discover->subdir);
+	else                  snprintf(dir_path, sizeof(dir_path), "%s", root);
+	char   *names[128];
+	int32_t name_count = discover_json(dir_path, names, (int32_t)(sizeof(names)/sizeof(names[0])));
+
+	char file[1024];
+	for (int32_t i = 0; i < name_count; i++) {
+		if (snprintf(file, sizeof(file), "%s/%s", dir_path, names[i]) < (int)sizeof(file))
+			layer_list_add(discover->list, file, discover->implicit, false);
+		free(names[i]);
+	}
+}
+
+#endif
+
+///////////////////////////////////////////
+
+#if defined(__linux__)
+
+struct runtime_active_find_t {
+	char  *file;
+	size_t file_size;
+	bool   found;
+};
+
+static void runtime_active_dir(const char *root, void *data) {
+	runtime_active_find_t *find = (runtime_active_find_t *)data;
+	if (find->found) return;
+
+	// The loader prefers a manifest for this architecture
+	#if   defined(__x86_64__)
+	const char *arch = "x86_64";
+	#elif defined(__aarch64__)
+	const char *arch = "aarch64";
+	#elif defined(__i386__)
+	const char *arch = "i686";
+	#else
+	const char *arch = nullptr;
+	#endif
+	if (arch) {
+		snprintf(find->file, find->file_size, "%s/openxr/1/active_runtime.%s.json", root, arch);
+		if (file_exists(find->file)) { find->found = true; return; }
+	}
+	snprintf(find->file, find->file_size, "%s/openxr/1/active_runtime.json", root);
+	find->found = file_exists(find->file);
 }
 
+#endif
+
+///////////////////////////////////////////
+
+bool runtime_active_file(char *out_file, size_t out_file_size) {
+	out_file[0] = '\0';
+	const char *env = getenv("XR_RUNTIME_JSON");
+	if (env && env[0]) {
+		snprintf(out_file, out_file_size, "%s", env);
+		return true;
+	}
+
+	#if defined(_WIN32)
+	DWORD size = (DWORD)out_file_size;
+	if (RegGetValueA(HKEY_LOCAL_MACHINE, "SOFTWARE\\Khronos\\OpenXR\\1", "ActiveRuntime", RRF_RT_REG_SZ, nullptr, out_file, &size) == ERROR_SUCCESS)
+		return true;
+	out_file[0] = '\0';
+	return false;
+	#elif defined(__linux__)
+	// Only the config folders, active_runtime.json isn't looked for in
+	// the data folders.
+	runtime_active_find_t find = { out_file, out_file_size, false };
+	char        home_path[1024];
+	const char *config_home = getenv("XDG_CONFIG_HOME");
+	if (config_home && config_home[0]) {
+		runtime_active_dir(config_home, &find);
+	} else {
+		snprintf(home_path, sizeof(home_path), "%s/.config", runtime_home_dir());
+		runtime_active_dir(home_path, &find);
+	}
+	discover_split(getenv("XDG_CONFIG_DIRS"), "/etc/xdg", runtime_active_dir, &find);
+	runtime_active_dir("/etc", &find);
+	if (!find.found) out_file[0] = '\0';
+	return find.found;
+	#else
+	return false;
+	#endif
+}
+
+///////////////////////////////////////////
+
+static std::mutex runtime_env_mutex;
+
+void runtime_env_set(const char *name, const char *value) {
+	std::lock_guard<std::mutex> lock(runtime_env_mutex);
+#if defined(_WIN32)
+	_putenv_s(name, value ? value : ""); // Empty removes it
+#else
+	if (value) setenv  (name, value, 1);
+	else       unsetenv(name);
+#endif
+}
+
+void runtime_env_lock  () { runtime_env_mutex.lock  (); }
+void runtime_env_unlock() { runtime_env_mutex.unlock(); }
+
 ///////////////////////////////////////////
 
 void ensure_runtime_config_exists(const char *at_file) {
@@ -227,19 +882,47 @@ const char *runtime_config_path() {
 	return "runtimes.txt";
 }
 
+const char *runtime_cache_path() {
+	return "manifest_cache.bin";
+}
+
 #elif defined(__linux__) 
 
-char runtime_config_path_str[1024];
-const char *runtime_config_path() {
+// Both are built once, on first use, and never written again. The GUI's
+// startup scan and its first probe can load the runtime list on two
+// threads at once, and a path that's rebuilt on every call would change
+// under whichever one is reading it.
+static void runtime_config_path_build(char *out_path, size_t out_path_size) {
 	const char *config_root = getenv("XDG_CONFIG_HOME");
 	if (config_root == nullptr) {
 		config_root = getenv("HOME");
-		snprintf(runtime_config_path_str, sizeof(runtime_config_path_str), "%s/.config/openxr-explorer/runtimes.txt", config_root);
+		snprintf(out_path, out_path_size, "%s/.config/openxr-explorer/runtimes.txt", config_root);
 	} else {
-		snprintf(runtime_config_path_str, sizeof(runtime_config_path_str), "%s/openxr-explorer/runtimes.txt", config_root);
+		snprintf(out_path, out_path_size, "%s/openxr-explorer/runtimes.txt", config_root);
 	}
-	
-	return runtime_config_path_str;
+}
+
+static void runtime_cache_path_build(char *out_path, size_t out_path_size) {
+	// Next to runtimes.txt
+	snprintf(out_path, out_path_size, "%s", runtime_config_path());
+	char *slash = strrchr(out_path, '/');
+	if (slash) slash[1]   = '\0';
+	else       out_path[0] = '\0';
+	strncat(out_path, "manifest_cache.bin", out_path_size - strlen(out_path) - 1);
+}
+
+const char *runtime_config_path() {
+	static char path[1024];
+	static bool built = (runtime_config_path_build(path, sizeof(path)), true);
+	(void)built;
+	return path;
+}
+
+const char *runtime_cache_path() {
+	static char path[1024];
+	static bool built = (runtime_cache_path_build(path, sizeof(path)), true);
+	(void)built;
+	return path;
 }
 
 #endif
@@ -1,8 +1,11 @@
 #pragma once
 
 #include <stdint.h>
+#include <stddef.h>
 #include <stdbool.h>
 
+#include "xrmanifest.h"
+
 /*** Types *******************************/
 
 typedef enum platform_ {
@@ -16,10 +19,37 @@ typedef struct runtime_t {
 	char      name[64];
 	char      file[1024];
 	bool      present;
+
+	// From the manifest, empty if it couldn't be read
+	char      file_format_version[16];
+	char      library_path[1024];
+	char      negotiate_function[128];
 } runtime_t;
 
+typedef struct layer_t {
+	char             file[1024];
+	bool             implicit;
+	bool             present;  // Readable, not disabled in the registry, and not listed twice
+	layer_manifest_t manifest; // Empty if it couldn't be read
+} layer_t;
+
 /*** Signatures **************************/
 
 const char *runtime_config_path();
+const char *runtime_cache_path ();
 void ensure_runtime_config_exists(const char *at_file);
-bool load_runtimes(const char *file, runtime_t **out_runtime_list, int32_t *out_runtime_count);
\ No newline at end of file
+bool load_runtimes(const char *file, runtime_t **out_runtime_list, int32_t *out_runtime_count);
+// Reads the API layer manifests straight from the loader's search paths,
+// implicit layers first. Free the list with free().
+bool load_layers  (layer_t **out_layer_list, int32_t *out_layer_count);
+// The manifest the loader would use for this process: XR_RUNTIME_JSON if
+// it's set, otherwise the system's active runtime.
+bool runtime_active_file(char *out_file, size_t out_file_size);
+// setenv can move environ while another thread is walking it, to hand it
+// to a child process. Changes to the environment after startup go through
+// runtime_env_set, and code that passes environ to a child holds
+// runtime_env_lock until the child has been started. A null value removes
+// the variable.
+void runtime_env_set   (const char *name, const char *value);
+void runtime_env_lock  ();
+void runtime_env_unlock();
\ No newline at end of file
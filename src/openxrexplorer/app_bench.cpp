@@ -0,0 +1,424 @@
+#include "app_bench.h"
+#include "app_cli.h"
+#include "app_process.h"
+#include "xrruntime.h"
+#include "xrpreflight.h"
+#include "xrprefetch.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*** Types *******************************/
+
+enum bench_step_ {
+	bench_step_instance,
+	bench_step_system,
+	bench_step_session,
+	bench_step_process,
+	bench_step_max,
+};
+
+/*** Global Variables ********************/
+
+const char *bench_step_names[bench_step_max] = {
+	"xrCreateInstance",
+	"xrGetSystem",
+	"xrCreateSession",
+	"Whole process",
+};
+
+/*** Signatures **************************/
+
+static const char *bench_graphics_arg(xr_graphics_preference_t preference);
+static void        bench_run_child   (const char **args, int32_t arg_count, const char **env, int32_t env_count, float *out_times, char *out_error, size_t error_size);
+static void        bench_unset_env   (const char *name);
+
+/*** Code ********************************/
+
+void bench_runtimes_child(xr_settings_t settings) {
+	xr_startup_times_t times = openxr_time_startup(settings);
+	printf("xrb\t%f\t%f\t%f\t%s\n", times.instance_ms, times.system_ms, times.session_ms, times.error ? times.error : "");
+}
+
+///////////////////////////////////////////
+
+void bench_runtimes(int32_t runs, xr_settings_t settings) {
+	runtime_t *runtime_list  = nullptr;
+	int32_t    runtime_count = 0;
+	load_runtimes(runtime_config_path(), &runtime_list, &runtime_count);
+	if (runtime_count == 0) {
+		printf("No runtimes found!\n");
+		return;
+	}
+
+	// No sense timing something that can't even load
+	preflight_result_t *preflight = (preflight_result_t*)malloc(sizeof(preflight_result_t) * runtime_count);
+	runtime_preflight(runtime_list, runtime_count, 5000, preflight);
+
+	// samples[(runtime * 2 + warm) * bench_step_max + step]
+	array_t<float> *samples = (array_t<float>*)calloc(runtime_count * 2 * bench_step_max, sizeof(array_t<float>));
+	const char    **errors  = (const char    **)calloc(runtime_count, sizeof(const char *));
+
+	const char *args[3]   = { "-benchChild", bench_graphics_arg(settings.graphics_preference), "-session" };
+	int32_t     arg_count = settings.allow_session ? 3 : 2;
+
+	// Round robin, so every runtime's first start in a round comes right
+	// after a different runtime ran: that one is cold. Starting it again
+	// straight away is warm, with its files and libraries still cached.
+	for (int32_t round = 0; round < runs; round++) {
+		fprintf(stderr, "Round %d/%d\n", round + 1, runs);
+		for (int32_t i = 0; i < runtime_count; i++) {
+			if (!runtime_list[i].present || preflight[i].status != preflight_ok) continue;
+
+			char        env_runtime[1100];
+			const char *env[1] = { env_runtime };
+			snprintf(env_runtime, sizeof(env_runtime), "XR_RUNTIME_JSON=%s", runtime_list[i].file);
+
+			for (int32_t warm = 0; warm < 2; warm++) {
+				float times[bench_step_max] = {};
+				char  error[128];
+				bench_run_child(args, arg_count, env, 1, times, error, sizeof(error));
+
+				array_t<float> *runtime_samples = &samples[(i * 2 + warm) * bench_step_max];
+				if (error[0] == '\0') {
+					for (int32_t step = 0; step < bench_step_max; step++)
+						runtime_samples[step].add(times[step]);
+				} else if (errors[i] == nullptr) {
+					errors[i] = new_string("%s", error);
+				}
+			}
+		}
+	}
+
+	for (int32_t i = 0; i < runtime_count; i++) {
+		if (!runtime_list[i].present) continue;
+
+		printf("\n%s (%s)\n", runtime_list[i].name, runtime_list[i].file);
+		if (preflight[i].status != preflight_ok) {
+			printf("Skipped, %s: %s\n", preflight_status_str(preflight[i].status), preflight[i].reason);
+			continue;
+		}
+		if (errors[i]) printf("Some runs failed: %s\n", errors[i]);
+
+		display_table_t table = {};
+		table.name_func    = "benchRuntimes";
+		table.column_count = 3;
+		table.cols[0].add({ "Time to (ms)" });
+		table.cols[1].add({ "Cold min / median / p95" });
+		table.cols[2].add({ "Warm min / median / p95" });
+		for (int32_t step = 0; step < bench_step_max; step++) {
+			if (step == bench_step_session && !settings.allow_session) continue;
+
+			table.cols[0].add({ bench_step_names[step] });
+			for (int32_t warm = 0; warm < 2; warm++) {
+				const array_t<float> *step_samples = &samples[(i * 2 + warm) * bench_step_max + step];
+				stats_t               stats        = stats_summary(step_samples->data, (int32_t)step_samples->count);
+				table.cols[1 + warm].add({ stats.count == 0
+					? "-"
+					: new_string("%.1f / %.1f / %.1f", stats.min, stats.median, stats.p95) });
+			}
+		}
+		cli_print_table(&table);
+		for (int32_t c = 0; c < table.column_count; c++) table.cols[c].free();
+	}
+
+	for (int32_t i = 0; i < runtime_count * 2 * bench_step_max; i++) samples[i].free();
+	free(samples);
+	free(errors);
+	free(preflight);
+	free(runtime_list);
+	openxr_info_release(); // Frees the new_string text
+}
+
+///////////////////////////////////////////
+
+void bench_layers(int32_t runs, xr_settings_t settings) {
+	display_table_t listing = openxr_layer_manifest_table();
+	cli_print_table(&listing);
+	if (listing.error) printf("| %s |\n", listing.error);
+	for (int32_t c = 0; c < listing.column_count; c++) listing.cols[c].free();
+
+	layer_t *layer_list  = nullptr;
+	int32_t  layer_count = 0;
+	load_layers(&layer_list, &layer_count);
+
+	// Every configuration is described completely through the environment
+	// we hand the child, so anything inherited from ours would skew it.
+	bool cleared = false;
+	for (int32_t i = 0; i < layer_count; i++) {
+		const layer_manifest_t *manifest = &layer_list[i].manifest;
+		if (manifest->disable_environment[0] && getenv(manifest->disable_environment)) { bench_unset_env(manifest->disable_environment); cleared = true; }
+		if (manifest->enable_environment [0] && getenv(manifest->enable_environment )) { bench_unset_env(manifest->enable_environment ); cleared = true; }
+	}
+	if (getenv("XR_ENABLE_API_LAYERS")) { bench_unset_env("XR_ENABLE_API_LAYERS"); cleared = true; }
+	if (cleared) printf("\nIgnoring layer variables set in this environment.\n");
+
+	// Only layers the loader would pick up on its own can be switched off,
+	// an implicit layer without a disable_environment never loads at all.
+	array_t<const layer_t *> implicit   = {};
+	array_t<const char *>    env_off    = {};
+	array_t<const char *>    env_on     = {};
+	char                     explicit_names[4096] = "";
+	for (int32_t i = 0; i < layer_count; i++) {
+		const layer_t *layer = &layer_list[i];
+		if (!layer->present) continue;
+		if (!layer->implicit) {
+			#if defined(_WIN32)
+			const char *separator = ";";
+			#else
+			const char *separator = ":";
+			#endif
+			if (explicit_names[0]) strncat(explicit_names, separator, sizeof(explicit_names) - strlen(explicit_names) - 1);
+			strncat(explicit_names, layer->manifest.name, sizeof(explicit_names) - strlen(explicit_names) - 1);
+			continue;
+		}
+		if (layer->manifest.disable_environment[0] == '\0') continue;
+		implicit.add(layer);
+		env_off .add(new_string("%s=1", layer->manifest.disable_environment));
+		env_on  .add(layer->manifest.enable_environment[0] ? new_string("%s=1", layer->manifest.enable_environment) : nullptr);
+	}
+	if (implicit.count == 0 && explicit_names[0] == '\0') {
+		printf("\nNo API layers to measure.\n");
+		implicit.free();
+		env_off .free();
+		env_on  .free();
+		free(layer_list);
+		openxr_info_release();
+		return;
+	}
+
+	// Configuration 0 has every layer off, 1 has every layer on, and the
+	// rest have one implicit layer on by itself.
+	int32_t               config_count = 2 + (int32_t)implicit.count;
+	array_t<const char *> *config_env  = (array_t<const char *>*)calloc(config_count, sizeof(array_t<const char *>));
+	const char           **names       = (const char           **)calloc(config_count, sizeof(const char *));
+	names[0] = "No layers";
+	names[1] = explicit_names[0] ? "All layers, explicit ones too" : "All layers";
+	for (size_t i = 0; i < implicit.count; i++) {
+		config_env[0].add(env_off[i]);
+		if (env_on[i]) config_env[1].add(env_on[i]);
+	}
+	if (explicit_names[0]) config_env[1].add(new_string("XR_ENABLE_API_LAYERS=%s", explicit_names));
+	for (size_t i = 0; i < implicit.count; i++) {
+		array_t<const char *> *env = &config_env[2 + i];
+		for (size_t j = 0; j < implicit.count; j++) {
+			if (j != i) env->add(env_off[j]);
+		}
+		if (env_on[i]) env->add(env_on[i]);
+		names[2 + i] = implicit[i]->manifest.name;
+	}
+
+	array_t<float> *samples = (array_t<float>*)calloc(config_count, sizeof(array_t<float>));
+	const char    **errors  = (const char    **)calloc(config_count, sizeof(const char *));
+	const char     *args[2] = { "-benchChild", bench_graphics_arg(settings.graphics_preference) };
+
+	// Round robin, so no configuration always runs right after the same one
+	for (int32_t round = 0; round < runs; round++) {
+		fprintf(stderr, "Round %d/%d\n", round + 1, runs);
+		for (int32_t c = 0; c < config_count; c++) {
+			float times[bench_step_max] = {};
+			char  error[128];
+			bench_run_child(args, 2, config_env[c].data, (int32_t)config_env[c].count, times, error, sizeof(error));
+			if (error[0] == '\0')      samples[c].add(times[bench_step_instance]);
+			else if (errors[c] == nullptr) errors[c] = new_string("%s", error);
+		}
+	}
+
+	stats_t base = stats_summary(samples[0].data, (int32_t)samples[0].count);
+
+	display_table_t table = {};
+	table.name_func    = "benchLayers";
+	table.column_count = 3;
+	table.cols[0].add({ "Layers" });
+	table.cols[1].add({ "xrCreateInstance min / median / p95 (ms)" });
+	table.cols[2].add({ "Overhead (median ms)" });
+	for (int32_t c = 0; c < config_count; c++) {
+		stats_t stats = stats_summary(samples[c].data, (int32_t)samples[c].count);
+		table.cols[0].add({ names[c] });
+		if (stats.count == 0) {
+			table.cols[1].add({ "-" });
+			table.cols[2].add({ "-" });
+			continue;
+		}
+		table.cols[1].add({ new_string("%.1f / %.1f / %.1f", stats.min, stats.median, stats.p95) });
+		table.cols[2].add({ c == 0 || base.count == 0
+			? "-"
+			: new_string("%+.1f", stats.median - base.median) });
+	}
+	printf("\n");
+	cli_print_table(&table);
+	for (int32_t c = 0; c < config_count; c++) {
+		if (errors[c]) printf("%s: some runs failed, %s\n", names[c], errors[c]);
+	}
+
+	for (int32_t c = 0; c < table.column_count; c++) table.cols[c].free();
+	for (int32_t c = 0; c < config_count; c++) {
+		samples   [c].free();
+		config_env[c].free();
+	}
+	free(samples);
+	free(errors);
+	free(names);
+	free(config_env);
+	implicit.free();
+	env_off .free();
+	env_on  .free();
+	free(layer_list);
+	openxr_info_release(); // Frees the new_string text
+}
+
+///////////////////////////////////////////
+
+void bench_prefetch(int32_t runs, xr_settings_t settings) {
+#if !defined(__linux__)
+	(void)runs; (void)settings;
+	printf("-benchPrefetch needs to drop files from the page cache, and that's Linux only.\n");
+#else
+	runtime_t *runtime_list  = nullptr;
+	int32_t    runtime_count = 0;
+	load_runtimes(runtime_config_path(), &runtime_list, &runtime_count);
+	if (runtime_count == 0) {
+		printf("No runtimes found!\n");
+		return;
+	}
+	preflight_result_t *preflight = (preflight_result_t*)malloc(sizeof(preflight_result_t) * runtime_count);
+	runtime_preflight(runtime_list, runtime_count, 5000, preflight);
+
+	const char *args[2] = { "-benchChild", bench_graphics_arg(settings.graphics_preference) };
+	for (int32_t i = 0; i < runtime_count; i++) {
+		if (!runtime_list[i].present) continue;
+
+		printf("\n%s (%s)\n", runtime_list[i].name, runtime_list[i].file);
+		if (preflight[i].status != preflight_ok) {
+			printf("Skipped, %s: %s\n", preflight_status_str(preflight[i].status), preflight[i].reason);
+			continue;
+		}
+		prefetch_set_t set = {};
+		prefetch_add_runtime(&set, &runtime_list[i]);
+
+		char        env_runtime[1100];
+		const char *env[1] = { env_runtime };
+		snprintf(env_runtime, sizeof(env_runtime), "XR_RUNTIME_JSON=%s", runtime_list[i].file);
+
+		// [prefetched][step], and what was still cached when the child started
+		array_t<float> samples [2][bench_step_max] = {};
+		array_t<float> cached  [2]                 = {};
+		array_t<float> issue_ms                    = {};
+		const char    *error_text                  = nullptr;
+		for (int32_t run = 0; run < runs; run++) {
+			fprintf(stderr, "Run %d/%d\n", run + 1, runs);
+			for (int32_t prefetched = 0; prefetched < 2; prefetched++) {
+				prefetch_evict(&set);
+				if (prefetched) issue_ms.add(prefetch_run(&set).ms);
+				cached[prefetched].add((float)prefetch_resident(&set) / (1024.0f * 1024.0f));
+
+				float times[bench_step_max] = {};
+				char  error[128];
+				bench_run_child(args, 2, env, 1, times, error, sizeof(error));
+				if (error[0] == '\0') {
+					for (int32_t step = 0; step < bench_step_max; step++)
+						samples[prefetched][step].add(times[step]);
+				} else if (error_text == nullptr) {
+					error_text = new_string("%s", error);
+				}
+			}
+		}
+		// Nothing else is going to want these pages back in a hurry
+		prefetch_run(&set);
+
+		printf("%d files, %.1f MB\n", set.count, set.bytes / (1024.0 * 1024.0));
+		if (error_text) printf("Some runs failed: %s\n", error_text);
+
+		display_table_t table = {};
+		table.name_func    = "benchPrefetch";
+		table.column_count = 3;
+		table.cols[0].add({ "min / median / p95" });
+		table.cols[1].add({ "Cold" });
+		table.cols[2].add({ "Prefetched" });
+		const int32_t steps[2] = { bench_step_instance, bench_step_process };
+		for (int32_t s = 0; s < 2; s++) {
+			table.cols[0].add({ new_string("%s (ms)", bench_step_names[steps[s]]) });
+			for (int32_t prefetched = 0; prefetched < 2; prefetched++) {
+				const array_t<float> *step_samples = &samples[prefetched][steps[s]];
+				stats_t               stats        = stats_summary(step_samples->data, (int32_t)step_samples->count);
+				table.cols[1 + prefetched].add({ stats.count == 0
+					? "-"
+					: new_string("%.1f / %.1f / %.1f", stats.min, stats.median, stats.p95) });
+			}
+		}
+		// Pages mapped by a running process can't be evicted, so "cold"
+		// is only as cold as this says.
+		table.cols[0].add({ "Cached at launch (MB)" });
+		for (int32_t prefetched = 0; prefetched < 2; prefetched++) {
+			stats_t stats = stats_summary(cached[prefetched].data, (int32_t)cached[prefetched].count);
+			table.cols[1 + prefetched].add({ new_string("%.1f / %.1f / %.1f", stats.min, stats.median, stats.p95) });
+		}
+		stats_t issue = stats_summary(issue_ms.data, (int32_t)issue_ms.count);
+		table.cols[0].add({ "Issuing the prefetch (ms)" });
+		table.cols[1].add({ "-" });
+		table.cols[2].add({ new_string("%.1f / %.1f / %.1f", issue.min, issue.median, issue.p95) });
+		cli_print_table(&table);
+
+		stats_t cold = stats_summary(samples[0][bench_step_instance].data, (int32_t)samples[0][bench_step_instance].count);
+		stats_t warm = stats_summary(samples[1][bench_step_instance].data, (int32_t)samples[1][bench_step_instance].count);
+		if (cold.count > 0 && warm.count > 0)
+			printf("Prefetching made the first xrCreateInstance %.1f ms faster (median).\n", cold.median - warm.median);
+
+		for (int32_t c = 0; c < table.column_count; c++) table.cols[c].free();
+		for (int32_t prefetched = 0; prefetched < 2; prefetched++) {
+			for (int32_t step = 0; step < bench_step_max; step++) samples[prefetched][step].free();
+			cached[prefetched].free();
+		}
+		issue_ms.free();
+		prefetch_free(&set);
+	}
+
+	free(preflight);
+	free(runtime_list);
+	openxr_info_release(); // Frees the new_string text
+#endif
+}
+
+///////////////////////////////////////////
+
+// Runs one -benchChild and reads its report. out_times is indexed by
+// bench_step_, and out_error is left empty if the run went fine.
+static void bench_run_child(const char **args, int32_t arg_count, const char **env, int32_t env_count, float *out_times, char *out_error, size_t error_size) {
+	process_result_t result;
+	process_run_self(args, arg_count, env, env_count, 60000, &result);
+
+	const char *line = result.output ? strstr(result.output, "xrb\t") : nullptr;
+	char        error[128] = "";
+	if (result.timed_out) {
+		snprintf(error, sizeof(error), "Timed out");
+	} else if (line == nullptr || sscanf(line, "xrb\t%f\t%f\t%f\t%127[^\n]", &out_times[bench_step_instance], &out_times[bench_step_system], &out_times[bench_step_session], error) < 3) {
+		if (result.launched) snprintf(error, sizeof(error), "Exited with %d before reporting", result.exit_code);
+		else                 snprintf(error, sizeof(error), "Couldn't launch");
+	}
+	out_times[bench_step_process] = result.ms;
+	snprintf(out_error, error_size, "%s", error);
+	process_result_free(&result);
+}
+
+///////////////////////////////////////////
+
+static void bench_unset_env(const char *name) {
+#if defined(_WIN32)
+	_putenv_s(name, "");
+#else
+	unsetenv(name);
+#endif
+}
+
+///////////////////////////////////////////
+
+static const char *bench_graphics_arg(xr_graphics_preference_t preference) {
+	switch (preference) {
+	case xr_gfx_headless: return "-xrGraphics=headless";
+	case xr_gfx_d3d11:    return "-xrGraphics=d3d11";
+	case xr_gfx_opengl:   return "-xrGraphics=opengl";
+	case xr_gfx_d3d12:    return "-xrGraphics=d3d12";
+	default:              return "-xrGraphics=auto";
+	}
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "openxr_info.h"
+#include "app_stats.h"
+
+#include <stdint.h>
+
+// Benchmarks that need a fresh process per sample. Each sample is a copy
+// of this executable started with a hidden flag, pointed at one runtime
+// through XR_RUNTIME_JSON, that reports its timings back on stdout.
+
+/*** Signatures **************************/
+
+// -benchRuntimes: runs every present runtime `runs` times as cold and as
+// warm starts, and prints min/median/p95 time to instance, system and
+// (with -session) session.
+void          bench_runtimes      (int32_t runs, xr_settings_t settings);
+// -benchLayers: lists the API layer manifests, then times xrCreateInstance
+// on the active runtime `runs` times with no layers, with all of them, and
+// with each implicit layer by itself, and prints what each one adds.
+void          bench_layers        (int32_t runs, xr_settings_t settings);
+// -benchPrefetch: for every present runtime, drops its libraries from the
+// page cache and times xrCreateInstance in a fresh process, `runs` times
+// as-is and `runs` times right after xrprefetch.h has read them in.
+void          bench_prefetch      (int32_t runs, xr_settings_t settings);
+// -benchChild: the child side of all of the above.
+void          bench_runtimes_child(xr_settings_t settings);
@@ -1,12 +1,22 @@
 #include "app_cli.h"
 #include "array.h"
 #include "openxr_info.h"
+#include "app_compare.h"
+#include "app_bench.h"
+#include "openxr_footprint.h"
+#include "openxr_session.h"
+#include "openxr_frames.h"
+#include "openxr_swapchain.h"
+#include "openxr_spaces.h"
+#include "openxr_threads.h"
+#include "openxr_tracking.h"
 
 #include <stdbool.h>
 #include <stdio.h>
 #include <ctype.h>
 #include <stdlib.h>
 #include <string.h>
+#include <thread>
 
 // File-scope minimum GPU log level for CLI (used by non-capturing log callback)
 // skg_log_ enum order: info < warning < critical
@@ -32,7 +42,6 @@ struct command_t {
 
 /*** Signatures **************************/
 
-void cli_print_table(const display_table_t *table);
 void cli_show_help();
 int32_t strcmp_nocase(char const *a, char const *b);
 
@@ -82,6 +91,48 @@ static bool backend_compiled(xr_graphics_preference_t pref) {
 	}
 }
 
+// Numeric flags take "-name=N", or "-name" optionally followed by N as the
+// next arg, and fall back to default_value when N is left off. Returns
+// false if args[*i] isn't this flag.
+static bool cli_flag_number(const char *name, float default_value, const char **args, size_t arg_count, size_t *i, float *out_value) {
+	const char *raw  = args[*i];
+	const char *curr = raw;
+	while (*curr == '-' || *curr == '/') curr++;
+
+	size_t name_len = strlen(name);
+	if (curr != raw && strncmp(curr, name, name_len) == 0 && curr[name_len] == '=') {
+		*out_value = (float)atof(curr + name_len + 1);
+		return true;
+	}
+	if (strcmp_nocase(name, curr) != 0) return false;
+
+	*out_value = default_value;
+	if (*i + 1 < arg_count && args[*i+1] && isdigit((unsigned char)args[*i+1][0]))
+		*out_value = (float)atof(args[++*i]);
+	return true;
+}
+static bool cli_flag_number(const char *name, int32_t default_value, const char **args, size_t arg_count, size_t *i, int32_t *out_value) {
+	float value = 0;
+	if (!cli_flag_number(name, (float)default_value, args, arg_count, i, &value)) return false;
+	*out_value = (int32_t)value;
+	return true;
+}
+
+// The measurement modes all run the same way: say what's about to
+// happen, let run fill xr_tables, print them, and shut everything down.
+// label is a printf format for amount.
+template <typename F>
+static void cli_run_measurement(const char *label, float amount, F run) {
+	printf(label, amount);
+	run();
+	for (size_t c = 0; c < xr_tables.count; c++) {
+		cli_print_table(&xr_tables[c]);
+		if (xr_tables[c].error) printf("| %s |\n", xr_tables[c].error);
+	}
+	openxr_info_release();
+	skg_shutdown();
+}
+
 void app_cli(int32_t arg_count, const char **args) {
 	xr_settings_t settings = {};
 	settings.allow_session = false;
@@ -94,16 +145,86 @@ void app_cli(int32_t arg_count, const char **args) {
 	const char* loader_level_cli = NULL; // if provided, sets XR_LOADER_DEBUG
 	const char* loader_log_file  = NULL; // if provided, sets XR_LOADER_LOG_FILE
 
+	// Hidden: dump every table in a machine readable form, this is how the
+	// GUI's runtime comparison reads results back from its child processes.
+	bool dump_tables = false;
+
+	// Runtime startup benchmark, and its hidden child side
+	int32_t bench_runs  = 0;
+	int32_t layer_runs  = 0;
+	int32_t prefetch_runs = 0;
+	bool    bench_child = false;
+	// Seconds to hold the runtime open for the idle CPU probe
+	float   idle_seconds = 0;
+	// Seconds to run the session's frame loop for
+	float   session_seconds = 0;
+	// Seconds of frame pacing to record, and where the raw samples go
+	float   pacing_seconds = 0;
+	const char *csv_file   = nullptr;
+	// Frames per layer count for the frame call CPU cost
+	int32_t cpu_frames = 0;
+	// Frames per combination of settings for the frame experiments
+	int32_t experiment_frames = 0;
+	// Milliseconds per case for the space locate benchmark
+	float   locate_ms = 0;
+	// Most threads to call OpenXR from at once
+	int32_t max_threads = 0;
+	// Seconds to sample tracking for
+	float   tracking_seconds = 0;
+	// Seconds to compare predicted poses with where they turned out to be
+	float   prediction_seconds = 0;
+	// Frames to cycle each swapchain format for
+	int32_t swapchain_frames = 0;
+	// Frames to measure at each composition layer count
+	int32_t layer_frames = 0;
+
+	int32_t default_threads = (int32_t)std::thread::hardware_concurrency();
+	if (default_threads < 2) default_threads = 2;
+
 	// Pre-scan args for flags that affect initialization behavior
 	for (size_t i = 1; i < (size_t)arg_count; i++) {
 		const char *raw = args[i];
 		if (!raw) continue;
+		if (cli_flag_number("idleCpu",            10.0f,           args, arg_count, &i, &idle_seconds      ) ||
+			cli_flag_number("runSession",         5.0f,            args, arg_count, &i, &session_seconds   ) ||
+			cli_flag_number("framePacing",        10.0f,           args, arg_count, &i, &pacing_seconds    ) ||
+			cli_flag_number("frameCpu",           500,             args, arg_count, &i, &cpu_frames        ) ||
+			cli_flag_number("frameExperiments",   300,             args, arg_count, &i, &experiment_frames ) ||
+			cli_flag_number("benchLocate",        50.0f,           args, arg_count, &i, &locate_ms         ) ||
+			cli_flag_number("benchThreads",       default_threads, args, arg_count, &i, &max_threads       ) ||
+			cli_flag_number("trackingRate",       10.0f,           args, arg_count, &i, &tracking_seconds  ) ||
+			cli_flag_number("trackingPrediction", 20.0f,           args, arg_count, &i, &prediction_seconds) ||
+			cli_flag_number("benchSwapchains",    120,             args, arg_count, &i, &swapchain_frames  ) ||
+			cli_flag_number("frameLayers",        120,             args, arg_count, &i, &layer_frames      ) ||
+			cli_flag_number("benchRuntimes",      5,               args, arg_count, &i, &bench_runs        ) ||
+			cli_flag_number("benchPrefetch",      5,               args, arg_count, &i, &prefetch_runs     ) ||
+			cli_flag_number("benchLayers",        5,               args, arg_count, &i, &layer_runs        ))
+			continue;
+
 		bool has_prefix = (raw[0] == '-' || raw[0] == '/');
 		const char *curr = raw;
 		while (*curr == '-' || *curr == '/') curr++;
 
 		if (strcmp_nocase("session", curr) == 0 || strcmp_nocase("enableSession", curr) == 0) {
 			settings.allow_session = true;
+		} else if (strcmp_nocase("dumpTables", curr) == 0) {
+			dump_tables = true;
+		} else if (strcmp_nocase("footprint", curr) == 0) {
+			settings.footprint = true;
+		} else if (has_prefix && (strncmp(curr, "csv=", 4) == 0)) {
+			csv_file = curr + 4;
+		} else if (strcmp_nocase("csv", curr) == 0) {
+			if (i + 1 < (size_t)arg_count) {
+				csv_file = args[++i];
+				// Not '/', that's how absolute paths start outside Windows
+				if (csv_file && csv_file[0] == '-') csv_file = NULL;
+			}
+		} else if (strcmp_nocase("benchChild", curr) == 0) {
+			bench_child = true;
+		} else if (strcmp_nocase("prefetch", curr) == 0) {
+			settings.prefetch = xr_prefetch_active;
+		} else if (has_prefix && (strncmp(curr, "prefetch=", 9) == 0)) {
+			settings.prefetch = strcmp_nocase(curr + 9, "all") == 0 ? xr_prefetch_all : xr_prefetch_active;
 		} else if (has_prefix && (strncmp(curr, "gpuLogLevel=", 12) == 0)) {
 			const char* level = curr + 12;
 			if      (strcmp_nocase(level, "info" ) == 0) g_cli_gpu_min_log_level = 0; // print all
@@ -168,6 +289,21 @@ void app_cli(int32_t arg_count, const char **args) {
 		set_env_var("XR_LOADER_LOG_FILE", loader_log_file);
 	}
 
+	// The benchmarks only start other processes, so they don't need a GPU
+	// or a probe of the active runtime.
+	if (bench_runs > 0) {
+		bench_runtimes(bench_runs, settings);
+		return;
+	}
+	if (layer_runs > 0) {
+		bench_layers(layer_runs, settings);
+		return;
+	}
+	if (prefetch_runs > 0) {
+		bench_prefetch(prefetch_runs, settings);
+		return;
+	}
+
 	// GPU log filtering for CLI
 	skg_callback_log([](skg_log_ level, const char *text) {
 		if ((int)level >= g_cli_gpu_min_log_level) {
@@ -177,6 +313,39 @@ void app_cli(int32_t arg_count, const char **args) {
 
 	if (!skg_init("OpenXR Explorer", nullptr))
 		printf("Failed to init skg!\n");
+	if (bench_child) {
+		bench_runtimes_child(settings);
+		skg_shutdown();
+		return;
+	}
+	if (idle_seconds > 0) return cli_run_measurement("Holding the runtime open for %.1f seconds...\n", idle_seconds, [&]() {
+		footprint_idle(settings, idle_seconds, 250);
+	});
+	if (session_seconds > 0) return cli_run_measurement("Running the session for %.1f seconds...\n", session_seconds, [&]() {
+		settings = session_settings(settings);
+		const char *error = openxr_runtime_open(settings);
+		if (error) {
+			printf("Couldn't open the runtime: %s\n", error);
+			return;
+		}
+		session_start(settings, {});
+		session_wait (session_seconds);
+		session_stop ();
+		session_tables();
+
+		session_info_t info = session_info();
+		printf("%llu frames, READY after %.1fms, FOCUSED after %.1fms\n",
+			(unsigned long long)info.frame_count, info.ms_to_ready, info.ms_to_focused);
+	});
+	if (pacing_seconds     > 0) return cli_run_measurement("Recording %.1f seconds of frames...\n",                pacing_seconds,     [&]() { frames_pacing      (settings, pacing_seconds, csv_file ? csv_file : "frame_pacing.csv"); });
+	if (cpu_frames         > 0) return cli_run_measurement("Measuring %g frames per layer count...\n",             cpu_frames,         [&]() { frames_cpu         (settings, cpu_frames); });
+	if (experiment_frames  > 0) return cli_run_measurement("Measuring %g frames per combination of settings...\n", experiment_frames,  [&]() { frames_experiments (settings, experiment_frames); });
+	if (locate_ms          > 0) return cli_run_measurement("Locating spaces for %g ms per case...\n",              locate_ms,          [&]() { spaces_bench_locate(settings, locate_ms); });
+	if (max_threads        > 0) return cli_run_measurement("Calling OpenXR from up to %g threads at once...\n",    max_threads,        [&]() { threads_bench      (settings, max_threads, 200); });
+	if (tracking_seconds   > 0) return cli_run_measurement("Sampling tracking for %g seconds...\n",                tracking_seconds,   [&]() { tracking_rate      (settings, tracking_seconds); });
+	if (prediction_seconds > 0) return cli_run_measurement("Checking pose predictions for %g seconds...\n",        prediction_seconds, [&]() { tracking_prediction(settings, prediction_seconds, csv_file ? csv_file : "tracking_prediction.csv"); });
+	if (swapchain_frames   > 0) return cli_run_measurement("Cycling each swapchain format for %g frames...\n",     swapchain_frames,   [&]() { swapchain_bench    (settings, swapchain_frames); });
+	if (layer_frames       > 0) return cli_run_measurement("Measuring %g frames per layer type and count...\n",    layer_frames,       [&]() { frames_layers      (settings, layer_frames); });
 	openxr_info_reload(settings);
 	if (xr_instance_err) printf("XrInstance error: [%s]\n", xr_instance_err);
 	if (xr_system_err)   printf("XrSystemId error: [%s]\n", xr_system_err);
@@ -192,13 +361,24 @@ void app_cli(int32_t arg_count, const char **args) {
 
 	// Find all the commands we want to execute
 	bool show = false;
-	for (size_t i = 1; i < arg_count; i++) {
+	if (dump_tables) {
+		compare_dump_tables(stdout);
+		show = true;
+	}
+	for (size_t i = 1; i < arg_count && !dump_tables; i++) {
 		const char *curr = args[i];
 		while (*curr == '-') curr++;
 
 		if (strcmp_nocase("help", curr) == 0 || strcmp_nocase("h", curr) == 0 || strcmp_nocase("/h", curr) == 0) {
 			cli_show_help();
 			show = true;
+		} else if (strcmp_nocase("footprint", curr) == 0) {
+			for (size_t c = 0; c < xr_tables.count; c++) {
+				if (xr_tables[c].tag != display_tag_footprint) continue;
+				cli_print_table(&xr_tables[c]);
+				if (xr_tables[c].error) printf("| %s |\n", xr_tables[c].error);
+			}
+			show = true;
 		} else {
 			for (size_t c = 0; c < xr_tables.count; c++) {
 				if ((xr_tables[c].name_func && strcmp_nocase(xr_tables[c].name_func, curr) == 0) ||
@@ -241,6 +421,115 @@ Options:
 		Set OpenXR Loader log level (XR_LOADER_DEBUG): error (default), warn, info, verbose, trace
 	-loaderLogFile <path> | -loaderLogFile=<path>
 		Redirect OpenXR Loader logs to a file (XR_LOADER_LOG_FILE)
+	-footprint
+		Show what loading the runtime cost this process: memory, the
+		threads it started, and the libraries it loaded, for each of
+		xrCreateInstance, xrGetSystem and (with -session) xrCreateSession.
+		Linux only.
+	-idleCpu [seconds] | -idleCpu=<seconds>
+		Hold the runtime open without rendering (and the session too,
+		with -session) and show the CPU use and wakeups of each thread
+		the runtime started. Default: 10 seconds. Linux only.
+	-runSession [seconds] | -runSession=<seconds>
+		Take a session through READY to FOCUSED and run the frame loop
+		on its own thread for a while, then end it, and show each state
+		change with when it happened. Default: 5 seconds. Headless
+		(XR_MND_headless) on Linux, there's no Linux graphics binding.
+	-framePacing [seconds] | -framePacing=<seconds>
+		Run a session and record every frame once it's FOCUSED, then
+		show the xrWaitFrame wake-up histogram, p50/p99/p99.9 jitter of
+		the wake-ups and predicted display times, missed and duplicated
+		predicted display times, and drift. With
+		XR_KHR_convert_timespec_time, also how long before its display
+		time each frame was released. Default: 10 seconds. Raw frames
+		go to frame_pacing.csv, or -csv. Headless sessions have no
+		display to pace against, use a real compositor.
+	-frameCpu [frames] | -frameCpu=<frames>
+		Measure the thread CPU time and wall time spent in xrWaitFrame,
+		xrBeginFrame and xrEndFrame, with no layers, one quad layer and
+		maxLayerCount quad layers. Default: 500 frames each. Needs a
+		graphics session for the layers. Windows reads the CPU time with
+		GetThreadTimes, which only moves on scheduler ticks, so trust
+		the means over the percentiles there.
+	-frameExperiments [frames] | -frameExperiments=<frames>
+		Run frames for every combination of the refresh rates
+		(XR_FB_display_refresh_rate), reprojection modes
+		(XR_MSFT_composition_layer_reprojection) and performance levels
+		(XR_EXT_performance_settings) the runtime offers, and compare
+		their pacing and frame call CPU cost, and how long each setting
+		takes to apply. Frames run with a projection layer, after a
+		warm-up. Default: 300 frames each. Reprojection modes ride on
+		the projection layer, so headless sessions leave them out.
+	-benchLocate [ms] | -benchLocate=<ms>
+		Once the session is FOCUSED, time xrLocateSpace for every
+		reference space and the controller grip and aim spaces,
+		xrLocateViews for every view configuration, and batched
+		xrLocateSpaces (OpenXR 1.1 or XR_KHR_locate_spaces) from 1 to 64
+		spaces, each 100 ms in the past, now, and at the predicted
+		display time. Default: 50 ms per case. Past and now need
+		XR_KHR_convert_timespec_time, or the Win32 equivalent.
+	-benchThreads [threads] | -benchThreads=<threads>
+		Call xrLocateSpace, xrStringToPath/xrPathToString,
+		xrGetActionStatePose and the clock conversion from 1, 2, 4...
+		threads at once against one session, 200 ms each, and show how
+		throughput scales and the p50/p99 latency of single calls. Each
+		thread has its own space and path. Default: one thread per CPU
+		core.
+	-trackingRate [seconds] | -trackingRate=<seconds>
+		Read the head, controller, hand joint (XR_EXT_hand_tracking) and
+		eye gaze (XR_EXT_eye_gaze_interaction) poses 2000 times a
+		second, and show how often each one actually updates, how stale
+		it is when read, and how often it loses tracking. Runtimes that
+		extrapolate to the requested time change on every read, and are
+		flagged. Default: 10 seconds.
+	-trackingPrediction [seconds] | -trackingPrediction=<seconds>
+		Locate every tracked source 0 to 50 ms into the future, then
+		again once that time has passed, and show the position and
+		angle error for each horizon, hands by their palm. Default: 20
+		seconds. Raw errors go to tracking_prediction.csv, or -csv, and
+		are kept in a fixed ring, so long runs keep only the latest.
+	-benchSwapchains [frames] | -benchSwapchains=<frames>
+		Create a swapchain in every format the session lists, at the
+		recommended view size, and show how long create, enumerate and
+		destroy take, the image count, and acquire/wait/release latency
+		over that many frames. Color formats are submitted as a quad,
+		depth formats only cycled. Needs a graphics session, so Windows
+		only: the CLI runs sessions headless on Linux. Default: 120.
+	-frameLayers [frames] | -frameLayers=<frames>
+		Submit 1, 2, 4... up to maxLayerCount projection, quad, cylinder
+		and cube layers, and show xrEndFrame CPU time, pacing, and the
+		cost of each added layer at every count, marking the first
+		count where a layer costs over twice what the first one did.
+		Cylinder and cube need XR_KHR_composition_layer_cylinder and
+		XR_KHR_composition_layer_cube. Default: 120 frames per count. Layers need a
+		graphics session, so off Windows, where the CLI runs headless,
+		only the no-layer baseline is measured.
+	-csv <path> | -csv=<path>
+		Where the measurements above write their raw samples.
+	-benchRuntimes [runs] | -benchRuntimes=<runs>
+		Start every installed runtime in fresh processes, cold and warm,
+		and show min/median/p95 time to xrCreateInstance and xrGetSystem
+		(and xrCreateSession with -session). Cold runs follow a
+		different runtime, warm runs follow the same one. Runtimes whose
+		library fails to load are skipped with the reason. Default: 5
+		runs.
+	-benchLayers [runs] | -benchLayers=<runs>
+		List the API layer manifests, then time xrCreateInstance on the
+		active runtime with no layers, with every layer, and with each
+		implicit layer alone, and show what each one adds. Layers are
+		turned off through their disable_environment, and explicit ones
+		on through XR_ENABLE_API_LAYERS. Default: 5 runs.
+	-prefetch | -prefetch=all
+		Read the active runtime's library, and everything it links
+		against (its DT_NEEDED, found the way ld.so would), into the
+		page cache with readahead before loading it. With =all, the
+		libraries of every installed runtime too. Also works for the GUI.
+	-benchPrefetch [runs] | -benchPrefetch=<runs>
+		Start every installed runtime with its libraries dropped from the
+		page cache, with and without -prefetch, and show how much sooner
+		xrCreateInstance finishes, and how much was still cached at
+		launch. Pages another process has mapped, like a running
+		compositor's, can't be dropped. Default: 5 runs. Linux only.
 
 Notes:
 	- Backend availability depends on this binary's build. )_");
@@ -1,5 +1,8 @@
 #pragma once
 
+#include "openxr_info.h"
+
 #include <stdint.h>
 
-void app_cli(int32_t arg_count, const char **args);
\ No newline at end of file
+void app_cli(int32_t arg_count, const char **args);
+void cli_print_table(const display_table_t *table);
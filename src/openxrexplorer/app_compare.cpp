@@ -0,0 +1,561 @@
+#include "app_compare.h"
+#include "app_process.h"
+#include "app_search.h"
+#include "imgui/imgui.h"
+
+#include <atomic>
+#include <thread>
+#include <string.h>
+#include <sys/stat.h>
+
+/*** Types *******************************/
+
+enum compare_state_ {
+	compare_state_none,
+	compare_state_running,
+	compare_state_done,
+	compare_state_failed,
+};
+
+// One probed runtime. Everything but state belongs to the probe thread
+// until state leaves compare_state_running.
+struct compare_snapshot_t {
+	std::atomic<int32_t>     state;
+	std::thread              thread;
+	char                     file[1024];
+	char                     name[64];
+	time_t                   manifest_mtime;
+	bool                     session;
+
+	const char              *error;
+	const char              *runtime_name;
+	const char              *instance_err;
+	const char              *system_err;
+	const char              *session_err;
+	float                    probe_ms;
+
+	process_result_t         process;   // Parsed strings point into process.output
+	array_t<display_table_t> tables;
+	search_index_t           search;
+};
+
+struct compare_cell_t {
+	const display_table_t *table;
+	int32_t                row;   // -1 for a table that only has an error
+	const char            *value;
+};
+
+struct compare_row_t {
+	const char *key;
+	size_t      cells;   // Index of the first of compare_columns.count cells
+	bool        differs;
+};
+
+struct compare_table_t {
+	const char            *name;
+	display_tag_           tag;
+	array_t<compare_row_t> rows;
+	int32_t                differ_count;
+};
+
+/*** Global Variables ********************/
+
+array_t<compare_snapshot_t *> compare_cache   = {};
+array_t<compare_snapshot_t *> compare_columns = {};
+array_t<compare_table_t>      compare_tables  = {};
+array_t<compare_cell_t>       compare_cells   = {};
+array_t<char *>               compare_strings = {};
+bool                          compare_dirty   = true;
+bool                          compare_opened  = false;
+bool                          compare_only_diffs = false;
+char                          compare_query[128] = "";
+
+const int32_t compare_timeout_ms = 30000;
+
+/*** Signatures **************************/
+
+static void                compare_write_field(FILE *to, const char *text);
+static int32_t             compare_split      (char *line, char **fields, int32_t max_fields);
+static void                compare_parse      (compare_snapshot_t *snap);
+static void                compare_probe      (const runtime_t *runtime, bool session, bool force);
+static void                compare_update     (const runtime_t *runtime_list, int32_t runtime_count);
+static void                compare_merge      ();
+static compare_snapshot_t *compare_find       (const char *file);
+static void                compare_snapshot_free(compare_snapshot_t *snap);
+
+/*** Code ********************************/
+
+void compare_dump_tables(FILE *to) {
+	fprintf(to, "xrt:V\t1\n");
+	fprintf(to, "xrt:N");
+	compare_write_field(to, xr_runtime_name);
+	fprintf(to, "\nxrt:E");
+	compare_write_field(to, xr_instance_err);
+	compare_write_field(to, xr_system_err);
+	compare_write_field(to, xr_session_err);
+	fprintf(to, "\n");
+
+	for (size_t t = 0; t < xr_tables.count; t++) {
+		const display_table_t *table = &xr_tables[t];
+		fprintf(to, "xrt:T\t%d\t%d\t%d\t%d", (int32_t)table->tag, table->column_count, table->header_row ? 1 : 0, table->show_type ? 1 : 0);
+		compare_write_field(to, table->name_func);
+		compare_write_field(to, table->name_type);
+		compare_write_field(to, table->spec);
+		compare_write_field(to, table->error);
+		fprintf(to, "\n");
+
+		for (size_t r = 0; r < table->cols[0].count; r++) {
+			fprintf(to, "xrt:R");
+			for (int32_t c = 0; c < table->column_count; c++) {
+				compare_write_field(to, table->cols[c][r].text);
+				compare_write_field(to, table->cols[c][r].spec);
+			}
+			fprintf(to, "\n");
+		}
+	}
+	fflush(to);
+}
+
+///////////////////////////////////////////
+
+static void compare_write_field(FILE *to, const char *text) {
+	fputc('\t', to);
+	if (text == nullptr) {
+		fputs("\\0", to);
+		return;
+	}
+	for (; *text; text++) {
+		switch (*text) {
+		case '\\': fputs("\\\\", to); break;
+		case '\t': fputs("\\t",  to); break;
+		case '\n': fputs("\\n",  to); break;
+		case '\r': fputs("\\r",  to); break;
+		default:   fputc(*text,  to); break;
+		}
+	}
+}
+
+///////////////////////////////////////////
+
+// Splits a line on tabs and unescapes each field in place. A field that's
+// exactly "\0" was a null pointer on the writing side.
+static int32_t compare_split(char *line, char **fields, int32_t max_fields) {
+	int32_t count = 0;
+	char   *start = line;
+	while (count < max_fields) {
+		char *end = strchr(start, '\t');
+		if (end) *end = '\0';
+
+		if (strcmp(start, "\\0") == 0) {
+			fields[count++] = nullptr;
+		} else {
+			char *dst = start;
+			for (char *src = start; *src; src++) {
+				if (*src == '\\' && src[1]) {
+					src++;
+					*dst++ = *src == 't' ? '\t' : *src == 'n' ? '\n' : *src == 'r' ? '\r' : *src;
+				} else {
+					*dst++ = *src;
+				}
+			}
+			*dst = '\0';
+			fields[count++] = start;
+		}
+
+		if (!end) break;
+		start = end + 1;
+	}
+	return count;
+}
+
+///////////////////////////////////////////
+
+static void compare_parse(compare_snapshot_t *snap) {
+	char *line = snap->process.output;
+	while (line && *line) {
+		char *next = strchr(line, '\n');
+		if (next) *next++ = '\0';
+		size_t len = strlen(line);
+		if (len > 0 && line[len-1] == '\r') line[len-1] = '\0';
+
+		char   *fields[16];
+		int32_t count = strncmp(line, "xrt:", 4) == 0
+			? compare_split(line, fields, 16)
+			: 0;
+
+		if (count >= 2 && strcmp(fields[0], "xrt:N") == 0) {
+			snap->runtime_name = fields[1];
+		} else if (count >= 4 && strcmp(fields[0], "xrt:E") == 0) {
+			snap->instance_err = fields[1];
+			snap->system_err   = fields[2];
+			snap->session_err  = fields[3];
+		} else if (count >= 9 && strcmp(fields[0], "xrt:T") == 0) {
+			display_table_t table = {};
+			table.tag          = (display_tag_)atoi(fields[1]);
+			table.column_count = atoi(fields[2]);
+			table.header_row   = atoi(fields[3]) != 0;
+			table.show_type    = atoi(fields[4]) != 0;
+			table.name_func    = fields[5];
+			table.name_type    = fields[6];
+			table.spec         = fields[7];
+			table.error        = fields[8];
+			if (table.column_count < 1) table.column_count = 1;
+			if (table.column_count > 3) table.column_count = 3;
+			snap->tables.add(table);
+		} else if (count >= 1 && strcmp(fields[0], "xrt:R") == 0 && snap->tables.count > 0) {
+			display_table_t *table = &snap->tables.last();
+			if (count >= 1 + table->column_count * 2) {
+				for (int32_t c = 0; c < table->column_count; c++)
+					table->cols[c].add({ fields[1 + c*2], fields[2 + c*2] });
+			}
+		}
+		line = next;
+	}
+}
+
+///////////////////////////////////////////
+
+static compare_snapshot_t *compare_find(const char *file) {
+	for (size_t i = 0; i < compare_cache.count; i++) {
+		if (strcmp(compare_cache[i]->file, file) == 0)
+			return compare_cache[i];
+	}
+	return nullptr;
+}
+
+///////////////////////////////////////////
+
+static void compare_snapshot_free(compare_snapshot_t *snap) {
+	if (snap->thread.joinable()) snap->thread.join();
+	for (size_t t = 0; t < snap->tables.count; t++) {
+		for (int32_t c = 0; c < 3; c++)
+			snap->tables[t].cols[c].free();
+	}
+	snap->tables.free();
+	search_free        (&snap->search);
+	process_result_free(&snap->process);
+	snap->error        = nullptr;
+	snap->runtime_name = nullptr;
+	snap->instance_err = nullptr;
+	snap->system_err   = nullptr;
+	snap->session_err  = nullptr;
+}
+
+///////////////////////////////////////////
+
+static void compare_probe(const runtime_t *runtime, bool session, bool force) {
+	struct stat file_info = {};
+	stat(runtime->file, &file_info);
+
+	compare_snapshot_t *snap = compare_find(runtime->file);
+	if (snap == nullptr) {
+		snap = new compare_snapshot_t();
+		strncpy(snap->file, runtime->file, sizeof(snap->file) - 1);
+		compare_cache.add(snap);
+	}
+	strncpy(snap->name, runtime->name, sizeof(snap->name) - 1);
+
+	// Cached results stay valid until the manifest changes
+	int32_t state = snap->state.load();
+	if (state == compare_state_running) return;
+	if (!force && state != compare_state_none && snap->manifest_mtime == file_info.st_mtime && snap->session == session) return;
+
+	compare_snapshot_free(snap);
+	snap->manifest_mtime = file_info.st_mtime;
+	snap->session        = session;
+	snap->state.store(compare_state_running);
+	compare_dirty = true;
+
+	snap->thread = std::thread([](compare_snapshot_t *snap) {
+		char env_runtime[1100];
+		snprintf(env_runtime, sizeof(env_runtime), "XR_RUNTIME_JSON=%s", snap->file);
+		const char *env [] = { env_runtime };
+		const char *args[] = { "-dumpTables", "-session" };
+
+		if (!process_run_self(args, snap->session ? 2 : 1, env, 1, compare_timeout_ms, &snap->process)) {
+			snap->error = snap->process.launched ? "Timed out" : "Failed to launch";
+			snap->state.store(compare_state_failed);
+			return;
+		}
+		snap->probe_ms = snap->process.ms;
+
+		compare_parse(snap);
+		if (snap->tables.count == 0) {
+			snap->error = "No data from child process";
+			snap->state.store(compare_state_failed);
+			return;
+		}
+		search_build(&snap->search, snap->tables.data, snap->tables.count);
+		snap->state.store(compare_state_done);
+	}, snap);
+}
+
+///////////////////////////////////////////
+
+static void compare_update(const runtime_t *runtime_list, int32_t runtime_count) {
+	// Pick up finished probes
+	for (size_t i = 0; i < compare_cache.count; i++) {
+		compare_snapshot_t *snap = compare_cache[i];
+		if (snap->state.load() != compare_state_running && snap->thread.joinable()) {
+			snap->thread.join();
+			search_query(&snap->search, compare_query);
+			compare_dirty = true;
+		}
+	}
+
+	// Columns are the present runtimes that finished probing, in list order
+	array_t<compare_snapshot_t *> columns = {};
+	for (int32_t i = 0; i < runtime_count; i++) {
+		if (!runtime_list[i].present) continue;
+		compare_snapshot_t *snap = compare_find(runtime_list[i].file);
+		if (snap && snap->state.load() == compare_state_done)
+			columns.add(snap);
+	}
+	if (columns.count != compare_columns.count || (columns.count > 0 && memcmp(columns.data, compare_columns.data, sizeof(compare_snapshot_t *) * columns.count) != 0))
+		compare_dirty = true;
+
+	compare_columns.free();
+	compare_columns = columns;
+	if (compare_dirty) {
+		compare_merge();
+		compare_dirty = false;
+	}
+}
+
+///////////////////////////////////////////
+
+static void compare_merge() {
+	for (size_t t = 0; t < compare_tables.count; t++) compare_tables[t].rows.free();
+	for (size_t s = 0; s < compare_strings.count; s++) free(compare_strings[s]);
+	compare_tables .free();
+	compare_cells  .free();
+	compare_strings.free();
+
+	size_t column_count = compare_columns.count;
+	for (size_t c = 0; c < column_count; c++) {
+		const compare_snapshot_t *snap = compare_columns[c];
+		for (size_t t = 0; t < snap->tables.count; t++) {
+			const display_table_t *table = &snap->tables[t];
+			const char            *name  = table->show_type ? table->name_type : table->name_func;
+			if (name == nullptr) name = table->name_type ? table->name_type : "";
+
+			int64_t table_id = -1;
+			for (size_t i = 0; i < compare_tables.count; i++) {
+				if (compare_tables[i].tag == table->tag && strcmp(compare_tables[i].name, name) == 0) {
+					table_id = i;
+					break;
+				}
+			}
+			if (table_id < 0) {
+				compare_table_t new_table = {};
+				new_table.name = name;
+				new_table.tag  = table->tag;
+				table_id = compare_tables.add(new_table);
+			}
+			compare_table_t *merged = &compare_tables[table_id];
+
+			// A table that failed to load gets a single row with its error
+			size_t start = table->header_row ? 1 : 0;
+			size_t end   = table->error ? start + 1 : table->cols[0].count;
+			for (size_t r = start; r < end; r++) {
+				const char *key   = "(error)";
+				const char *value = table->error;
+				if (!table->error) {
+					key = table->cols[0][r].text ? table->cols[0][r].text : "";
+					if (table->column_count == 1) {
+						value = "present";
+					} else if (table->column_count == 2) {
+						value = table->cols[1][r].text;
+					} else {
+						size_t size   = strlen(table->cols[1][r].text ? table->cols[1][r].text : "") + strlen(table->cols[2][r].text ? table->cols[2][r].text : "") + 4;
+						char  *joined = (char *)malloc(size);
+						snprintf(joined, size, "%s | %s", table->cols[1][r].text ? table->cols[1][r].text : "", table->cols[2][r].text ? table->cols[2][r].text : "");
+						compare_strings.add(joined);
+						value = joined;
+					}
+				}
+
+				int64_t row_id = -1;
+				for (size_t i = 0; i < merged->rows.count; i++) {
+					if (strcmp(merged->rows[i].key, key) == 0) {
+						row_id = i;
+						break;
+					}
+				}
+				if (row_id < 0) {
+					compare_row_t row = {};
+					row.key   = key;
+					row.cells = compare_cells.count;
+					for (size_t i = 0; i < column_count; i++) compare_cells.add({ nullptr, -1, nullptr });
+					row_id = merged->rows.add(row);
+				}
+				compare_cell_t *cell = &compare_cells[merged->rows[row_id].cells + c];
+				cell->table = table;
+				cell->row   = table->error ? -1 : (int32_t)r;
+				cell->value = value;
+			}
+		}
+	}
+
+	// A row differs if any runtime is missing it, or has another value
+	for (size_t t = 0; t < compare_tables.count; t++) {
+		compare_table_t *table = &compare_tables[t];
+		for (size_t r = 0; r < table->rows.count; r++) {
+			compare_row_t        *row   = &table->rows[r];
+			const compare_cell_t *cells = &compare_cells[row->cells];
+			for (size_t c = 1; c < column_count && !row->differs; c++) {
+				const char *a = cells[0].value, *b = cells[c].value;
+				row->differs = (a == nullptr) != (b == nullptr) || (a && strcmp(a, b) != 0);
+			}
+			if (row->differs) table->differ_count += 1;
+		}
+	}
+}
+
+///////////////////////////////////////////
+
+void compare_search(const char *query) {
+	strncpy(compare_query, query, sizeof(compare_query) - 1);
+	for (size_t i = 0; i < compare_cache.count; i++) {
+		if (compare_cache[i]->state.load() == compare_state_done && !compare_cache[i]->thread.joinable())
+			search_query(&compare_cache[i]->search, compare_query);
+	}
+}
+
+///////////////////////////////////////////
+
+static bool compare_row_visible(const compare_row_t *row) {
+	if (compare_only_diffs && !row->differs) return false;
+	if (compare_query[0] == '\0') return true;
+
+	const compare_cell_t *cells = &compare_cells[row->cells];
+	for (size_t c = 0; c < compare_columns.count; c++) {
+		if (cells[c].table == nullptr) continue;
+		const search_index_t *search = &compare_columns[c]->search;
+		if (search_table_named(search, cells[c].table) ||
+			(cells[c].row >= 0 && search_row_hit(search, cells[c].table, cells[c].row)))
+			return true;
+	}
+	return false;
+}
+
+///////////////////////////////////////////
+
+void compare_window(bool *open, const runtime_t *runtime_list, int32_t runtime_count, xr_settings_t settings) {
+	if (!*open) return;
+
+	static bool session = false;
+	if (!compare_opened) {
+		compare_opened = true;
+		session        = settings.allow_session;
+	}
+	// Anything without a snapshot yet gets probed, both on first open and
+	// when "Reload list" turns up a runtime we haven't seen.
+	for (int32_t i = 0; i < runtime_count; i++) {
+		if (runtime_list[i].present && compare_find(runtime_list[i].file) == nullptr)
+			compare_probe(&runtime_list[i], session, false);
+	}
+	compare_update(runtime_list, runtime_count);
+
+	ImGui::SetNextWindowSize(ImVec2(900, 600), ImGuiCond_FirstUseEver);
+	if (!ImGui::Begin("Compare Runtimes", open)) {
+		ImGui::End();
+		return;
+	}
+
+	if (ImGui::Button("Probe all again")) {
+		for (int32_t i = 0; i < runtime_count; i++) {
+			if (runtime_list[i].present) compare_probe(&runtime_list[i], session, true);
+		}
+		// Re-probing frees the old snapshots, so merge again before drawing
+		compare_update(runtime_list, runtime_count);
+	}
+	ImGui::SameLine();
+	ImGui::Checkbox("Create XrSession", &session);
+	ImGui::SameLine();
+	ImGui::Checkbox("Only show differences", &compare_only_diffs);
+
+	// Probe status for every present runtime
+	for (int32_t i = 0; i < runtime_count; i++) {
+		if (!runtime_list[i].present) continue;
+		const compare_snapshot_t *snap = compare_find(runtime_list[i].file);
+		int32_t state = snap ? snap->state.load() : compare_state_none;
+
+		ImGui::Text("%-24s", runtime_list[i].name);
+		ImGui::SameLine();
+		switch (state) {
+		case compare_state_running: ImGui::TextDisabled("probing..."); break;
+		case compare_state_failed:  ImGui::TextColored(ImVec4(1, 0.4f, 0.4f, 1), "%s", snap->error); break;
+		case compare_state_done:
+			if (snap->instance_err) ImGui::TextColored(ImVec4(1, 0.4f, 0.4f, 1), "xrCreateInstance: %s", snap->instance_err);
+			else                    ImGui::TextDisabled("%s, %.0fms", snap->runtime_name ? snap->runtime_name : "", snap->probe_ms);
+			break;
+		default: ImGui::TextDisabled("not probed"); break;
+		}
+	}
+
+	ImGui::Spacing();
+	ImGui::Separator();
+	ImGui::Spacing();
+
+	size_t  column_count = compare_columns.count;
+	ImU32   differ_color = IM_COL32(140, 90, 20, 110);
+	for (size_t t = 0; t < compare_tables.count && column_count > 0; t++) {
+		const compare_table_t *table = &compare_tables[t];
+		if (compare_only_diffs && table->differ_count == 0) continue;
+
+		int32_t visible = 0;
+		for (size_t r = 0; r < table->rows.count; r++) visible += compare_row_visible(&table->rows[r]) ? 1 : 0;
+		if (visible == 0) continue;
+
+		ImGui::PushID((int32_t)t);
+		char header[256];
+		snprintf(header, sizeof(header), "%s (%d differ)###table", table->name, table->differ_count);
+		if (ImGui::CollapsingHeader(header, table->differ_count > 0 ? ImGuiTreeNodeFlags_DefaultOpen : 0) &&
+			ImGui::BeginTable("rows", (int32_t)column_count + 1, ImGuiTableFlags_BordersV | ImGuiTableFlags_RowBg | ImGuiTableFlags_Resizable)) {
+			ImGui::TableSetupColumn(table->name);
+			for (size_t c = 0; c < column_count; c++)
+				ImGui::TableSetupColumn(compare_columns[c]->name);
+			ImGui::TableHeadersRow();
+
+			for (size_t r = 0; r < table->rows.count; r++) {
+				const compare_row_t *row = &table->rows[r];
+				if (!compare_row_visible(row)) continue;
+
+				const compare_cell_t *cells = &compare_cells[row->cells];
+				ImGui::TableNextRow();
+				ImGui::TableNextColumn();
+				ImGui::TextUnformatted(row->key);
+				for (size_t c = 0; c < column_count; c++) {
+					ImGui::TableNextColumn();
+					if (row->differs)
+						ImGui::TableSetBgColor(ImGuiTableBgTarget_CellBg, differ_color);
+					if (cells[c].value) ImGui::TextUnformatted(cells[c].value);
+					else                ImGui::TextDisabled("-");
+				}
+			}
+			ImGui::EndTable();
+		}
+		ImGui::PopID();
+	}
+
+	ImGui::End();
+}
+
+///////////////////////////////////////////
+
+void compare_shutdown() {
+	process_abort_all();
+	for (size_t i = 0; i < compare_cache.count; i++) {
+		compare_snapshot_free(compare_cache[i]);
+		delete compare_cache[i];
+	}
+	compare_cache.free();
+	compare_columns.free();
+
+	for (size_t t = 0; t < compare_tables.count; t++) compare_tables[t].rows.free();
+	for (size_t s = 0; s < compare_strings.count; s++) free(compare_strings[s]);
+	compare_tables .free();
+	compare_cells  .free();
+	compare_strings.free();
+}
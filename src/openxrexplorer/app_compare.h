@@ -0,0 +1,16 @@
+#pragma once
+
+#include "openxr_info.h"
+#include "xrruntime.h"
+
+#include <stdio.h>
+
+/*** Signatures **************************/
+
+// Writes xr_tables in the line format compare_window reads back from each
+// child process. Used by the hidden -dumpTables CLI flag.
+void compare_dump_tables(FILE *to);
+
+void compare_window     (bool *open, const runtime_t *runtime_list, int32_t runtime_count, xr_settings_t settings);
+void compare_search     (const char *query);
+void compare_shutdown   ();
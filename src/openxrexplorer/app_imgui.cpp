@@ -1,4 +1,5 @@
 #include "app_imgui.h"
+#include "app_perf.h"
 #include "imgui/imgui_impl_skg.h"
 
 #if defined(_WIN32)
@@ -23,6 +24,12 @@
 #endif
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#if defined(__linux__)
+#include <unistd.h>
+#endif
 
 #include "imgui/sk_gpu.h"
 #define SOKOL_TIME_IMPL
@@ -39,37 +46,68 @@ ImVec4 shell_clear_color = ImVec4(0, 0, 0, 1.00f);
 bool shell_create_window();
 void shell_destroy_window();
 void shell_loop(void (*step)());
+bool shell_font_load     (const char *ttf_file, float size_pixels);
+bool shell_font_cache_read (const char *cache_file, const char *key, float size_pixels);
+void shell_font_cache_write(const char *cache_file, const char *key);
 
 //int WinMain(HINSTANCE, HINSTANCE, LPSTR, int) {
 int main(int arg_count, const char **args) {
+	stm_setup();
+
 	if (!app_args(arg_count, args))
 		return 0;
 
+#if defined(__linux__)
+	// The runtime may touch Xlib from the startup probe thread while we're
+	// creating our own window here.
+	XInitThreads();
+#endif
+	app_startup_begin();
+
+	app_startup_phase(startup_phase_window, true);
 	shell_create_window();
+	app_startup_phase(startup_phase_window, false);
 
 	// Setup Dear ImGui style
 	ImGui::StyleColorsDark();
 
-	if (!app_init())
+	app_startup_phase(startup_phase_init, true);
+	if (!app_init()) {
+		// The startup threads are still joinable, and would terminate the
+		// process on their way out
+		app_shutdown();
 		return 2;
+	}
+	app_startup_phase(startup_phase_init, false);
 
-	stm_setup();
-
+	app_startup_phase(startup_phase_first_frame, true);
 	shell_loop([]() {
+		uint64_t frame_start = perf_now();
+		ImGui_ImplSkg_SetProfiling(perf_enabled());
+
 		// Start the Dear ImGui frame
 		skg_draw_begin();
 		ImGui_ImplSkg_NewFrame();
 		ImGui::NewFrame();
 
+		uint64_t start = perf_now();
 		app_step({(float)sk_width, (float)sk_height});
+		perf_record(perf_metric_step, start);
 
 		// Rendering
+		start = perf_now();
 		ImGui::Render();
+		perf_record(perf_metric_render, start);
 		skg_swapchain_bind(&sk_swapchain);
 		skg_target_clear(true, (float *)&shell_clear_color);
 		ImGui_ImplSkg_RenderDrawData(ImGui::GetDrawData());
+		perf_record_ms(perf_metric_upload, ImGui_ImplSkg_UploadMs());
 
+		start = perf_now();
 		skg_swapchain_present(&sk_swapchain);
+		perf_record(perf_metric_present, start);
+		perf_record(perf_metric_frame,   frame_start);
+		app_frame_presented();
 	});
 
 	// Cleanup
@@ -81,6 +119,200 @@ int main(int arg_count, const char **args) {
 	return 0;
 }
 
+///////////////////////////////////////////
+
+// Baking the atlas through stb_truetype is one of the slower parts of a cold
+// start, so the baked alpha8 atlas and glyph metrics get cached in the config
+// folder. The key covers everything that would change the bake.
+const uint32_t font_cache_magic   = 0x43465846; // 'FXFC'
+const uint32_t font_cache_version = 1;
+
+struct font_cache_glyph_t {
+	uint32_t codepoint;
+	uint32_t visible;
+	float    advance_x;
+	float    x0, y0, x1, y1;
+	float    u0, v0, u1, v1;
+};
+
+bool shell_font_load(const char *ttf_file, float size_pixels) {
+	ImFontAtlas *atlas = ImGui::GetIO().Fonts;
+
+	struct stat font_stat = {};
+	if (ttf_file && stat(ttf_file, &font_stat) != 0)
+		ttf_file = nullptr;
+
+	char key[512];
+	snprintf(key, sizeof(key), "%s|%lld|%lld|%.2f|%.2f|%d",
+		ttf_file ? ttf_file : "<default>",
+		(long long)font_stat.st_mtime, (long long)font_stat.st_size,
+		size_pixels, app_scale, IMGUI_VERSION_NUM);
+
+	char cache_file[1024];
+	snprintf(cache_file, sizeof(cache_file), "%s%sfont_cache.bin", app_path_config, app_path_config[0] ? "/" : "");
+
+	if (shell_font_cache_read(cache_file, key, size_pixels))
+		return true;
+
+	ImFont *font = nullptr;
+	if (ttf_file) {
+		font = atlas->AddFontFromFileTTF(ttf_file, size_pixels, nullptr, atlas->GetGlyphRangesDefault());
+	} else {
+		ImFontConfig cfg = {};
+		cfg.SizePixels = size_pixels;
+		font = atlas->AddFontDefault(&cfg);
+	}
+	if (font == nullptr || !atlas->Build())
+		return false;
+
+	shell_font_cache_write(cache_file, key);
+	return true;
+}
+
+///////////////////////////////////////////
+
+bool shell_font_cache_read(const char *cache_file, const char *key, float size_pixels) {
+	FILE *fp = fopen(cache_file, "rb");
+	if (fp == nullptr) return false;
+
+	uint32_t magic = 0, version = 0, key_len = 0;
+	char     file_key[512];
+	bool     ok = fread(&magic,   sizeof(magic),   1, fp) == 1 && magic   == font_cache_magic
+	           && fread(&version, sizeof(version), 1, fp) == 1 && version == font_cache_version
+	           && fread(&key_len, sizeof(key_len), 1, fp) == 1 && key_len < sizeof(file_key)
+	           && fread(file_key, 1, key_len, fp) == key_len;
+	if (ok) {
+		file_key[key_len] = '\0';
+		ok = strcmp(file_key, key) == 0;
+	}
+
+	int32_t  tex_width = 0, tex_height = 0;
+	float    metrics[3] = {}; // FontSize, Ascent, Descent
+	uint32_t fallback_char = 0, glyph_count = 0;
+	ImVec2   uv_white = {};
+	ImVec4   uv_lines[IM_DRAWLIST_TEX_LINES_WIDTH_MAX + 1];
+	ok = ok
+		&& fread(&tex_width,     sizeof(tex_width),     1, fp) == 1
+		&& fread(&tex_height,    sizeof(tex_height),    1, fp) == 1
+		&& fread(&uv_white,      sizeof(uv_white),      1, fp) == 1
+		&& fread(uv_lines,       sizeof(uv_lines),      1, fp) == 1
+		&& fread(metrics,        sizeof(metrics),       1, fp) == 1
+		&& fread(&fallback_char, sizeof(fallback_char), 1, fp) == 1
+		&& fread(&glyph_count,   sizeof(glyph_count),   1, fp) == 1
+		&& tex_width > 0 && tex_height > 0 && glyph_count > 0 && glyph_count < 0xFFFF;
+	if (!ok) { fclose(fp); return false; }
+
+	font_cache_glyph_t *glyphs = (font_cache_glyph_t *)malloc(sizeof(font_cache_glyph_t) * glyph_count);
+	unsigned char      *pixels = (unsigned char *)IM_ALLOC((size_t)tex_width * tex_height);
+	ok = fread(glyphs, sizeof(font_cache_glyph_t), glyph_count, fp) == glyph_count
+	  && fread(pixels, 1, (size_t)tex_width * tex_height, fp) == (size_t)tex_width * tex_height;
+	fclose(fp);
+	if (!ok) { free(glyphs); IM_FREE(pixels); return false; }
+
+	// Rebuild the atlas by hand, the same way ImFontAtlas::Build would have
+	// left it, but without any TTF data attached.
+	ImFontAtlas *atlas = ImGui::GetIO().Fonts;
+	atlas->Clear();
+	atlas->Flags          |= ImFontAtlasFlags_NoMouseCursors;
+	atlas->TexWidth        = tex_width;
+	atlas->TexHeight       = tex_height;
+	atlas->TexUvScale      = ImVec2(1.0f / tex_width, 1.0f / tex_height);
+	atlas->TexUvWhitePixel = uv_white;
+	atlas->TexPixelsAlpha8 = pixels;
+	memcpy(atlas->TexUvLines, uv_lines, sizeof(uv_lines));
+
+	ImFontConfig cfg = {};
+	cfg.SizePixels           = size_pixels;
+	cfg.FontDataOwnedByAtlas = false;
+	snprintf(cfg.Name, sizeof(cfg.Name), "cached %.0fpx", size_pixels);
+	atlas->Sources.push_back(cfg);
+
+	ImFont *font = IM_NEW(ImFont);
+	atlas->Fonts.push_back(font);
+	atlas->Sources[0].DstFont = font;
+	font->ContainerAtlas = atlas;
+	font->Sources        = &atlas->Sources[0];
+	font->SourcesCount   = 1;
+	font->FontSize       = metrics[0];
+	font->Ascent         = metrics[1];
+	font->Descent        = metrics[2];
+	font->FallbackChar   = (ImWchar)fallback_char;
+	for (uint32_t i = 0; i < glyph_count; i++) {
+		const font_cache_glyph_t *g = &glyphs[i];
+		font->AddGlyph(nullptr, (ImWchar)g->codepoint, g->x0, g->y0, g->x1, g->y1, g->u0, g->v0, g->u1, g->v1, g->advance_x);
+		font->Glyphs.back().Visible = g->visible;
+	}
+	font->BuildLookupTable();
+	atlas->TexReady = true;
+
+	free(glyphs);
+	return true;
+}
+
+///////////////////////////////////////////
+
+void shell_font_cache_write(const char *cache_file, const char *key) {
+	ImFontAtlas *atlas = ImGui::GetIO().Fonts;
+	if (atlas->Fonts.Size != 1 || atlas->TexPixelsAlpha8 == nullptr)
+		return;
+
+	// Write to the side and rename over, like the manifest cache, so a
+	// second instance starting up never reads half an atlas.
+	char tmp_file[1100];
+#if defined(_WIN32)
+	int32_t length = snprintf(tmp_file, sizeof(tmp_file), "%s.%lu.%lu.tmp", cache_file, GetCurrentProcessId(), GetCurrentThreadId());
+	if (length < 0 || length >= (int32_t)sizeof(tmp_file)) return;
+	FILE *fp = fopen(tmp_file, "wb");
+#else
+	int32_t length = snprintf(tmp_file, sizeof(tmp_file), "%s.XXXXXX", cache_file);
+	if (length < 0 || length >= (int32_t)sizeof(tmp_file)) return;
+	int   fd = mkstemp(tmp_file);
+	FILE *fp = fd >= 0 ? fdopen(fd, "wb") : nullptr;
+	if (fd >= 0 && fp == nullptr) { close(fd); remove(tmp_file); }
+#endif
+	if (fp == nullptr) return;
+
+	const ImFont *font        = atlas->Fonts[0];
+	uint32_t      key_len     = (uint32_t)strlen(key);
+	float         metrics[3]  = { font->FontSize, font->Ascent, font->Descent };
+	uint32_t      fallback    = font->FallbackChar;
+	uint32_t      glyph_count = (uint32_t)font->Glyphs.Size;
+	fwrite(&font_cache_magic,   sizeof(font_cache_magic),   1, fp);
+	fwrite(&font_cache_version, sizeof(font_cache_version), 1, fp);
+	fwrite(&key_len,            sizeof(key_len),            1, fp);
+	fwrite(key,                 1,                    key_len, fp);
+	fwrite(&atlas->TexWidth,        sizeof(atlas->TexWidth),        1, fp);
+	fwrite(&atlas->TexHeight,       sizeof(atlas->TexHeight),       1, fp);
+	fwrite(&atlas->TexUvWhitePixel, sizeof(atlas->TexUvWhitePixel), 1, fp);
+	fwrite(atlas->TexUvLines,       sizeof(atlas->TexUvLines),      1, fp);
+	fwrite(metrics,                 sizeof(metrics),                1, fp);
+	fwrite(&fallback,               sizeof(fallback),               1, fp);
+	fwrite(&glyph_count,            sizeof(glyph_count),            1, fp);
+	for (int32_t i = 0; i < font->Glyphs.Size; i++) {
+		const ImFontGlyph *src = &font->Glyphs[i];
+		font_cache_glyph_t g = {
+			src->Codepoint, src->Visible, src->AdvanceX,
+			src->X0, src->Y0, src->X1, src->Y1,
+			src->U0, src->V0, src->U1, src->V1 };
+		fwrite(&g, sizeof(g), 1, fp);
+	}
+	fwrite(atlas->TexPixelsAlpha8, 1, (size_t)atlas->TexWidth * atlas->TexHeight, fp);
+	bool ok = ferror(fp) == 0;
+	ok = fclose(fp) == 0 && ok;
+
+	if (ok) {
+#if defined(_WIN32)
+		MoveFileExA(tmp_file, cache_file, MOVEFILE_REPLACE_EXISTING);
+#else
+		rename(tmp_file, cache_file);
+#endif
+	} else {
+		remove(tmp_file);
+	}
+}
+
+///////////////////////////////////////////
+
 #if defined(_WIN32)
 
 HWND shell_hwnd;
@@ -193,7 +425,7 @@ bool shell_create_window() {
 	ImGui::CreateContext();
 	ImGuiIO& io = ImGui::GetIO();
 	io.ConfigFlags |= ImGuiConfigFlags_DockingEnable;
-	ImFont* font = io.Fonts->AddFontFromFileTTF("c:\\Windows\\Fonts\\consola.ttf", 12.0f * app_scale, NULL, io.Fonts->GetGlyphRangesDefault());
+	shell_font_load("c:\\Windows\\Fonts\\consola.ttf", 12.0f * app_scale);
 	io.FontGlobalScale = 1.0f;
 
 	ImGui_ImplWin32_Init(shell_hwnd);
@@ -355,6 +587,7 @@ bool shell_create_window() {
 	snprintf(app_ini_path_str, sizeof(app_ini_path_str), "%s/imgui.ini", app_config_path_str);
 	io.IniFilename = app_ini_path_str;
 	io.ConfigFlags |= ImGuiConfigFlags_DockingEnable;
+	shell_font_load(nullptr, 13.0f * app_scale);
 	// Setup Platform/Renderer backends
 	ImGui_ImplX11_Init(xcb_window);
 	ImGui_ImplSkg_Init();
@@ -4,11 +4,26 @@
 #include "imgui/imgui_internal.h"
 #include <stdint.h>
 
+enum startup_phase_ {
+	startup_phase_runtimes,
+	startup_phase_probe,
+	startup_phase_window,
+	startup_phase_init,
+	startup_phase_join,
+	startup_phase_first_frame,
+	startup_phase_max,
+};
+
 bool app_args(int32_t arg_count, const char **args);
 bool app_init();
 void app_step(ImVec2 canvas_size);
 void app_shutdown();
 
+void app_startup_begin  ();
+void app_startup_join   ();
+void app_startup_phase  (startup_phase_ phase, bool begin);
+void app_frame_presented();
+
 extern const char *app_name;
 extern const char *app_id;
 extern const char *app_path_config;
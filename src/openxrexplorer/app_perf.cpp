@@ -0,0 +1,220 @@
+#include "app_perf.h"
+#include "imgui/imgui.h"
+#include "imgui/sokol_time.h"
+
+#include <atomic>
+#include <stdio.h>
+#include <string.h>
+
+/*** Types *******************************/
+
+#define PERF_RING_SIZE  240
+#define PERF_PROBE_MAX  64
+
+// Single writer, any number of readers. The writer fills the slot first and
+// then publishes it by bumping head, so a reader only ever sees samples
+// that were completely written.
+struct perf_ring_t {
+	float                 samples[PERF_RING_SIZE];
+	std::atomic<uint32_t> head;
+};
+
+struct perf_probe_t {
+	const char *name;
+	float       ms;
+};
+
+// The probe thread rewrites entries from the start on every reload, while
+// the HUD may be reading them. Entries are atomic so a read is never torn,
+// and the generation changes on every clear, so the HUD can tell when a
+// list it copied was cleared under it and keep its previous copy instead.
+struct perf_probe_slot_t {
+	std::atomic<const char *> name;
+	std::atomic<float>        ms;
+};
+
+struct perf_stats_t {
+	float last;
+	float avg;
+	float max;
+	int32_t count;
+};
+
+/*** Global Variables ********************/
+
+const char *perf_metric_names[perf_metric_max] = {
+	"app_step",
+	"ImGui::Render",
+	"Vertex upload",
+	"Present",
+	"Frame",
+};
+
+std::atomic<bool>    perf_active = {false};
+perf_ring_t          perf_rings [perf_metric_max];
+perf_probe_slot_t     perf_probes[PERF_PROBE_MAX];
+std::atomic<int32_t>  perf_probe_count      = {0};
+std::atomic<uint32_t> perf_probe_generation = {0};
+
+/*** Code ********************************/
+
+bool perf_enabled() {
+	return perf_active.load(std::memory_order_relaxed);
+}
+
+///////////////////////////////////////////
+
+void perf_set_enabled(bool enabled) {
+	perf_active.store(enabled, std::memory_order_relaxed);
+}
+
+///////////////////////////////////////////
+
+uint64_t perf_now() {
+	return perf_enabled() ? stm_now() : 0;
+}
+
+///////////////////////////////////////////
+
+void perf_record(perf_metric_ metric, uint64_t start_ticks) {
+	if (!perf_enabled() || start_ticks == 0) return;
+	perf_record_ms(metric, (float)stm_ms(stm_since(start_ticks)));
+}
+
+///////////////////////////////////////////
+
+void perf_record_ms(perf_metric_ metric, float ms) {
+	if (!perf_enabled()) return;
+
+	perf_ring_t *ring = &perf_rings[metric];
+	uint32_t     head = ring->head.load(std::memory_order_relaxed);
+	ring->samples[head % PERF_RING_SIZE] = ms;
+	ring->head.store(head + 1, std::memory_order_release);
+}
+
+///////////////////////////////////////////
+
+void perf_probe_clear() {
+	// Count first, so a reader that sees the new generation also sees the
+	// list empty
+	perf_probe_count     .store(0);
+	perf_probe_generation.fetch_add(1);
+}
+
+///////////////////////////////////////////
+
+void perf_probe_record(const char *name, uint64_t start_ticks) {
+	int32_t index = perf_probe_count.load(std::memory_order_relaxed);
+	if (index >= PERF_PROBE_MAX) return;
+
+	perf_probes[index].name.store(name,                                   std::memory_order_relaxed);
+	perf_probes[index].ms  .store((float)stm_ms(stm_since(start_ticks)), std::memory_order_relaxed);
+	perf_probe_count.store(index + 1, std::memory_order_release);
+}
+
+///////////////////////////////////////////
+
+static perf_stats_t perf_ring_stats(const perf_ring_t *ring, uint32_t head) {
+	perf_stats_t result = {};
+	result.count = head < PERF_RING_SIZE ? (int32_t)head : PERF_RING_SIZE;
+	if (result.count == 0) return result;
+
+	float total = 0;
+	for (int32_t i = 0; i < result.count; i++) {
+		float s = ring->samples[(head - result.count + i) % PERF_RING_SIZE];
+		total += s;
+		if (s > result.max) result.max = s;
+	}
+	result.avg  = total / result.count;
+	result.last = ring->samples[(head - 1) % PERF_RING_SIZE];
+	return result;
+}
+
+///////////////////////////////////////////
+
+struct perf_plot_t {
+	const perf_ring_t *ring;
+	uint32_t           head;
+	int32_t            count;
+};
+static float perf_plot_get(void *data, int32_t idx) {
+	perf_plot_t *plot = (perf_plot_t *)data;
+	return plot->ring->samples[(plot->head - plot->count + idx) % PERF_RING_SIZE];
+}
+
+///////////////////////////////////////////
+
+void perf_window(bool *open) {
+	perf_set_enabled(*open);
+	if (!*open) return;
+
+	ImGui::SetNextWindowBgAlpha(0.85f);
+	ImGui::SetNextWindowSize(ImVec2(360, 0), ImGuiCond_FirstUseEver);
+	if (!ImGui::Begin("Performance HUD", open, ImGuiWindowFlags_NoDocking | ImGuiWindowFlags_NoSavedSettings)) {
+		ImGui::End();
+		return;
+	}
+
+	// Frame metrics, all sharing one scale so they can be compared by eye
+	uint32_t     heads[perf_metric_max];
+	perf_stats_t stats[perf_metric_max];
+	float        scale = 1;
+	for (int32_t m = 0; m < perf_metric_max; m++) {
+		heads[m] = perf_rings[m].head.load(std::memory_order_acquire);
+		stats[m] = perf_ring_stats(&perf_rings[m], heads[m]);
+		if (stats[m].max > scale) scale = stats[m].max;
+	}
+
+	char overlay[64];
+	for (int32_t m = 0; m < perf_metric_max; m++) {
+		perf_plot_t plot = { &perf_rings[m], heads[m], stats[m].count };
+		snprintf(overlay, sizeof(overlay), "%.2fms avg, %.2fms max", stats[m].avg, stats[m].max);
+		ImGui::Text("%-14s %6.2fms", perf_metric_names[m], stats[m].last);
+		ImGui::PushID(m);
+		ImGui::PlotHistogram("##hist", perf_plot_get, &plot, plot.count, 0, overlay, 0, scale, ImVec2(-1, 32));
+		ImGui::PopID();
+	}
+
+	// Last openxr_info_reload, broken down by probe step
+	ImGui::Spacing();
+	ImGui::Separator();
+	ImGui::Spacing();
+
+	// Copied out first, and only kept if no clear happened during the copy
+	static perf_probe_t probes[PERF_PROBE_MAX];
+	static int32_t      probe_count = 0;
+	perf_probe_t copy[PERF_PROBE_MAX];
+	uint32_t     generation = perf_probe_generation.load();
+	int32_t      copy_count = perf_probe_count.load(std::memory_order_acquire);
+	for (int32_t i = 0; i < copy_count; i++) {
+		copy[i].name = perf_probes[i].name.load(std::memory_order_relaxed);
+		copy[i].ms   = perf_probes[i].ms  .load(std::memory_order_relaxed);
+	}
+	std::atomic_thread_fence(std::memory_order_acquire);
+	if (generation == perf_probe_generation.load()) {
+		memcpy(probes, copy, sizeof(perf_probe_t) * copy_count);
+		probe_count = copy_count;
+	}
+
+	if (probe_count == 0) {
+		ImGui::TextDisabled("No probe recorded yet");
+	} else if (ImGui::BeginTable("probe", 2, ImGuiTableFlags_RowBg | ImGuiTableFlags_Borders | ImGuiTableFlags_SizingFixedFit)) {
+		ImGui::TableSetupColumn("Probe step", ImGuiTableColumnFlags_WidthStretch);
+		ImGui::TableSetupColumn("ms");
+		ImGui::TableHeadersRow();
+
+		float total = 0;
+		for (int32_t i = 0; i < probe_count; i++) {
+			ImGui::TableNextRow();
+			ImGui::TableSetColumnIndex(0); ImGui::TextUnformatted(probes[i].name);
+			ImGui::TableSetColumnIndex(1); ImGui::Text("%.2f", probes[i].ms);
+			total += probes[i].ms;
+		}
+		ImGui::TableNextRow();
+		ImGui::TableSetColumnIndex(0); ImGui::TextDisabled("Total");
+		ImGui::TableSetColumnIndex(1); ImGui::TextDisabled("%.2f", total);
+		ImGui::EndTable();
+	}
+
+	ImGui::End();
+}
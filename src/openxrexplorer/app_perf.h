@@ -0,0 +1,30 @@
+#pragma once
+
+#include <stdint.h>
+
+// Timings for the explorer's own frame and probe work. Frame metrics are
+// only sampled while the HUD is visible, so a hidden HUD costs one branch
+// per sample site. Probe timings are always kept, since a reload is rare
+// and the HUD should be able to show the last one after it happened.
+
+enum perf_metric_ {
+	perf_metric_step,
+	perf_metric_render,
+	perf_metric_upload,
+	perf_metric_present,
+	perf_metric_frame,
+	perf_metric_max,
+};
+
+/*** Signatures **************************/
+
+bool     perf_enabled      ();
+void     perf_set_enabled  (bool enabled);
+uint64_t perf_now          ();
+void     perf_record       (perf_metric_ metric, uint64_t start_ticks);
+void     perf_record_ms    (perf_metric_ metric, float ms);
+
+void     perf_probe_clear  ();
+void     perf_probe_record (const char *name, uint64_t start_ticks);
+
+void     perf_window       (bool *open);
@@ -0,0 +1,255 @@
+#include "app_process.h"
+#include "xrruntime.h"
+#include "imgui/sokol_time.h"
+
+#include <atomic>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <spawn.h>
+#include <unistd.h>
+#include <sys/wait.h>
+extern char **environ;
+#endif
+
+/*** Global Variables ********************/
+
+std::atomic<bool> process_aborted = {false};
+
+/*** Signatures **************************/
+
+static bool process_env_overridden(const char *entry, const char **env, int32_t env_count);
+static void process_output_add    (process_result_t *result, const char *data, size_t size, size_t *capacity);
+
+/*** Code ********************************/
+
+void process_abort_all() {
+	process_aborted.store(true);
+}
+
+///////////////////////////////////////////
+
+void process_result_free(process_result_t *result) {
+	free(result->output);
+	*result = {};
+}
+
+///////////////////////////////////////////
+
+#if defined(_WIN32)
+
+bool process_run_self(const char **args, int32_t arg_count, const char **env, int32_t env_count, int32_t timeout_ms, process_result_t *out_result) {
+	*out_result = {};
+	uint64_t start = stm_now();
+
+	char exe[MAX_PATH];
+	if (GetModuleFileNameA(nullptr, exe, sizeof(exe)) == 0) return false;
+
+	// Command line, with everything quoted
+	size_t cmd_size = strlen(exe) + 3;
+	for (int32_t i = 0; i < arg_count; i++) cmd_size += strlen(args[i]) + 3;
+	char *cmd = (char *)malloc(cmd_size + 1);
+	char *at  = cmd + sprintf(cmd, "\"%s\"", exe);
+	for (int32_t i = 0; i < arg_count; i++) at += sprintf(at, " \"%s\"", args[i]);
+
+	// Environment block: inherited entries that aren't overridden, then ours
+	char  *parent    = GetEnvironmentStringsA();
+	size_t env_size  = 1;
+	for (char *e = parent; *e; e += strlen(e) + 1) env_size += strlen(e) + 1;
+	for (int32_t i = 0; i < env_count; i++)        env_size += strlen(env[i]) + 1;
+	char *env_block = (char *)malloc(env_size);
+	char *env_at    = env_block;
+	for (char *e = parent; *e; e += strlen(e) + 1) {
+		if (process_env_overridden(e, env, env_count)) continue;
+		size_t len = strlen(e) + 1;
+		memcpy(env_at, e, len);
+		env_at += len;
+	}
+	for (int32_t i = 0; i < env_count; i++) {
+		size_t len = strlen(env[i]) + 1;
+		memcpy(env_at, env[i], len);
+		env_at += len;
+	}
+	*env_at = '\0';
+	FreeEnvironmentStringsA(parent);
+
+	SECURITY_ATTRIBUTES security = { sizeof(SECURITY_ATTRIBUTES), nullptr, TRUE };
+	HANDLE pipe_read, pipe_write;
+	if (!CreatePipe(&pipe_read, &pipe_write, &security, 0)) {
+		free(cmd);
+		free(env_block);
+		return false;
+	}
+	SetHandleInformation(pipe_read, HANDLE_FLAG_INHERIT, 0);
+
+	STARTUPINFOA        startup = { sizeof(STARTUPINFOA) };
+	PROCESS_INFORMATION info    = {};
+	startup.dwFlags    = STARTF_USESTDHANDLES;
+	startup.hStdOutput = pipe_write;
+	startup.hStdError  = INVALID_HANDLE_VALUE;
+	startup.hStdInput  = INVALID_HANDLE_VALUE;
+	out_result->launched = CreateProcessA(exe, cmd, nullptr, nullptr, TRUE, CREATE_NO_WINDOW, env_block, nullptr, &startup, &info);
+	CloseHandle(pipe_write);
+	free(cmd);
+	free(env_block);
+	if (!out_result->launched) {
+		CloseHandle(pipe_read);
+		return false;
+	}
+
+	size_t capacity = 0;
+	char   buffer[4096];
+	while (true) {
+		DWORD available = 0, read = 0;
+		if (!PeekNamedPipe(pipe_read, nullptr, 0, nullptr, &available, nullptr)) break; // closed
+		if (available > 0) {
+			if (!ReadFile(pipe_read, buffer, sizeof(buffer), &read, nullptr) || read == 0) break;
+			process_output_add(out_result, buffer, read, &capacity);
+			continue;
+		}
+		if (process_aborted.load() || (timeout_ms > 0 && stm_ms(stm_since(start)) > timeout_ms)) {
+			TerminateProcess(info.hProcess, 1);
+			out_result->timed_out = true;
+			break;
+		}
+		WaitForSingleObject(info.hProcess, 10);
+	}
+	CloseHandle(pipe_read);
+
+	WaitForSingleObject(info.hProcess, INFINITE);
+	DWORD exit_code = 0;
+	GetExitCodeProcess(info.hProcess, &exit_code);
+	out_result->exit_code = (int32_t)exit_code;
+	CloseHandle(info.hProcess);
+	CloseHandle(info.hThread);
+
+	process_output_add(out_result, "", 0, &capacity);
+	out_result->ms = (float)stm_ms(stm_since(start));
+	return !out_result->timed_out;
+}
+
+#else
+
+bool process_run_self(const char **args, int32_t arg_count, const char **env, int32_t env_count, int32_t timeout_ms, process_result_t *out_result) {
+	*out_result = {};
+	uint64_t start = stm_now();
+
+	char exe[1024];
+	ssize_t exe_len = readlink("/proc/self/exe", exe, sizeof(exe) - 1);
+	if (exe_len <= 0) return false;
+	exe[exe_len] = '\0';
+
+	const char **argv = (const char **)malloc(sizeof(char *) * (arg_count + 2));
+	argv[0] = exe;
+	for (int32_t i = 0; i < arg_count; i++) argv[i + 1] = args[i];
+	argv[arg_count + 1] = nullptr;
+
+	// environ is only borrowed until the child starts, the GUI can change
+	// it from its own thread.
+	runtime_env_lock();
+	int32_t environ_count = 0;
+	while (environ[environ_count]) environ_count++;
+	const char **envp  = (const char **)malloc(sizeof(char *) * (environ_count + env_count + 1));
+	int32_t      env_n = 0;
+	for (int32_t i = 0; i < environ_count; i++) {
+		if (!process_env_overridden(environ[i], env, env_count))
+			envp[env_n++] = environ[i];
+	}
+	for (int32_t i = 0; i < env_count; i++) envp[env_n++] = env[i];
+	envp[env_n] = nullptr;
+
+	// O_CLOEXEC so children spawned from other threads can't hold our
+	// write end open and keep us from seeing EOF.
+	int pipe_fd[2];
+	if (pipe2(pipe_fd, O_CLOEXEC) != 0) {
+		runtime_env_unlock();
+		free(argv);
+		free(envp);
+		return false;
+	}
+
+	posix_spawn_file_actions_t actions;
+	posix_spawn_file_actions_init     (&actions);
+	posix_spawn_file_actions_adddup2  (&actions, pipe_fd[1], STDOUT_FILENO);
+	posix_spawn_file_actions_addopen  (&actions, STDERR_FILENO, "/dev/null", O_WRONLY, 0);
+
+	pid_t pid = 0;
+	out_result->launched = posix_spawn(&pid, exe, &actions, nullptr, (char *const *)argv, (char *const *)envp) == 0;
+	runtime_env_unlock();
+	posix_spawn_file_actions_destroy(&actions);
+	close(pipe_fd[1]);
+	free(argv);
+	free(envp);
+	if (!out_result->launched) {
+		close(pipe_fd[0]);
+		return false;
+	}
+
+	size_t capacity = 0;
+	char   buffer[4096];
+	while (true) {
+		pollfd fd = { pipe_fd[0], POLLIN, 0 };
+		int    ready = poll(&fd, 1, 20);
+		if (ready > 0) {
+			ssize_t count = read(pipe_fd[0], buffer, sizeof(buffer));
+			if (count < 0 && errno == EINTR) continue;
+			if (count <= 0) break;
+			process_output_add(out_result, buffer, count, &capacity);
+			continue;
+		}
+		if (process_aborted.load() || (timeout_ms > 0 && stm_ms(stm_since(start)) > timeout_ms)) {
+			kill(pid, SIGKILL);
+			out_result->timed_out = true;
+			break;
+		}
+	}
+	close(pipe_fd[0]);
+
+	int status = 0;
+	while (waitpid(pid, &status, 0) < 0 && errno == EINTR);
+	out_result->exit_code = WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+
+	process_output_add(out_result, "", 0, &capacity);
+	out_result->ms = (float)stm_ms(stm_since(start));
+	return !out_result->timed_out;
+}
+
+#endif
+
+///////////////////////////////////////////
+
+static bool process_env_overridden(const char *entry, const char **env, int32_t env_count) {
+	const char *eq = strchr(entry, '=');
+	if (eq == nullptr || eq == entry) return false;
+	size_t name_len = eq - entry;
+	for (int32_t i = 0; i < env_count; i++) {
+#if defined(_WIN32)
+		if (_strnicmp(entry, env[i], name_len + 1) == 0) return true;
+#else
+		if (strncmp  (entry, env[i], name_len + 1) == 0) return true;
+#endif
+	}
+	return false;
+}
+
+///////////////////////////////////////////
+
+static void process_output_add(process_result_t *result, const char *data, size_t size, size_t *capacity) {
+	if (result->output_size + size + 1 > *capacity) {
+		*capacity = *capacity * 2 < result->output_size + size + 1
+			? result->output_size + size + 1
+			: *capacity * 2;
+		result->output = (char *)realloc(result->output, *capacity);
+	}
+	memcpy(&result->output[result->output_size], data, size);
+	result->output_size += size;
+	result->output[result->output_size] = '\0';
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Runs another copy of this executable and collects what it writes to
+// stdout. This is how we look at runtimes other than the active one: the
+// loader picks up XR_RUNTIME_JSON from the child's environment, and the
+// system-wide runtime setting is never touched.
+
+/*** Types *******************************/
+
+struct process_result_t {
+	bool     launched;
+	bool     timed_out;
+	int32_t  exit_code;
+	char    *output;      // Null terminated, free with process_result_free
+	size_t   output_size;
+	float    ms;
+};
+
+/*** Signatures **************************/
+
+// env entries are "NAME=value", and replace any inherited variable of the
+// same name. stderr is discarded. Blocks until the child exits, the
+// timeout passes, or process_abort_all is called.
+bool process_run_self   (const char **args, int32_t arg_count, const char **env, int32_t env_count, int32_t timeout_ms, process_result_t *out_result);
+void process_result_free(process_result_t *result);
+void process_abort_all  ();
@@ -0,0 +1,187 @@
+#include "app_search.h"
+#include "imgui/sokol_time.h"
+
+#include <string.h>
+#include <ctype.h>
+
+/*** Global Variables ********************/
+
+// Cells of a document are joined with the ASCII unit separator. It can't
+// be typed into the search bar, and search_query drops it from queries,
+// so a query never matches across two cells.
+const char search_cell_separator = '\x1f';
+
+/*** Signatures **************************/
+
+static void     search_add_doc   (search_index_t *index, const char **strings, int32_t count);
+static uint32_t search_trigram   (const char *at);
+static size_t   search_lower_bound(const array_t<uint64_t> &list, uint64_t value);
+
+/*** Code ********************************/
+
+void search_build(search_index_t *index, const display_table_t *tables, size_t table_count) {
+	search_free(index);
+	index->tables      = tables;
+	index->table_count = table_count;
+
+	for (size_t t = 0; t < table_count; t++) {
+		const display_table_t *table = &tables[t];
+		index->table_doc.add((uint32_t)index->doc_text.count);
+
+		const char *names[2] = { table->name_func, table->name_type };
+		search_add_doc(index, names, 2);
+
+		// Header rows get an empty document so row numbers still line up
+		for (size_t r = 0; r < table->cols[0].count; r++) {
+			const char *cells[3] = {};
+			int32_t     count    = 0;
+			if (!(table->header_row && r == 0)) {
+				for (int32_t c = 0; c < table->column_count; c++)
+					cells[count++] = table->cols[c][r].text;
+			}
+			search_add_doc(index, cells, count);
+		}
+	}
+	index->table_doc.add((uint32_t)index->doc_text.count);
+
+	// Postings, sorted by trigram and then by document
+	for (size_t d = 0; d < index->doc_text.count; d++) {
+		const char *text = &index->text[index->doc_text[d]];
+		for (size_t i = 0; text[i] && text[i+1] && text[i+2]; i++)
+			index->trigrams.add(((uint64_t)search_trigram(&text[i]) << 32) | d);
+	}
+	index->trigrams.sort();
+	size_t unique = 0;
+	for (size_t i = 0; i < index->trigrams.count; i++) {
+		if (unique == 0 || index->trigrams[unique-1] != index->trigrams[i])
+			index->trigrams[unique++] = index->trigrams[i];
+	}
+	index->trigrams.count = unique;
+
+	index->doc_hit    = array_t<uint8_t>::make_fill((int32_t)index->doc_text.count, 0);
+	index->table_hits = array_t<int32_t>::make_fill((int32_t)table_count, 0);
+}
+
+///////////////////////////////////////////
+
+void search_free(search_index_t *index) {
+	index->text      .free();
+	index->doc_text  .free();
+	index->table_doc .free();
+	index->trigrams  .free();
+	index->doc_hit   .free();
+	index->table_hits.free();
+	*index = {};
+}
+
+///////////////////////////////////////////
+
+void search_query(search_index_t *index, const char *query) {
+	uint64_t start = stm_now();
+
+	char    lower[128];
+	int32_t len = 0;
+	for (; query && *query && len < (int32_t)sizeof(lower)-1; query++) {
+		if (*query != search_cell_separator)
+			lower[len++] = (char)tolower((unsigned char)*query);
+	}
+	lower[len] = '\0';
+
+	index->active    = len > 0;
+	index->hit_count = 0;
+	if (!index->active) return;
+
+	memset(index->doc_hit   .data, 0, index->doc_hit   .count * sizeof(uint8_t));
+	memset(index->table_hits.data, 0, index->table_hits.count * sizeof(int32_t));
+
+	// Narrow the candidates down to the rarest trigram in the query. Short
+	// queries have no trigram, so they fall back to checking everything.
+	size_t first = 0, last = index->doc_text.count;
+	bool   postings = false;
+	for (int32_t i = 0; i + 2 < len; i++) {
+		uint64_t key = (uint64_t)search_trigram(&lower[i]) << 32;
+		size_t   lo  = search_lower_bound(index->trigrams, key);
+		size_t   hi  = search_lower_bound(index->trigrams, key + 0x100000000ULL);
+		if (!postings || hi - lo < last - first) {
+			first    = lo;
+			last     = hi;
+			postings = true;
+		}
+		if (lo == hi) break;
+	}
+
+	for (size_t i = first; i < last; i++) {
+		uint32_t doc = postings ? (uint32_t)index->trigrams[i] : (uint32_t)i;
+		if (strstr(&index->text[index->doc_text[doc]], lower)) {
+			index->doc_hit[doc] = 1;
+			index->hit_count   += 1;
+		}
+	}
+
+	for (size_t t = 0; t < index->table_count; t++) {
+		for (uint32_t d = index->table_doc[t]; d < index->table_doc[t+1]; d++)
+			index->table_hits[t] += index->doc_hit[d];
+	}
+
+	index->query_ms = (float)stm_ms(stm_since(start));
+}
+
+///////////////////////////////////////////
+
+static int64_t search_table_id(const search_index_t *index, const display_table_t *table) {
+	if (index == nullptr || !index->active) return -1;
+	if (table < index->tables || table >= index->tables + index->table_count) return -1;
+	return table - index->tables;
+}
+
+///////////////////////////////////////////
+
+bool search_table_shown(const search_index_t *index, const display_table_t *table) {
+	int64_t id = search_table_id(index, table);
+	return id < 0 || index->table_hits[id] > 0;
+}
+
+///////////////////////////////////////////
+
+bool search_table_named(const search_index_t *index, const display_table_t *table) {
+	int64_t id = search_table_id(index, table);
+	return id < 0 || index->doc_hit[index->table_doc[id]];
+}
+
+///////////////////////////////////////////
+
+bool search_row_hit(const search_index_t *index, const display_table_t *table, size_t row) {
+	int64_t id = search_table_id(index, table);
+	return id < 0 || index->doc_hit[index->table_doc[id] + 1 + row];
+}
+
+///////////////////////////////////////////
+
+static void search_add_doc(search_index_t *index, const char **strings, int32_t count) {
+	index->doc_text.add((uint32_t)index->text.count);
+	for (int32_t i = 0; i < count; i++) {
+		if (strings[i] == nullptr) continue;
+		if (i > 0) index->text.add(search_cell_separator);
+		for (const char *ch = strings[i]; *ch; ch++)
+			index->text.add((char)tolower((unsigned char)*ch));
+	}
+	index->text.add('\0');
+}
+
+///////////////////////////////////////////
+
+static uint32_t search_trigram(const char *at) {
+	return ((uint32_t)(uint8_t)at[0] << 16) | ((uint32_t)(uint8_t)at[1] << 8) | (uint32_t)(uint8_t)at[2];
+}
+
+///////////////////////////////////////////
+
+static size_t search_lower_bound(const array_t<uint64_t> &list, uint64_t value) {
+	size_t l = 0, r = list.count;
+	while (l < r) {
+		size_t mid = (l + r) / 2;
+		if (list[mid] < value) l = mid + 1;
+		else                   r = mid;
+	}
+	return l;
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "openxr_info.h"
+
+// A case-insensitive substring index over a set of display tables. Every
+// table name and every table row becomes one document, and a sorted list
+// of (trigram, document) pairs lets a query jump straight to the few rows
+// that could contain it. Build one of these per set of tables (per runtime
+// snapshot), and rebuild it whenever the tables change.
+
+/*** Types *******************************/
+
+struct search_index_t {
+	const display_table_t *tables;
+	size_t                 table_count;
+
+	array_t<char>          text;       // Lowercase document text, null separated
+	array_t<uint32_t>      doc_text;   // Offset into text for each document
+	array_t<uint32_t>      table_doc;  // First document of each table, which is its name
+	array_t<uint64_t>      trigrams;   // Sorted (trigram << 32 | document) pairs
+
+	// Results of the last search_query
+	bool                   active;
+	array_t<uint8_t>       doc_hit;
+	array_t<int32_t>       table_hits;
+	int32_t                hit_count;
+	float                  query_ms;
+};
+
+/*** Signatures **************************/
+
+void search_build       (search_index_t *index, const display_table_t *tables, size_t table_count);
+void search_free        (search_index_t *index);
+void search_query       (search_index_t *index, const char *query);
+
+// These take a pointer into the indexed tables, and treat an inactive
+// query (or a table that isn't part of the index) as a match.
+bool search_table_shown (const search_index_t *index, const display_table_t *table);
+bool search_table_named (const search_index_t *index, const display_table_t *table);
+bool search_row_hit     (const search_index_t *index, const display_table_t *table, size_t row);
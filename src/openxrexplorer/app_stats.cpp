@@ -0,0 +1,46 @@
+#include "app_stats.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+/*** Code ********************************/
+
+stats_t stats_summary(const float *samples, int32_t count) {
+	stats_t result = {};
+	result.count = count;
+	if (count == 0) return result;
+
+	float *sorted = (float*)malloc(sizeof(float) * count);
+	memcpy(sorted, samples, sizeof(float) * count);
+	qsort(sorted, count, sizeof(float), stats_float_cmp);
+
+	result.min    = sorted[0];
+	result.median = count % 2 ? sorted[count / 2] : (sorted[count / 2 - 1] + sorted[count / 2]) * 0.5f;
+	result.p95    = stats_percentile(sorted, count, 0.95f);
+	free(sorted);
+	return result;
+}
+
+///////////////////////////////////////////
+
+float stats_percentile(const float *sorted, int32_t count, float fraction) {
+	if (count <= 0) return 0;
+
+	// 0.99f is a hair over 0.99, which would push a p99 of 100 samples
+	// onto the worst one, so the fraction is rounded back to what was
+	// meant before the rank is taken.
+	double  exact = floor(fraction * 1000000.0 + 0.5) / 1000000.0;
+	int32_t rank  = (int32_t)ceil(exact * count - 0.000001) - 1;
+	if (rank < 0)      rank = 0;
+	if (rank >= count) rank = count - 1;
+	return sorted[rank];
+}
+
+///////////////////////////////////////////
+
+int stats_float_cmp(const void *a, const void *b) {
+	float fa = *(const float *)a;
+	float fb = *(const float *)b;
+	return (fa > fb) - (fa < fb);
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <stdint.h>
+
+// Summaries of timing samples, shared by the benchmarks and measurements.
+// Percentiles are nearest-rank throughout, so a p99 is always one of the
+// samples, and with few samples it's simply the slowest one.
+
+/*** Types *******************************/
+
+struct stats_t {
+	int32_t count;
+	float   min;
+	float   median;
+	float   p95;
+};
+
+/*** Signatures **************************/
+
+// samples is left as-is, the summary sorts a copy
+stats_t stats_summary   (const float *samples, int32_t count);
+// sorted must be ascending, sort with stats_float_cmp. fraction is 0-1.
+float   stats_percentile(const float *sorted, int32_t count, float fraction);
+// qsort comparison for float
+int     stats_float_cmp (const void *a, const void *b);
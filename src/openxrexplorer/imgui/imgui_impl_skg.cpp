@@ -3,6 +3,7 @@
 
 #define SKG_IMPL
 #include "sk_gpu.h"
+#include "sokol_time.h"
 
 int32_t      im_vb_size = 0;
 skg_vert_t  *im_vb_data = nullptr;
@@ -17,10 +18,47 @@ skg_buffer_t   im_shader_vars = {};
 skg_shader_t   im_shader      = {};
 skg_pipeline_t im_pipeline    = {};
 
+bool           im_profiling   = false;
+float          im_upload_ms   = 0;
+
 struct VERTEX_CONSTANT_BUFFER {
 	float mvp[4][4];
 };
 
+#if defined(SKG_OPENGL)
+#ifndef GL_TEXTURE_SWIZZLE_R
+#define GL_TEXTURE_SWIZZLE_R 0x8E42
+#define GL_TEXTURE_SWIZZLE_G 0x8E43
+#define GL_TEXTURE_SWIZZLE_B 0x8E44
+#define GL_TEXTURE_SWIZZLE_A 0x8E45
+#endif
+#endif
+
+// The font atlas only carries coverage, so on GL we upload it as a single
+// channel texture and let the sampler swizzle it out to (1,1,1,a). The
+// precompiled D3D shader has no equivalent, so it still gets RGBA32 there.
+static void ImGui_ImplSkg_CreateFontTexture() {
+	ImGuiIO& io = ImGui::GetIO();
+	void*    pixels;
+	int      width, height;
+#if defined(SKG_OPENGL)
+	io.Fonts->GetTexDataAsAlpha8((unsigned char **)&pixels, &width, &height);
+	im_font_tex = skg_tex_create(skg_tex_type_image, skg_use_static, skg_tex_fmt_r8, skg_mip_none);
+	skg_tex_set_contents(&im_font_tex, pixels, width, height);
+
+	glBindTexture  (im_font_tex._target, im_font_tex._texture);
+	glTexParameteri(im_font_tex._target, GL_TEXTURE_SWIZZLE_R, GL_ONE);
+	glTexParameteri(im_font_tex._target, GL_TEXTURE_SWIZZLE_G, GL_ONE);
+	glTexParameteri(im_font_tex._target, GL_TEXTURE_SWIZZLE_B, GL_ONE);
+	glTexParameteri(im_font_tex._target, GL_TEXTURE_SWIZZLE_A, GL_RED);
+#else
+	io.Fonts->GetTexDataAsRGBA32((unsigned char **)&pixels, &width, &height);
+	im_font_tex = skg_tex_create(skg_tex_type_image, skg_use_static, skg_tex_fmt_rgba32_linear, skg_mip_none);
+	skg_tex_set_contents(&im_font_tex, pixels, width, height);
+#endif
+	io.Fonts->TexID = (ImTextureID)&im_font_tex;
+}
+
 // Render function
 void ImGui_ImplSkg_RenderDrawData(ImDrawData* draw_data) {
 	// Avoid rendering when minimized
@@ -47,6 +85,7 @@ void ImGui_ImplSkg_RenderDrawData(ImDrawData* draw_data) {
 	}
 
 	// Upload vertex/index data into a single contiguous GPU buffer
+	uint64_t    upload_start = im_profiling ? stm_now() : 0;
 	skg_vert_t* vtx_dst = im_vb_data;
 	uint32_t*   idx_dst = im_ib_data;
 	for (int n = 0; n < draw_data->CmdListsCount; n++) {
@@ -70,6 +109,8 @@ void ImGui_ImplSkg_RenderDrawData(ImDrawData* draw_data) {
 	}
 	skg_buffer_set_contents(&im_vb, im_vb_data, (vtx_dst - im_vb_data) * sizeof(skg_vert_t));
 	skg_buffer_set_contents(&im_ib, im_ib_data, (idx_dst - im_ib_data) * sizeof(uint32_t  ));
+	if (im_profiling)
+		im_upload_ms = (float)stm_ms(stm_since(upload_start));
 
 	// Setup orthographic projection matrix into our constant buffer
 	// Our visible imgui space lies from draw_data->DisplayPos (top left) to draw_data->DisplayPos+data_data->DisplaySize (bottom right). DisplayPos is (0,0) for single viewport apps.
@@ -135,15 +176,7 @@ bool ImGui_ImplSkg_Init() {
 	skg_pipeline_set_scissor     (&im_pipeline, true);
 
 	// Build texture atlas
-	ImGuiIO& io = ImGui::GetIO();
-	void*    pixels;
-	int      width, height;
-	io.Fonts->GetTexDataAsRGBA32((unsigned char **)&pixels, &width, &height);
-
-	im_font_tex = skg_tex_create(skg_tex_type_image, skg_use_static, skg_tex_fmt_rgba32_linear, skg_mip_none);
-	skg_tex_set_contents(&im_font_tex, pixels, width, height);
-
-	io.Fonts->TexID = (ImTextureID)&im_font_tex;
+	ImGui_ImplSkg_CreateFontTexture();
 	return true;
 }
 
@@ -161,14 +194,15 @@ void ImGui_ImplSkg_Shutdown() {
 void ImGui_ImplSkg_NewFrame() {
 	ImGuiIO& io = ImGui::GetIO();
 	if (!io.Fonts->IsBuilt()) {
-		void*    pixels;
-		int      width, height;
-		io.Fonts->GetTexDataAsRGBA32((unsigned char **)&pixels, &width, &height);
-
 		if (skg_tex_is_valid(&im_font_tex))
 			skg_tex_destroy(&im_font_tex);
-		im_font_tex = skg_tex_create(skg_tex_type_image, skg_use_static, skg_tex_fmt_rgba32_linear, skg_mip_none);
-		skg_tex_set_contents(&im_font_tex, pixels, width, height);
-		io.Fonts->TexID = (ImTextureID)&im_font_tex;
+		ImGui_ImplSkg_CreateFontTexture();
 	}
-}
\ No newline at end of file
+}
+void ImGui_ImplSkg_SetProfiling(bool enabled) {
+	im_profiling = enabled;
+}
+
+float ImGui_ImplSkg_UploadMs() {
+	return im_upload_ms;
+}
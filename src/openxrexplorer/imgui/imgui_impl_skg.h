@@ -3,4 +3,7 @@
 IMGUI_IMPL_API bool     ImGui_ImplSkg_Init();
 IMGUI_IMPL_API void     ImGui_ImplSkg_Shutdown      ();
 IMGUI_IMPL_API void     ImGui_ImplSkg_RenderDrawData(ImDrawData* draw_data);
-IMGUI_IMPL_API void     ImGui_ImplSkg_NewFrame      ();
\ No newline at end of file
+IMGUI_IMPL_API void     ImGui_ImplSkg_NewFrame      ();
+// Time spent on the last vertex/index upload, only measured while enabled
+IMGUI_IMPL_API void     ImGui_ImplSkg_SetProfiling  (bool enabled);
+IMGUI_IMPL_API float    ImGui_ImplSkg_UploadMs      ();
@@ -2,12 +2,20 @@
 #include "app_cli.h"
 #include "imgui/imgui_internal.h"
 #include "xrruntime.h"
+#include "xrpreflight.h"
 #include "openxr_info.h"
+#include "app_perf.h"
+#include "app_search.h"
+#include "app_compare.h"
+#include "imgui/sokol_time.h"
 
 #include <stdint.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <atomic>
+#include <thread>
 
 /*** Global Variables ********************/
 
@@ -18,27 +26,166 @@ xr_settings_t app_xr_settings = {};
 runtime_t *runtimes      = nullptr;
 int32_t    runtime_count = 0;
 
+struct startup_phase_t {
+	const char *name;
+	uint64_t    start;
+	uint64_t    end;
+};
+startup_phase_t startup_phases[startup_phase_max] = {
+	{ "load_runtimes"       },
+	{ "openxr_info_reload"  },
+	{ "shell_create_window" },
+	{ "app_init"            },
+	{ "join workers"        },
+	{ "first frame"         },
+};
+bool        startup_profile = false;
+bool        startup_joined  = false;
+std::thread startup_thread_runtimes;
+std::thread startup_thread_probe;
+
+// One preflight run. The thread owns list and results until done is set.
+// A run that's replaced while still going is retired rather than joined,
+// so "Reload list" never waits on a slow runtime.
+struct preflight_job_t {
+	std::thread         thread;
+	runtime_t          *list;
+	preflight_result_t *results; // Parallel to runtimes, only valid once done
+	int32_t             count;
+	std::atomic<bool>   done;
+	preflight_job_t    *next;    // Next retired job
+};
+preflight_job_t *app_preflight         = nullptr;
+preflight_job_t *app_preflight_retired = nullptr;
+
+// Manifest this process is probing through XR_RUNTIME_JSON, empty when
+// probing whatever runtime is active system-wide.
+char  app_probe_file[1024]  = "";
+char *app_probe_env_prev    = nullptr; // XR_RUNTIME_JSON as we were launched
+bool  app_probe_env_saved   = false;
+
+bool app_show_perf    = false;
+bool app_show_compare = false;
+
+search_index_t app_search              = {};
+char           app_search_text[128]    = "";
+bool           app_search_changed      = false;
+
 /*** Signatures **************************/
 
 void app_window_openxr_functionality();
 void app_window_runtime();
 void app_window_view();
 void app_window_misc();
+void app_window_footprint();
 void app_element_table(const display_table_t *table);
+void app_search_bar   ();
+void app_reload       ();
+void app_preflight_start();
+void app_preflight_reap (bool wait);
 
 void app_set_runtime   (int32_t runtime_index);
+void app_probe_override(const char *manifest_file);
+int32_t app_probe_index();
 void app_open_link     (const char *link);
 void app_open_spec     (const char *spec_item_name);
+int32_t strcmp_nocase  (char const *a, char const *b);
 
 /*** Code ********************************/
 
 bool app_args(int32_t arg_count, const char **args) {
-	if (arg_count > 1) {
-		app_cli(arg_count, args);
-		return false;
+#if !defined(_WIN32)
+	// runtime_preflight starts us like this, it never returns
+	if (arg_count == 4 && strcmp(args[1], "-preflightWorker") == 0)
+		runtime_preflight_worker(args[2], args[3]);
+#endif
+
+	// Strip out GUI-only flags, anything left over is a CLI command
+	const char **cli_args      = (const char **)malloc(sizeof(const char *) * arg_count);
+	int32_t      cli_count     = 0;
+	int32_t      cli_modifiers = 0;
+	for (int32_t i = 0; i < arg_count; i++) {
+		const char *curr = args[i];
+		while (*curr == '-' || *curr == '/') curr++;
+		if      (i > 0 && strcmp_nocase(curr, "startupProfile") == 0) startup_profile = true;
+		else if (i > 0 && strcmp_nocase(curr, "perfHud"       ) == 0) app_show_perf   = true;
+		else if (i > 0 && (strcmp_nocase(curr, "prefetch") == 0 || strncmp(curr, "prefetch=", 9) == 0)) {
+			// Applies to both, so it's passed along without being a command
+			app_xr_settings.prefetch = strcmp_nocase(curr, "prefetch=all") == 0 ? xr_prefetch_all : xr_prefetch_active;
+			cli_args[cli_count++] = args[i];
+			cli_modifiers += 1;
+		}
+		else cli_args[cli_count++] = args[i];
 	}
 
-	return true;
+	bool result = true;
+	if (cli_count - cli_modifiers > 1) {
+		app_cli(cli_count, cli_args);
+		result = false;
+	}
+	free(cli_args);
+	return result;
+}
+
+///////////////////////////////////////////
+
+void app_startup_begin() {
+	app_xr_settings.allow_session = false;
+	app_xr_settings.form          = XR_FORM_FACTOR_HEAD_MOUNTED_DISPLAY;
+
+	// Manifest scanning and the first probe don't need the window or the
+	// GPU, so they run while the shell is busy creating those.
+	startup_thread_runtimes = std::thread([]() {
+		app_startup_phase(startup_phase_runtimes, true);
+		load_runtimes(runtime_config_path(), &runtimes, &runtime_count);
+		app_startup_phase(startup_phase_runtimes, false);
+	});
+	startup_thread_probe = std::thread([]() {
+		app_startup_phase(startup_phase_probe, true);
+		openxr_info_reload(app_xr_settings);
+		app_startup_phase(startup_phase_probe, false);
+	});
+}
+
+///////////////////////////////////////////
+
+void app_startup_join() {
+	if (startup_joined) return;
+
+	app_startup_phase(startup_phase_join, true);
+	if (startup_thread_runtimes.joinable()) startup_thread_runtimes.join();
+	if (startup_thread_probe   .joinable()) startup_thread_probe   .join();
+	app_startup_phase(startup_phase_join, false);
+	startup_joined = true;
+
+	search_build(&app_search, xr_tables.data, xr_tables.count);
+	app_preflight_start();
+}
+
+///////////////////////////////////////////
+
+void app_startup_phase(startup_phase_ phase, bool begin) {
+	if (begin) startup_phases[phase].start = stm_now();
+	else       startup_phases[phase].end   = stm_now();
+}
+
+///////////////////////////////////////////
+
+void app_frame_presented() {
+	static bool first = true;
+	if (!first) return;
+	first = false;
+
+	app_startup_phase(startup_phase_first_frame, false);
+	if (!startup_profile) return;
+
+	printf("Startup timeline (ms since launch):\n");
+	printf("| %-20s | %9s | %9s | %9s |\n", "phase", "start", "end", "duration");
+	for (int32_t i = 0; i < startup_phase_max; i++) {
+		const startup_phase_t *p = &startup_phases[i];
+		printf("| %-20s | %9.2f | %9.2f | %9.2f |\n", p->name, stm_ms(p->start), stm_ms(p->end), stm_ms(p->end - p->start));
+	}
+	printf("Time to first frame: %.2fms\n", stm_ms(startup_phases[startup_phase_first_frame].end));
 }
 
 ///////////////////////////////////////////
@@ -75,25 +222,32 @@ bool app_init() {
 	colors[ImGuiCol_TitleBg]       = colors[ImGuiCol_TitleBgActive]     = barelysat;
 	colors[ImGuiCol_TableRowBgAlt] = barely;
 	colors[ImGuiCol_TabUnfocusedActive] = colors[ImGuiCol_Separator] = midsat;
- 
-	load_runtimes(runtime_config_path(), &runtimes, &runtime_count);
 
-	app_xr_settings.allow_session = false;
-	app_xr_settings.form          = XR_FORM_FACTOR_HEAD_MOUNTED_DISPLAY;
-	openxr_info_reload(app_xr_settings);
-	
 	return true;
 }
 
 ///////////////////////////////////////////
 
 void app_shutdown() {
+	app_startup_join();
+	if (app_preflight) {
+		app_preflight->next   = app_preflight_retired;
+		app_preflight_retired = app_preflight;
+		app_preflight         = nullptr;
+	}
+	app_preflight_reap(true);
+	compare_shutdown();
+	search_free(&app_search);
 	openxr_info_release();
 }
 
 ///////////////////////////////////////////
 
 void app_step(ImVec2 canvas_size) {
+	app_startup_join();
+
+	app_search_bar();
+
 	ImGuiID dockspace_id = ImGui::DockSpaceOverViewport(0, NULL, ImGuiDockNodeFlags_PassthruCentralNode, NULL);
 	if (!ImGui::DockBuilderGetNode(dockspace_id)->IsSplitNode()) {
 		ImGuiID dock_id_left;
@@ -115,14 +269,90 @@ void app_step(ImVec2 canvas_size) {
 	app_window_runtime();
 	app_window_view();
 	app_window_misc();
+	app_window_footprint();
+	perf_window(&app_show_perf);
+	compare_window(&app_show_compare, runtimes, runtime_count, app_xr_settings);
 	//ImGui::ShowDemoWindow();
+
+	app_search_changed = false;
 }
 
 ///////////////////////////////////////////
 
-void app_window_runtime() {
-	static int32_t current_runtime = -1;
+void app_search_bar() {
+	if (!ImGui::BeginMainMenuBar()) return;
+
+	if (ImGui::IsKeyChordPressed(ImGuiMod_Ctrl | ImGuiKey_F))
+		ImGui::SetKeyboardFocusHere();
+	ImGui::SetNextItemWidth(300 * app_scale);
+	if (ImGui::InputTextWithHint("##Search", "Search all tables (Ctrl+F)", app_search_text, sizeof(app_search_text))) {
+		search_query  (&app_search, app_search_text);
+		compare_search(app_search_text);
+		app_search_changed = true;
+	}
+	if (app_search.active) {
+		ImGui::TextDisabled("%d matches (%.3fms)", app_search.hit_count, app_search.query_ms);
+	}
+
+	ImGui::EndMainMenuBar();
+}
+
+///////////////////////////////////////////
+
+void app_reload() {
+	openxr_info_reload(app_xr_settings);
+	search_build(&app_search, xr_tables.data, xr_tables.count);
+	search_query(&app_search, app_search_text);
+	app_search_changed = true;
+}
+
+///////////////////////////////////////////
+
+void app_preflight_start() {
+	if (app_preflight) {
+		app_preflight->next   = app_preflight_retired;
+		app_preflight_retired = app_preflight;
+		app_preflight         = nullptr;
+	}
+	app_preflight_reap(false);
+	if (runtime_count == 0) return;
+
+	// The job gets its own copy of the list, so "Reload list" can replace
+	// runtimes while it's still going.
+	preflight_job_t *job = new preflight_job_t();
+	job->count   = runtime_count;
+	job->list    = (runtime_t          *)malloc(sizeof(runtime_t)          * job->count);
+	job->results = (preflight_result_t *)malloc(sizeof(preflight_result_t) * job->count);
+	memcpy(job->list, runtimes, sizeof(runtime_t) * job->count);
+	job->thread = std::thread([job]() {
+		runtime_preflight(job->list, job->count, 5000, job->results);
+		job->done.store(true);
+	});
+	app_preflight = job;
+}
+
+///////////////////////////////////////////
+
+void app_preflight_reap(bool wait) {
+	// Only joins jobs that are already finished, unless asked to wait
+	preflight_job_t **link = &app_preflight_retired;
+	while (*link) {
+		preflight_job_t *job = *link;
+		if (!wait && !job->done.load()) {
+			link = &job->next;
+			continue;
+		}
+		job->thread.join();
+		*link = job->next;
+		free(job->list);
+		free(job->results);
+		delete job;
+	}
+}
 
+///////////////////////////////////////////
+
+void app_window_runtime() {
 	ImGui::Begin("Runtime Information");
 
 	ImGui::Text("OpenXR Loader v%d.%d.%d", 
@@ -135,29 +365,81 @@ void app_window_runtime() {
 	ImGui::Spacing();
 
 	ImGui::Text("%s", xr_runtime_name);
+	if (app_probe_file[0]) {
+		ImGui::SameLine();
+		ImGui::TextDisabled("(this process only, via XR_RUNTIME_JSON)");
+	}
 
-	// Runtime picker
+	// Runtime picker. Picking one only points this process at it, the
+	// system-wide switch needs elevation and is its own button below.
+	int32_t probe_index = app_probe_index();
+	const char *preview =
+		probe_index >= 0  ? runtimes[probe_index].name :
+		app_probe_file[0] ? app_probe_file :
+		"Active runtime";
 	ImGui::PushItemWidth(-1);
-	if (ImGui::BeginCombo("##Change Runtime", current_runtime == -1 ? "Change Runtime" : runtimes[current_runtime].name)) {
+	if (ImGui::BeginCombo("##Probe Runtime", preview)) {
+		if (ImGui::Selectable("Active runtime", app_probe_file[0] == '\0') && app_probe_file[0] != '\0') {
+			app_probe_override(nullptr);
+			app_reload();
+		}
+		if (ImGui::IsItemHovered())
+			ImGui::SetTooltip("Whichever runtime is active system-wide");
+
+		app_preflight_reap(false);
+		bool preflight_ready = app_preflight && app_preflight->done.load();
 		for (int n = 0; n < runtime_count; n++) {
 			if (!runtimes[n].present) continue;
 
-			bool is_selected = (current_runtime == n);
-			if (ImGui::Selectable(runtimes[n].name, is_selected) && current_runtime != n) {
-				current_runtime = n;
-				app_set_runtime(current_runtime);
+			// Broken runtimes stay selectable, but are greyed out and say why
+			const preflight_result_t *preflight = preflight_ready ? &app_preflight->results[n] : nullptr;
+			bool broken = preflight && preflight->status != preflight_ok;
+			char label[128];
+			if (broken) snprintf(label, sizeof(label), "%s (%s)##%d", runtimes[n].name, preflight_status_str(preflight->status), n);
+			else        snprintf(label, sizeof(label), "%s##%d",      runtimes[n].name, n);
+
+			bool is_selected = (probe_index == n);
+			if (broken) ImGui::PushStyleColor(ImGuiCol_Text, ImGui::GetStyleColorVec4(ImGuiCol_TextDisabled));
+			bool clicked = ImGui::Selectable(label, is_selected);
+			if (broken) ImGui::PopStyleColor();
+			if (preflight && ImGui::IsItemHovered()) {
+				if (broken) ImGui::SetTooltip("%s", preflight->reason);
+				else        ImGui::SetTooltip("Loaded in %.1f ms, %+.1f MB\n%s", preflight->load_ms, preflight->rss_delta / (1024.0f * 1024.0f), preflight->library);
+			}
+			if (clicked && !is_selected) {
+				app_probe_override(runtimes[n].file);
+				app_reload();
 			}
 			if (is_selected)
 				ImGui::SetItemDefaultFocus();
 		}
 		ImGui::EndCombo();
 	}
-	
+	ImGui::PopItemWidth();
+
+	ImGui::BeginDisabled(probe_index < 0);
+	if (ImGui::Button("Make active system-wide")) {
+		// Drop the override first, or we'd keep probing the same runtime
+		// and never see the switch take effect.
+		app_probe_override(nullptr);
+		app_set_runtime(probe_index);
+	}
+	ImGui::EndDisabled();
+	if (ImGui::IsItemHovered(ImGuiHoveredFlags_AllowWhenDisabled))
+		ImGui::SetTooltip("Switches the active runtime for every app, this asks for admin rights");
+
 	if (ImGui::Button("Reload runtime data")) {
-		openxr_info_reload(app_xr_settings);
+		app_reload();
 	}
 	ImGui::SameLine();
 	ImGui::Checkbox("Create XrSession", &app_xr_settings.allow_session);
+	ImGui::SameLine();
+	ImGui::Checkbox("Perf HUD", &app_show_perf);
+	ImGui::SameLine();
+	if (ImGui::Checkbox("Footprint", &app_xr_settings.footprint))
+		app_reload();
+	if (ImGui::IsItemHovered())
+		ImGui::SetTooltip("Measure the memory, threads and libraries the runtime adds to this process");
 
 	ImGui::Spacing();
 	ImGui::Separator();
@@ -176,7 +458,11 @@ void app_window_runtime() {
 		free(runtimes);
 		runtime_count = 0;
 		load_runtimes(runtime_config_path(), &runtimes, &runtime_count);
-		current_runtime = -1;
+		app_preflight_start();
+	}
+	ImGui::SameLine();
+	if (ImGui::Button("Compare runtimes")) {
+		app_show_compare = true;
 	}
 
 	ImGui::Spacing();
@@ -231,7 +517,7 @@ void app_window_view() {
 			bool is_selected = (app_xr_settings.view_config == xr_view.available_configs[n]);
 			if (ImGui::Selectable(xr_view.available_config_names[n], is_selected)) {
 				app_xr_settings.view_config = xr_view.available_configs[n];
-				openxr_info_reload(app_xr_settings);
+				app_reload();
 			}
 			if (is_selected)
 				ImGui::SetItemDefaultFocus();
@@ -264,9 +550,32 @@ void app_window_misc() {
 
 ///////////////////////////////////////////
 
+void app_window_footprint() {
+	if (!app_xr_settings.footprint) return;
+
+	ImGui::Begin("Runtime Footprint", &app_xr_settings.footprint);
+
+	for (size_t i = 0; i < xr_tables.count; i++) {
+		if (xr_tables[i].tag == display_tag_footprint)
+			app_element_table(&xr_tables[i]);
+	}
+
+	ImGui::End();
+}
+
+///////////////////////////////////////////
+
 void app_element_table(const display_table_t *table) {
 	const float  text_col = 0.7f;
 	const ImVec4 text_vec = ImVec4{ text_col,text_col,text_col,1 };
+	const ImVec4 hit_vec  = ImVec4{ 1.0f, 0.85f, 0.4f, 1 };
+
+	// While searching, hide tables without a match, and only show the
+	// matching rows unless the table's own name matched.
+	if (!search_table_shown(&app_search, table)) return;
+	bool filter_rows = app_search.active && !search_table_named(&app_search, table);
+	if (app_search.active && app_search_changed)
+		ImGui::SetNextItemOpen(true);
 
 	ImGui::PushID(table->show_type ? table->name_type : table->name_func);
 
@@ -309,6 +618,9 @@ void app_element_table(const display_table_t *table) {
 
 			ImGui::PushID("Table Rows");
 			for (size_t i = table->header_row?1:0; i < table->cols[0].count; i++) {
+				bool hit = app_search.active && search_row_hit(&app_search, table, i);
+				if (filter_rows && !hit) continue;
+
 				ImGui::TableNextRow();
 				for (size_t c = 0; c < table->column_count; c++) {
 					ImGui::TableNextColumn(); 
@@ -319,6 +631,8 @@ void app_element_table(const display_table_t *table) {
 							app_open_spec(table->cols[c][i].spec);
 						ImGui::PushStyleColor(ImGuiCol_Text, text_vec);
 						ImGui::PopID();
+					} else if (hit) {
+						ImGui::TextColored(hit_vec, "%s", table->cols[c][i].text);
 					} else {
 						ImGui::Text("%s", table->cols[c][i].text);
 					}
@@ -353,8 +667,10 @@ void app_element_table(const display_table_t *table) {
 #include <windows.h>
 #include <shellapi.h>
 void app_set_runtime(int32_t runtime_index) {
-	char command[1024];
-	snprintf(command, sizeof(command), " \"-%s\"", runtimes[runtime_index].name);
+	// By manifest path rather than name, so xrsetruntime doesn't have to
+	// find the runtime again on its own. Paths can't contain quotes.
+	char command[1100];
+	snprintf(command, sizeof(command), " \"-%s\"", runtimes[runtime_index].file);
 
 	SHELLEXECUTEINFO info = {0};
 	info.cbSize       = sizeof(SHELLEXECUTEINFO);
@@ -372,32 +688,83 @@ void app_set_runtime(int32_t runtime_index) {
 		WaitForSingleObject(info.hProcess, INFINITE);
 		CloseHandle(info.hProcess);
 
-		openxr_info_reload(app_xr_settings);
+		app_reload();
 	}
 }
 
 #elif defined(__linux__)
 #include <unistd.h>
 #include <libgen.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <errno.h>
+
+extern char **environ;
 
 void app_set_runtime(int32_t runtime_index) {
 	// Get the path of this exe, xrsetruntime should be next to it
-	char path   [1024];
-	char command[1124];
-	if (readlink ("/proc/self/exe", path, sizeof(path)) != -1) {
-		dirname(path);
-		snprintf(command, sizeof(command), "sudo %s/xrsetruntime -%s", path, runtimes[runtime_index].name);
-	} else {
-		snprintf(command, sizeof(command), "sudo xrsetruntime -%s", runtimes[runtime_index].name);
+	char path[1024];
+	char exe [1100] = "xrsetruntime";
+	ssize_t length = readlink("/proc/self/exe", path, sizeof(path) - 1);
+	if (length != -1) {
+		path[length] = '\0';
+		snprintf(exe, sizeof(exe), "%s/xrsetruntime", dirname(path));
 	}
-	system(command);
-	openxr_info_reload(app_xr_settings);
+
+	// By manifest path rather than name: under sudo, xrsetruntime can't
+	// always find the runtimes in the user's own folders. Passed as its
+	// own argument with no shell in between, since the path comes from
+	// wherever the manifest was found.
+	char flag[1100];
+	snprintf(flag, sizeof(flag), "-%s", runtimes[runtime_index].file);
+	const char *argv[] = { "sudo", exe, flag, nullptr };
+
+	pid_t pid;
+	if (posix_spawnp(&pid, "sudo", nullptr, nullptr, (char *const *)argv, environ) != 0) {
+		printf("Failed to execute set-runtime command!\n");
+		return;
+	}
+	int status;
+	while (waitpid(pid, &status, 0) < 0 && errno == EINTR);
+	app_reload();
 }
 
 #endif
 
 ///////////////////////////////////////////
 
+void app_probe_override(const char *manifest_file) {
+	// Remember what we were launched with, so going back to the active
+	// runtime restores that rather than clearing it.
+	if (!app_probe_env_saved) {
+		const char *prev = getenv("XR_RUNTIME_JSON");
+		if (prev) {
+			app_probe_env_prev = (char*)malloc(strlen(prev) + 1);
+			strcpy(app_probe_env_prev, prev);
+		}
+		app_probe_env_saved = true;
+	}
+
+	// The loader reads this each time it loads a runtime, so the next
+	// xrCreateInstance in this process picks it up. Preflight and compare
+	// threads may be handing environ to a child right now, runtime_env_set
+	// waits until they're done with it.
+	runtime_env_set("XR_RUNTIME_JSON", manifest_file ? manifest_file : app_probe_env_prev);
+	snprintf(app_probe_file, sizeof(app_probe_file), "%s", manifest_file ? manifest_file : "");
+}
+
+///////////////////////////////////////////
+
+int32_t app_probe_index() {
+	if (app_probe_file[0] == '\0') return -1;
+	for (int32_t i = 0; i < runtime_count; i++) {
+		if (strcmp(runtimes[i].file, app_probe_file) == 0) return i;
+	}
+	return -1;
+}
+
+///////////////////////////////////////////
+
 void app_open_link(const char *link) {
 #if defined(_WIN32)
 	char buffer[1024];
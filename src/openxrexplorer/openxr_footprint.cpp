@@ -0,0 +1,503 @@
+#include "openxr_footprint.h"
+#include "openxr_info.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__linux__)
+#include <dirent.h>
+#include <sched.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+/*** Types *******************************/
+
+struct footprint_thread_t {
+	int32_t tid;
+	char    name    [32];
+	char    policy  [32];
+	char    affinity[64];
+};
+
+struct footprint_sample_t {
+	bool                        taken;
+	int64_t                     rss_kb;
+	int64_t                     anon_kb;
+	array_t<footprint_thread_t> threads;
+	array_t<char *>             libraries; // Sorted, unique
+};
+
+struct footprint_idle_thread_t {
+	int32_t  tid;
+	char     name[32];
+	bool     runtime;     // Started after the runtime was opened
+	uint64_t ticks_first;
+	uint64_t ticks_prev;
+	uint64_t wakeups_first;
+	uint64_t wakeups_last;
+	float    peak_pct;
+};
+
+/*** Global Variables ********************/
+
+footprint_sample_t footprint_samples[footprint_step_max] = {};
+
+const char *footprint_step_names[footprint_step_max] = {
+	"Start",
+	"xrCreateInstance",
+	"xrGetSystem",
+	"xrCreateSession",
+};
+
+/*** Signatures **************************/
+
+#if defined(__linux__)
+static void footprint_read_status   (footprint_sample_t *sample);
+static void footprint_read_threads  (footprint_sample_t *sample);
+static void footprint_read_libraries(footprint_sample_t *sample);
+static bool footprint_read_task     (int32_t tid, char *out_name, size_t name_size, uint64_t *out_ticks, uint64_t *out_wakeups);
+static void footprint_idle_sample   (array_t<footprint_idle_thread_t> *threads, const array_t<int32_t> *baseline, float interval_s);
+#endif
+static bool footprint_has_thread (const footprint_sample_t *sample, int32_t tid);
+static bool footprint_has_library(const footprint_sample_t *sample, const char *library);
+static int  footprint_str_cmp    (const void *a, const void *b);
+
+/*** Code ********************************/
+
+void footprint_clear() {
+	for (int32_t i = 0; i < footprint_step_max; i++) {
+		footprint_samples[i].threads.free();
+		footprint_samples[i].libraries.each(free);
+		footprint_samples[i].libraries.free();
+		footprint_samples[i] = {};
+	}
+}
+
+///////////////////////////////////////////
+
+void footprint_sample(footprint_step_ step) {
+	footprint_sample_t *sample = &footprint_samples[step];
+	sample->threads.clear();
+	sample->libraries.each(free);
+	sample->libraries.clear();
+#if defined(__linux__)
+	footprint_read_status   (sample);
+	footprint_read_threads  (sample);
+	footprint_read_libraries(sample);
+	sample->taken = true;
+#endif
+}
+
+///////////////////////////////////////////
+
+void footprint_tables() {
+	display_table_t memory    = {};
+	display_table_t threads   = {};
+	display_table_t libraries = {};
+	memory   .name_func = "Footprint: memory";     memory   .name_type = "footprintMemory";
+	threads  .name_func = "Footprint: threads";    threads  .name_type = "footprintThreads";
+	libraries.name_func = "Footprint: libraries";  libraries.name_type = "footprintLibraries";
+	memory   .tag = threads.tag = libraries.tag = display_tag_footprint;
+	memory   .header_row = threads.header_row = libraries.header_row = true;
+	memory   .column_count = 3;
+	threads  .column_count = 3;
+	libraries.column_count = 2;
+
+#if !defined(__linux__)
+	memory.error = threads.error = libraries.error = "Only available on Linux";
+#else
+	const footprint_sample_t *start = &footprint_samples[footprint_step_start];
+	if (!start->taken) {
+		memory.error = threads.error = libraries.error = "No samples were taken";
+	} else {
+		memory.cols[0].add({ "Step" });
+		memory.cols[1].add({ "RSS" });
+		memory.cols[2].add({ "Anonymous" });
+		threads.cols[0].add({ "New thread (started by)" });
+		threads.cols[1].add({ "Policy" });
+		threads.cols[2].add({ "Affinity" });
+		libraries.cols[0].add({ "New library" });
+		libraries.cols[1].add({ "Loaded by" });
+
+		const footprint_sample_t *prev = start;
+		for (int32_t step = footprint_step_start + 1; step < footprint_step_max; step++) {
+			const footprint_sample_t *curr = &footprint_samples[step];
+			if (!curr->taken) continue;
+
+			memory.cols[0].add({ footprint_step_names[step] });
+			memory.cols[1].add({ new_string("%+.2f MB (%.2f MB)", (curr->rss_kb  - prev->rss_kb ) / 1024.0, curr->rss_kb  / 1024.0) });
+			memory.cols[2].add({ new_string("%+.2f MB (%.2f MB)", (curr->anon_kb - prev->anon_kb) / 1024.0, curr->anon_kb / 1024.0) });
+
+			// Compared against the start rather than the previous step, so a
+			// thread or library that's still around is only listed once.
+			for (size_t t = 0; t < curr->threads.count; t++) {
+				const footprint_thread_t *thread = &curr->threads[t];
+				bool seen = footprint_has_thread(start, thread->tid);
+				for (int32_t s = footprint_step_start + 1; s < step && !seen; s++)
+					seen = footprint_has_thread(&footprint_samples[s], thread->tid);
+				if (seen) continue;
+
+				threads.cols[0].add({ new_string("%s [%d] (%s)", thread->name, thread->tid, footprint_step_names[step]) });
+				threads.cols[1].add({ new_string("%s", thread->policy) });
+				threads.cols[2].add({ new_string("%s", thread->affinity) });
+			}
+			for (size_t l = 0; l < curr->libraries.count; l++) {
+				const char *library = curr->libraries[l];
+				bool seen = footprint_has_library(start, library);
+				for (int32_t s = footprint_step_start + 1; s < step && !seen; s++)
+					seen = footprint_has_library(&footprint_samples[s], library);
+				if (seen) continue;
+
+				libraries.cols[0].add({ new_string("%s", library) });
+				libraries.cols[1].add({ footprint_step_names[step] });
+			}
+			prev = curr;
+		}
+		memory.cols[0].add({ "Total" });
+		memory.cols[1].add({ new_string("%+.2f MB", (prev->rss_kb  - start->rss_kb ) / 1024.0) });
+		memory.cols[2].add({ new_string("%+.2f MB", (prev->anon_kb - start->anon_kb) / 1024.0) });
+		if (threads  .cols[0].count == 1) threads  .error = "The runtime didn't start any threads";
+		if (libraries.cols[0].count == 1) libraries.error = "The runtime didn't load any libraries";
+	}
+#endif
+
+	xr_tables.add(memory);
+	xr_tables.add(threads);
+	xr_tables.add(libraries);
+	footprint_clear();
+}
+
+///////////////////////////////////////////
+
+void footprint_idle(xr_settings_t settings, float seconds, int32_t interval_ms) {
+	display_table_t threads = {};
+	display_table_t summary = {};
+	threads.name_func = "Idle CPU: threads";  threads.name_type = "idleCpuThreads";
+	summary.name_func = "Idle CPU: summary";  summary.name_type = "idleCpuSummary";
+	threads.tag          = summary.tag = display_tag_footprint;
+	threads.header_row   = true;
+	threads.column_count = 3;
+	summary.column_count = 2;
+
+#if !defined(__linux__)
+	threads.error = summary.error = "Only available on Linux";
+#else
+	// Anything already running isn't the runtime's
+	array_t<int32_t> baseline = {};
+	DIR *dir = opendir("/proc/self/task");
+	if (dir) {
+		struct dirent *entry;
+		while ((entry = readdir(dir)) != nullptr) {
+			if (entry->d_name[0] >= '0' && entry->d_name[0] <= '9') baseline.add(atoi(entry->d_name));
+		}
+		closedir(dir);
+	}
+
+	const char *error = openxr_runtime_open(settings);
+	if (error) {
+		openxr_info_release();
+		baseline.free();
+		threads.error = summary.error = new_string("Couldn't open the runtime: %s", error);
+		xr_tables.add(threads);
+		xr_tables.add(summary);
+		return;
+	}
+	bool has_session = settings.allow_session;
+
+	// Give startup work a moment to finish, it isn't idle cost
+	timespec settle = { 0, 500 * 1000000 };
+	nanosleep(&settle, nullptr);
+	openxr_poll_events();
+
+	array_t<footprint_idle_thread_t> idle = {};
+	footprint_idle_sample(&idle, &baseline, 0);
+
+	timespec interval = { interval_ms / 1000, (interval_ms % 1000) * 1000000L };
+	timespec start, now;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	float   elapsed = 0;
+	int32_t events  = 0;
+	while (elapsed < seconds) {
+		nanosleep(&interval, nullptr);
+		events += openxr_poll_events();
+
+		clock_gettime(CLOCK_MONOTONIC, &now);
+		float prev_elapsed = elapsed;
+		elapsed = (float)(now.tv_sec - start.tv_sec) + (now.tv_nsec - start.tv_nsec) / 1000000000.0f;
+		footprint_idle_sample(&idle, &baseline, elapsed - prev_elapsed);
+	}
+	openxr_info_release();
+	baseline.free();
+
+	// Busiest first
+	qsort(idle.data, idle.count, sizeof(footprint_idle_thread_t), [](const void *a, const void *b) {
+		const footprint_idle_thread_t *ta = (const footprint_idle_thread_t *)a;
+		const footprint_idle_thread_t *tb = (const footprint_idle_thread_t *)b;
+		uint64_t ua = ta->ticks_prev - ta->ticks_first;
+		uint64_t ub = tb->ticks_prev - tb->ticks_first;
+		return (int)(ua < ub) - (int)(ua > ub);
+	});
+
+	float    ticks_per_pct   = sysconf(_SC_CLK_TCK) * elapsed / 100.0f;
+	uint64_t runtime_ticks   = 0, runtime_wakeups  = 0, own_ticks = 0, own_wakeups = 0;
+	int32_t  runtime_threads = 0;
+	threads.cols[0].add({ "Runtime thread" });
+	threads.cols[1].add({ "CPU % avg / peak" });
+	threads.cols[2].add({ "Wakeups/s" });
+	for (size_t i = 0; i < idle.count; i++) {
+		const footprint_idle_thread_t *thread = &idle[i];
+		uint64_t ticks   = thread->ticks_prev   - thread->ticks_first;
+		uint64_t wakeups = thread->wakeups_last - thread->wakeups_first;
+		if (!thread->runtime) {
+			own_ticks   += ticks;
+			own_wakeups += wakeups;
+			continue;
+		}
+		runtime_ticks   += ticks;
+		runtime_wakeups += wakeups;
+		runtime_threads += 1;
+		threads.cols[0].add({ new_string("%s [%d]", thread->name, thread->tid) });
+		threads.cols[1].add({ new_string("%.2f / %.2f", ticks / ticks_per_pct, thread->peak_pct) });
+		threads.cols[2].add({ new_string("%.1f", wakeups / elapsed) });
+	}
+	threads.cols[0].add({ "All runtime threads" });
+	threads.cols[1].add({ new_string("%.2f", runtime_ticks / ticks_per_pct) });
+	threads.cols[2].add({ new_string("%.1f", runtime_wakeups / elapsed) });
+	threads.cols[0].add({ "OpenXR Explorer's own threads" });
+	threads.cols[1].add({ new_string("%.2f", own_ticks / ticks_per_pct) });
+	threads.cols[2].add({ new_string("%.1f", own_wakeups / elapsed) });
+	idle.free();
+
+	summary.cols[0].add({ "Window" });          summary.cols[1].add({ new_string("%.1f s, %s", elapsed, has_session ? "with an XrSession" : "XrInstance only") });
+	summary.cols[0].add({ "Sample interval" }); summary.cols[1].add({ new_string("%d ms", interval_ms) });
+	summary.cols[0].add({ "Runtime threads" }); summary.cols[1].add({ new_string("%d", runtime_threads) });
+	summary.cols[0].add({ "Runtime CPU" });     summary.cols[1].add({ new_string("%.2f%% of one core", runtime_ticks / ticks_per_pct) });
+	summary.cols[0].add({ "Runtime wakeups" }); summary.cols[1].add({ new_string("%llu total, %.1f/s", (unsigned long long)runtime_wakeups, runtime_wakeups / elapsed) });
+	summary.cols[0].add({ "Events polled" });   summary.cols[1].add({ new_string("%d", events) });
+#endif
+
+	xr_tables.add(threads);
+	xr_tables.add(summary);
+}
+
+///////////////////////////////////////////
+
+static bool footprint_has_thread(const footprint_sample_t *sample, int32_t tid) {
+	for (size_t i = 0; i < sample->threads.count; i++) {
+		if (sample->threads[i].tid == tid) return true;
+	}
+	return false;
+}
+
+///////////////////////////////////////////
+
+static bool footprint_has_library(const footprint_sample_t *sample, const char *library) {
+	return bsearch(&library, sample->libraries.data, sample->libraries.count, sizeof(char *), footprint_str_cmp) != nullptr;
+}
+
+///////////////////////////////////////////
+
+static int footprint_str_cmp(const void *a, const void *b) {
+	return strcmp(*(const char **)a, *(const char **)b);
+}
+
+///////////////////////////////////////////
+
+#if defined(__linux__)
+
+static void footprint_read_status(footprint_sample_t *sample) {
+	FILE *fp = fopen("/proc/self/status", "r");
+	if (fp == nullptr) return;
+
+	char    line[256];
+	int64_t value;
+	while (fgets(line, sizeof(line), fp)) {
+		if      (sscanf(line, "VmRSS: %ld kB",   &value) == 1) sample->rss_kb  = value;
+		else if (sscanf(line, "RssAnon: %ld kB", &value) == 1) sample->anon_kb = value;
+	}
+	fclose(fp);
+}
+
+///////////////////////////////////////////
+
+static void footprint_affinity_str(const cpu_set_t *set, char *out, size_t out_size) {
+	out[0] = '\0';
+	size_t at = 0;
+	if (CPU_COUNT(set) == 0) { snprintf(out, out_size, "none"); return; }
+
+	// As ranges, like "0-3,8"
+	for (int32_t cpu = 0; cpu < CPU_SETSIZE && at < out_size; cpu++) {
+		if (!CPU_ISSET(cpu, set)) continue;
+		int32_t end = cpu;
+		while (end + 1 < CPU_SETSIZE && CPU_ISSET(end + 1, set)) end++;
+		at += end == cpu
+			? snprintf(&out[at], out_size - at, "%s%d",    at ? "," : "", cpu)
+			: snprintf(&out[at], out_size - at, "%s%d-%d", at ? "," : "", cpu, end);
+		cpu = end;
+	}
+}
+
+///////////////////////////////////////////
+
+static void footprint_read_threads(footprint_sample_t *sample) {
+	DIR *dir = opendir("/proc/self/task");
+	if (dir == nullptr) return;
+
+	cpu_set_t process_set;
+	bool      has_process_set = sched_getaffinity(0, sizeof(process_set), &process_set) == 0;
+
+	struct dirent *entry;
+	while ((entry = readdir(dir)) != nullptr) {
+		if (entry->d_name[0] < '0' || entry->d_name[0] > '9') continue;
+
+		footprint_thread_t thread = {};
+		thread.tid = atoi(entry->d_name);
+
+		char path[64];
+		snprintf(path, sizeof(path), "/proc/self/task/%d/comm", thread.tid);
+		FILE *fp = fopen(path, "r");
+		if (fp) {
+			if (fgets(thread.name, sizeof(thread.name), fp)) thread.name[strcspn(thread.name, "\n")] = '\0';
+			fclose(fp);
+		}
+
+		int         policy   = sched_getscheduler(thread.tid);
+		sched_param param    = {};
+		sched_getparam(thread.tid, &param);
+		const char *name =
+			policy == SCHED_OTHER ? "SCHED_OTHER" :
+			policy == SCHED_FIFO  ? "SCHED_FIFO"  :
+			policy == SCHED_RR    ? "SCHED_RR"    :
+			policy == SCHED_BATCH ? "SCHED_BATCH" :
+			policy == SCHED_IDLE  ? "SCHED_IDLE"  :
+			policy >= 0           ? "other"       : "?";
+		if (policy == SCHED_FIFO || policy == SCHED_RR) snprintf(thread.policy, sizeof(thread.policy), "%s %d", name, param.sched_priority);
+		else                                            snprintf(thread.policy, sizeof(thread.policy), "%s", name);
+
+		cpu_set_t set;
+		if (sched_getaffinity(thread.tid, sizeof(set), &set) != 0)
+			snprintf(thread.affinity, sizeof(thread.affinity), "?");
+		else if (has_process_set && CPU_EQUAL(&set, &process_set))
+			snprintf(thread.affinity, sizeof(thread.affinity), "inherited");
+		else
+			footprint_affinity_str(&set, thread.affinity, sizeof(thread.affinity));
+
+		sample->threads.add(thread);
+	}
+	closedir(dir);
+}
+
+///////////////////////////////////////////
+
+static bool footprint_read_task(int32_t tid, char *out_name, size_t name_size, uint64_t *out_ticks, uint64_t *out_wakeups) {
+	char path[64];
+	char line[512];
+	snprintf(path, sizeof(path), "/proc/self/task/%d/stat", tid);
+	FILE *fp = fopen(path, "r");
+	if (fp == nullptr) return false;
+	bool ok = fgets(line, sizeof(line), fp) != nullptr;
+	fclose(fp);
+
+	// The name is in parentheses and can hold spaces or parentheses itself,
+	// so fields are counted from the last ')'. utime and stime are 14 and 15.
+	char *name_start = ok ? strchr (line, '(') : nullptr;
+	char *name_end   = ok ? strrchr(line, ')') : nullptr;
+	if (name_start == nullptr || name_end == nullptr || name_end < name_start) return false;
+	size_t name_len = name_end - name_start - 1;
+	if (name_len >= name_size) name_len = name_size - 1;
+	memcpy(out_name, name_start + 1, name_len);
+	out_name[name_len] = '\0';
+
+	unsigned long utime = 0, stime = 0;
+	if (sscanf(name_end + 1, " %*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %lu %lu", &utime, &stime) != 2) return false;
+	*out_ticks = utime + stime;
+
+	// Every voluntary switch is the thread going to sleep, so one wakeup
+	*out_wakeups = 0;
+	snprintf(path, sizeof(path), "/proc/self/task/%d/status", tid);
+	fp = fopen(path, "r");
+	if (fp) {
+		unsigned long switches;
+		while (fgets(line, sizeof(line), fp)) {
+			if (sscanf(line, "voluntary_ctxt_switches: %lu", &switches) == 1) {
+				*out_wakeups = switches;
+				break;
+			}
+		}
+		fclose(fp);
+	}
+	return true;
+}
+
+///////////////////////////////////////////
+
+static void footprint_idle_sample(array_t<footprint_idle_thread_t> *threads, const array_t<int32_t> *baseline, float interval_s) {
+	DIR *dir = opendir("/proc/self/task");
+	if (dir == nullptr) return;
+
+	float ticks_per_pct = sysconf(_SC_CLK_TCK) * interval_s / 100.0f;
+	struct dirent *entry;
+	while ((entry = readdir(dir)) != nullptr) {
+		if (entry->d_name[0] < '0' || entry->d_name[0] > '9') continue;
+
+		footprint_idle_thread_t curr = {};
+		curr.tid = atoi(entry->d_name);
+		uint64_t ticks, wakeups;
+		if (!footprint_read_task(curr.tid, curr.name, sizeof(curr.name), &ticks, &wakeups)) continue;
+
+		int64_t index = threads->index_where(&footprint_idle_thread_t::tid, curr.tid);
+		if (index < 0) {
+			// First seen now, so it's measured from here on
+			curr.runtime       = baseline->index_where([](const int32_t &tid, void *data) { return tid == *(int32_t *)data; }, &curr.tid) < 0;
+			curr.ticks_first   = curr.ticks_prev   = ticks;
+			curr.wakeups_first = curr.wakeups_last = wakeups;
+			threads->add(curr);
+			continue;
+		}
+
+		footprint_idle_thread_t *thread = &threads->get(index);
+		float pct = ticks_per_pct > 0 ? (ticks - thread->ticks_prev) / ticks_per_pct : 0;
+		if (pct > thread->peak_pct) thread->peak_pct = pct;
+		thread->ticks_prev   = ticks;
+		thread->wakeups_last = wakeups;
+	}
+	closedir(dir);
+}
+
+///////////////////////////////////////////
+
+static void footprint_read_libraries(footprint_sample_t *sample) {
+	FILE *fp = fopen("/proc/self/maps", "r");
+	if (fp == nullptr) return;
+
+	// Path is the sixth field, and the only one that can have spaces
+	char line[1200];
+	while (fgets(line, sizeof(line), fp)) {
+		const char *path = strchr(line, '/');
+		if (path == nullptr) continue;
+		size_t len = strcspn(path, "\n");
+		if (strstr(path, ".so") == nullptr) continue;
+
+		char *library = (char *)malloc(len + 1);
+		memcpy(library, path, len);
+		library[len] = '\0';
+		sample->libraries.add(library);
+	}
+	fclose(fp);
+
+	// Each library is mapped several times, so sort and drop repeats
+	qsort(sample->libraries.data, sample->libraries.count, sizeof(char *), footprint_str_cmp);
+	size_t unique = 0;
+	for (size_t i = 0; i < sample->libraries.count; i++) {
+		if (unique > 0 && strcmp(sample->libraries[unique - 1], sample->libraries[i]) == 0) {
+			free(sample->libraries[i]);
+			continue;
+		}
+		sample->libraries[unique++] = sample->libraries[i];
+	}
+	sample->libraries.count = unique;
+}
+
+#endif
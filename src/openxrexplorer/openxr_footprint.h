@@ -0,0 +1,28 @@
+#pragma once
+
+#include "openxr_info.h"
+
+// What loading a runtime costs the process that loads it: memory, the
+// threads it starts, and the shared libraries it drags in. Sampled from
+// /proc/self around each step of runtime startup, so it's Linux only, and
+// anything else running in the process at the same time shows up too.
+
+enum footprint_step_ {
+	footprint_step_start,    // Before anything touches the runtime
+	footprint_step_instance, // After extension enumeration and xrCreateInstance
+	footprint_step_system,   // After xrGetSystem
+	footprint_step_session,  // After xrCreateSession
+	footprint_step_max,
+};
+
+/*** Signatures **************************/
+
+void footprint_sample(footprint_step_ step);
+// Adds the footprint tables to xr_tables, and forgets the samples.
+void footprint_tables();
+void footprint_clear ();
+
+// Holds the runtime open for `seconds` without rendering, sampling every
+// thread's CPU time and wakeups each interval_ms, and adds tables for the
+// threads the runtime started. Leaves nothing open afterwards.
+void footprint_idle  (xr_settings_t settings, float seconds, int32_t interval_ms);
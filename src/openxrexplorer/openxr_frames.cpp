@@ -0,0 +1,1304 @@
+#include "openxr_frames.h"
+#include "openxr_session.h"
+#include "openxr_swapchain.h"
+#include "app_stats.h"
+#include "imgui/sokol_time.h"
+
+#include <openxr/openxr_reflection.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+/*** Types *******************************/
+
+struct frames_pacing_t {
+	uint64_t       frame;
+	XrSessionState session_state;
+	bool           should_render;
+	XrTime         predicted_time;
+	XrDuration     predicted_period;
+	uint64_t       wait_start;     // stm ticks
+	uint64_t       wait_return;
+	XrTime         wait_return_xr; // 0 if the runtime can't convert clocks
+};
+
+struct frames_pacing_stats_t {
+	int32_t count;
+	float   seconds;
+	float   nominal_ms;             // Median predictedDisplayPeriod
+	float   measured_hz;            // Display periods per second of predicted time
+	float   wake_jitter[3];         // p50, p99, p99.9, in ms
+	float   wake_jitter_max;
+	float   predicted_jitter[3];
+	int32_t predicted_jitter_count;
+	int32_t missed;
+	int32_t duplicated;
+	int32_t no_render;
+	int64_t periods_seen;
+	double  predicted_ppm;
+	double  wake_ppm;
+	float   lead[3];
+	int32_t lead_count;
+	int32_t buckets[6];
+};
+
+struct frames_pacing_run_t {
+	frames_pacing_t *frames;
+	int32_t          count;
+	int32_t          capacity;
+	int32_t          focused_at;   // Index of the first FOCUSED frame, -1 until then
+	uint64_t         focused_time;
+	float            seconds;
+};
+
+// Microseconds, one per measured frame
+struct frames_cpu_sample_t {
+	float wait_cpu;
+	float wait_wall;
+	float begin_cpu;
+	float begin_wall;
+	float end_cpu;
+	float end_wall;
+};
+
+enum frames_cpu_config_ {
+	frames_cpu_config_none,
+	frames_cpu_config_one,
+	frames_cpu_config_max,
+	frames_cpu_config_count,
+};
+
+struct frames_cpu_run_t {
+	int32_t                  frames;        // Per configuration
+	int32_t                  config_count;  // Fewer than all of them without swapchains
+	uint32_t                 layer_counts[frames_cpu_config_count];
+	frames_cpu_sample_t     *samples     [frames_cpu_config_count];
+	int32_t                  counts      [frames_cpu_config_count];
+	int32_t                  unrendered  [frames_cpu_config_count];
+	int32_t                  config;
+	int32_t                  warmup;        // Frames left to skip, -1 until FOCUSED
+
+	swapchain_t                          swapchain;
+	XrCompositionLayerQuad              *quads;
+	const XrCompositionLayerBaseHeader **quad_ptrs;
+	XrResult                             cycle_result;
+};
+
+// One combination of settings for frames_experiments, indices into the
+// lists in frames_experiment_t, or -1 where the runtime has no such list
+struct frames_combo_t {
+	int32_t rate;
+	int32_t mode;
+	int32_t level;
+	int32_t first;          // Into frames_experiment_t.records
+	int32_t count;
+};
+
+// How long applying a setting took, summed over every time it was applied
+struct frames_apply_t {
+	double  call_ms;
+	double  settle_ms;
+	int32_t count;
+	int32_t settled;
+};
+
+enum frames_phase_ {
+	frames_phase_focus,     // Waiting for FOCUSED
+	frames_phase_apply,
+	frames_phase_settle,
+	frames_phase_measure,
+};
+
+struct frames_experiment_t {
+	float                  rates [16];
+	int32_t                rate_count;
+	XrReprojectionModeMSFT modes [8];
+	int32_t                mode_count;
+	int32_t                level_count;
+	frames_apply_t         rate_apply [16];
+	frames_apply_t         level_apply[4];
+
+	frames_combo_t        *combos;
+	int32_t                combo_count;
+	int32_t                combo;
+	int32_t                frames;  // Per combination
+	frames_pacing_t       *records;
+	float                 *cpu_us;  // Wait, begin and end together, per record
+
+	frames_phase_          phase;
+	int32_t                warmup;
+	int32_t                applied_rate;
+	int32_t                applied_level;
+	bool                   settling;
+	uint64_t               rate_requested;
+	double                 rate_target_ms;
+	XrResult               apply_result;
+
+	PFN_xrRequestDisplayRefreshRateFB        request_rate;
+	PFN_xrPerfSettingsSetPerformanceLevelEXT set_level;
+
+	bool                                     has_projection;
+	swapchain_projection_t                   projection;
+	XrCompositionLayerReprojectionInfoMSFT   reprojection;
+	const XrCompositionLayerBaseHeader      *layer_ptr;
+	XrResult                                 layer_result;
+};
+
+enum frames_layer_ {
+	frames_layer_projection,
+	frames_layer_quad,
+	frames_layer_cylinder,
+	frames_layer_cube,
+	frames_layer_count,
+};
+
+// One layer type at one count, for frames_layers. A count of 0 is the
+// baseline with no layers at all.
+struct frames_layer_step_t {
+	frames_layer_ type;
+	uint32_t      count;
+	int32_t       first;   // Into frames_layer_run_t.records
+	int32_t       measured;
+};
+
+struct frames_layer_run_t {
+	frames_layer_step_t *steps;
+	int32_t              step_count;
+	int32_t              step;
+	int32_t              frames;   // Per step
+	int32_t              warmup;   // Frames left to skip, -1 until FOCUSED
+	frames_pacing_t     *records;
+	float               *end_cpu;  // us, -1 where the frame didn't submit the step's layers
+	float               *end_wall;
+	XrResult             results[frames_layer_count];
+
+	swapchain_t                          swapchain;
+	swapchain_t                          cube_swapchain;
+	swapchain_projection_t               projection;
+	XrCompositionLayerProjection        *projections;
+	XrCompositionLayerQuad              *quads;
+	XrCompositionLayerCylinderKHR       *cylinders;
+	XrCompositionLayerCubeKHR           *cubes;
+	const XrCompositionLayerBaseHeader **layer_ptrs[frames_layer_count];
+};
+
+/*** Global Variables ********************/
+
+// How long to give the runtime to get the session to FOCUSED, on top of
+// the measurement itself.
+const float frames_focus_timeout_s = 10;
+// Frame records are preallocated for up to this refresh rate
+const int32_t frames_max_hz = 1000;
+// Wake-up intervals in display periods, for the pacing histogram
+const char   *frames_bucket_names[] = { "< 0.5", "0.5 - 0.9", "0.9 - 1.1", "1.1 - 1.5", "1.5 - 2.5", ">= 2.5" };
+const float   frames_bucket_max  [] = { 0.5f,    0.9f,        1.1f,        1.5f,        2.5f,        INFINITY };
+const int32_t frames_bucket_count   = sizeof(frames_bucket_max) / sizeof(frames_bucket_max[0]);
+const float   frames_pacing_percentiles[3] = { 0.5f, 0.99f, 0.999f };
+// Frames to let pass once FOCUSED, and after each change of layer count,
+// before the CPU measurement counts them
+const int32_t frames_cpu_warmup = 30;
+// How long a requested refresh rate gets to show up in the predictions
+const float   frames_settle_timeout_s = 3;
+// XR_EXT_performance_settings levels, applied to the CPU and GPU together
+const XrPerfSettingsLevelEXT frames_levels[] = {
+	XR_PERF_SETTINGS_LEVEL_POWER_SAVINGS_EXT,
+	XR_PERF_SETTINGS_LEVEL_SUSTAINED_LOW_EXT,
+	XR_PERF_SETTINGS_LEVEL_SUSTAINED_HIGH_EXT,
+	XR_PERF_SETTINGS_LEVEL_BOOST_EXT,
+};
+const char   *frames_layer_names[] = { "Projection", "Quad", "Cylinder", "Cube" };
+// A layer count's cost per added layer, against the first layer's, that
+// counts as the cost bending upward
+const float   frames_bend_ratio    = 2;
+
+/*** Signatures **************************/
+
+static display_table_t frames_pacing_table();
+static bool        frames_pacing_record(const session_frame_t *frame, void *data);
+static frames_pacing_stats_t frames_pacing_stats(const frames_pacing_t *frames, int32_t count);
+static void        frames_pacing_report(const frames_pacing_run_t *run);
+static bool        frames_pacing_csv   (const frames_pacing_run_t *run, const char *csv_file);
+static void        frames_cpu_layers   (session_frame_t *frame, void *data);
+static bool        frames_cpu_record   (const session_frame_t *frame, void *data);
+static void        frames_cpu_report   (const frames_cpu_run_t *run, const char *swapchain_error);
+static display_table_t frames_cpu_table();
+static display_table_t frames_experiment_table();
+static void        frames_experiment_layers(session_frame_t *frame, void *data);
+static bool        frames_experiment_frame (const session_frame_t *frame, void *data);
+static void        frames_experiment_report(const frames_experiment_t *exp, const char *layer_note);
+static display_table_t frames_layer_table();
+static void        frames_layer_layers (session_frame_t *frame, void *data);
+static bool        frames_layer_frame  (const session_frame_t *frame, void *data);
+static void        frames_layer_report (const frames_layer_run_t *run, const char **notes, const char *stop_error);
+static const char *frames_mode_str     (XrReprojectionModeMSFT mode);
+static const char *frames_level_str    (XrPerfSettingsLevelEXT level);
+
+/*** Code ********************************/
+
+void frames_pacing(xr_settings_t settings, float seconds, const char *csv_file) {
+	settings = session_settings(settings);
+
+	const char *error = openxr_runtime_open(settings);
+	if (error) {
+		openxr_runtime_close();
+		display_table_t summary = frames_pacing_table();
+		summary.error = new_string("Couldn't open the runtime: %s", error);
+		xr_tables.add(summary);
+		return;
+	}
+
+	// Allocated up front, so the session thread only ever writes into it
+	frames_pacing_run_t run = {};
+	run.seconds    = seconds;
+	run.focused_at = -1;
+	run.capacity   = (int32_t)((seconds + frames_focus_timeout_s) * frames_max_hz);
+	run.frames     = (frames_pacing_t *)malloc(sizeof(frames_pacing_t) * run.capacity);
+
+	session_hooks_t hooks = {};
+	hooks.data     = &run;
+	hooks.on_frame = frames_pacing_record;
+	if (session_start(settings, hooks)) {
+		session_wait(seconds + frames_focus_timeout_s);
+		session_stop();
+	}
+	session_info_t info = session_info();
+
+	if (info.error || run.count < 3) {
+		display_table_t summary = frames_pacing_table();
+		summary.error = info.error ? info.error : "The session ran too few frames to measure";
+		xr_tables.add(summary);
+	} else {
+		frames_pacing_report(&run);
+	}
+	if (csv_file && run.count > 0) {
+		if (frames_pacing_csv(&run, csv_file)) printf("Wrote %d frames to %s\n", run.count, csv_file);
+		else                                   printf("Couldn't write %s\n", csv_file);
+	}
+
+	free(run.frames);
+	openxr_runtime_close();
+}
+
+///////////////////////////////////////////
+
+static display_table_t frames_pacing_table() {
+	display_table_t table = {};
+	table.name_func    = "framePacing";
+	table.name_type    = "XrFrameState";
+	table.spec         = "XrFrameState";
+	table.tag          = display_tag_misc;
+	table.column_count = 3;
+	table.header_row   = true;
+	table.cols[0].add({ "Measure" });
+	table.cols[1].add({ "Value" });
+	table.cols[2].add({ "Notes" });
+	return table;
+}
+
+///////////////////////////////////////////
+
+static bool frames_pacing_record(const session_frame_t *frame, void *data) {
+	frames_pacing_run_t *run = (frames_pacing_run_t *)data;
+	if (run->count >= run->capacity) return false;
+
+	frames_pacing_t *rec = &run->frames[run->count];
+	rec->frame            = frame->index;
+	rec->session_state    = frame->session_state;
+	rec->should_render    = frame->state.shouldRender == XR_TRUE;
+	rec->predicted_time   = frame->state.predictedDisplayTime;
+	rec->predicted_period = frame->state.predictedDisplayPeriod;
+	rec->wait_start       = frame->wait_start;
+	rec->wait_return      = frame->wait_end;
+	rec->wait_return_xr   = session_xr_time(frame->wait_end);
+
+	if (run->focused_at < 0 && frame->session_state == XR_SESSION_STATE_FOCUSED) {
+		run->focused_at   = run->count;
+		run->focused_time = frame->wait_end;
+	}
+	run->count += 1;
+
+	return run->focused_at < 0 || stm_sec(stm_diff(frame->wait_end, run->focused_time)) < run->seconds;
+}
+
+///////////////////////////////////////////
+
+static frames_pacing_stats_t frames_pacing_stats(const frames_pacing_t *f, int32_t count) {
+	frames_pacing_stats_t result = {};
+	result.count = count;
+	if (count < 2) return result;
+
+	// The runtime's own idea of the refresh rate
+	float *period_ms = (float *)malloc(sizeof(float) * count);
+	for (int32_t i = 0; i < count; i++) period_ms[i] = (float)(f[i].predicted_period / 1000000.0);
+	qsort(period_ms, count, sizeof(float), stats_float_cmp);
+	result.nominal_ms = stats_percentile(period_ms, count, 0.5f);
+	double nominal_ns = result.nominal_ms * 1000000.0;
+	free(period_ms);
+
+	// Wake-up intervals, and how far each one is from the nominal period.
+	// Frames the runtime made us skip are part of the jitter, that's what
+	// the histogram is for.
+	int32_t intervals        = count - 1;
+	float  *wake_jitter      = (float *)malloc(sizeof(float) * intervals);
+	float  *predicted_jitter = (float *)malloc(sizeof(float) * intervals);
+	int32_t predicted_count  = 0;
+	for (int32_t i = 1; i < count; i++) {
+		double wake_ns = stm_ns(stm_diff(f[i].wait_return, f[i-1].wait_return));
+		wake_jitter[i-1] = (float)(fabs(wake_ns - nominal_ns) / 1000000.0);
+		if (nominal_ns > 0) {
+			double periods = wake_ns / nominal_ns;
+			for (int32_t b = 0; b < frames_bucket_count; b++) {
+				if (periods < frames_bucket_max[b]) { result.buckets[b] += 1; break; }
+			}
+		}
+
+		XrDuration step = f[i].predicted_time - f[i-1].predicted_time;
+		if (step <= 0) { result.duplicated += 1; continue; }
+		int64_t periods = nominal_ns > 0 ? (int64_t)llround(step / nominal_ns) : 1;
+		if (periods < 1) periods = 1;
+		if (periods > 1) result.missed += (int32_t)(periods - 1);
+		result.periods_seen += periods;
+		predicted_jitter[predicted_count++] = (float)(fabs(step - periods * nominal_ns) / 1000000.0);
+	}
+	qsort(wake_jitter,      intervals,       sizeof(float), stats_float_cmp);
+	qsort(predicted_jitter, predicted_count, sizeof(float), stats_float_cmp);
+	for (int32_t p = 0; p < 3; p++) {
+		result.wake_jitter[p] = stats_percentile(wake_jitter, intervals, frames_pacing_percentiles[p]);
+		if (predicted_count > 0)
+			result.predicted_jitter[p] = stats_percentile(predicted_jitter, predicted_count, frames_pacing_percentiles[p]);
+	}
+	result.wake_jitter_max        = wake_jitter[intervals-1];
+	result.predicted_jitter_count = predicted_count;
+	free(wake_jitter);
+	free(predicted_jitter);
+
+	// Drift: whether the predicted display times keep to their own period,
+	// and whether our wake-ups keep to the predicted display times. Both
+	// are spans on a single clock, so they need no clock conversion.
+	double predicted_span = (double)(f[count-1].predicted_time - f[0].predicted_time);
+	double wake_span      = stm_ns(stm_diff(f[count-1].wait_return, f[0].wait_return));
+	result.seconds        = (float)(wake_span / 1000000000.0);
+	result.measured_hz    = predicted_span > 0 ? (float)(result.periods_seen * 1000000000.0 / predicted_span) : 0;
+	result.predicted_ppm  = result.periods_seen > 0 && nominal_ns > 0 ? (predicted_span / (result.periods_seen * nominal_ns) - 1) * 1000000 : 0;
+	result.wake_ppm       = predicted_span > 0 ? (wake_span / predicted_span - 1) * 1000000 : 0;
+
+	// How long before its display time each frame was let go, when the
+	// runtime can put our clock on its timeline
+	float *lead = (float *)malloc(sizeof(float) * count);
+	for (int32_t i = 0; i < count; i++) {
+		if (!f[i].should_render) result.no_render += 1;
+		if (f[i].wait_return_xr != 0)
+			lead[result.lead_count++] = (float)((f[i].predicted_time - f[i].wait_return_xr) / 1000000.0);
+	}
+	qsort(lead, result.lead_count, sizeof(float), stats_float_cmp);
+	for (int32_t p = 0; p < 3 && result.lead_count > 0; p++)
+		result.lead[p] = stats_percentile(lead, result.lead_count, frames_pacing_percentiles[p]);
+	free(lead);
+
+	return result;
+}
+
+///////////////////////////////////////////
+
+static void frames_pacing_report(const frames_pacing_run_t *run) {
+	// Frames from before FOCUSED are the runtime settling in, not pacing
+	int32_t               first = run->focused_at > 0 && run->count - run->focused_at >= 3 ? run->focused_at : 0;
+	frames_pacing_stats_t stats = frames_pacing_stats(&run->frames[first], run->count - first);
+
+	display_table_t summary = frames_pacing_table();
+
+	summary.cols[0].add({ "Frames" });
+	summary.cols[1].add({ new_string("%d", stats.count) });
+	summary.cols[2].add({ run->focused_at >= 0
+		? new_string("%.1f s once FOCUSED, %d frames before that left out", stats.seconds, first)
+		: new_string("%.1f s, never FOCUSED, so every frame counts", stats.seconds) });
+
+	summary.cols[0].add({ "Nominal refresh" });
+	summary.cols[1].add({ stats.nominal_ms > 0 ? new_string("%.2f Hz", 1000.0f / stats.nominal_ms) : "Unknown" });
+	summary.cols[2].add({ new_string("Median predictedDisplayPeriod, %.3f ms", stats.nominal_ms) });
+
+	summary.cols[0].add({ "Wake-up jitter p50 / p99 / p99.9 (ms)" });
+	summary.cols[1].add({ new_string("%.3f / %.3f / %.3f", stats.wake_jitter[0], stats.wake_jitter[1], stats.wake_jitter[2]) });
+	summary.cols[2].add({ new_string("Time between xrWaitFrame returns, off the period by, max %.3f", stats.wake_jitter_max) });
+
+	summary.cols[0].add({ "Predicted time jitter p50 / p99 / p99.9 (ms)" });
+	summary.cols[1].add({ stats.predicted_jitter_count > 0
+		? new_string("%.3f / %.3f / %.3f", stats.predicted_jitter[0], stats.predicted_jitter[1], stats.predicted_jitter[2])
+		: "None" });
+	summary.cols[2].add({ "Steps in predictedDisplayTime, off a whole number of periods by" });
+
+	summary.cols[0].add({ "Missed display times" });
+	summary.cols[1].add({ new_string("%d", stats.missed) });
+	summary.cols[2].add({ new_string("Periods skipped between predicted display times, %.2f%%", stats.periods_seen > 0 ? stats.missed * 100.0 / stats.periods_seen : 0) });
+
+	summary.cols[0].add({ "Duplicated display times" });
+	summary.cols[1].add({ new_string("%d", stats.duplicated) });
+	summary.cols[2].add({ "Frames predicted for the same time as the one before, or earlier" });
+
+	summary.cols[0].add({ "shouldRender false" });
+	summary.cols[1].add({ new_string("%d", stats.no_render) });
+	summary.cols[2].add({ "Frames the runtime didn't want rendered" });
+
+	summary.cols[0].add({ "Display time drift (ppm)" });
+	summary.cols[1].add({ new_string("%+.1f", stats.predicted_ppm) });
+	summary.cols[2].add({ "Predicted display times against their nominal period" });
+
+	summary.cols[0].add({ "Wake-up drift (ppm)" });
+	summary.cols[1].add({ new_string("%+.1f", stats.wake_ppm) });
+	summary.cols[2].add({ "xrWaitFrame returns against predicted display times" });
+
+	summary.cols[0].add({ "Wake-up to display p50 / p99 / p99.9 (ms)" });
+	summary.cols[1].add({ stats.lead_count > 0
+		? new_string("%.3f / %.3f / %.3f", stats.lead[0], stats.lead[1], stats.lead[2])
+		: "Unknown" });
+	summary.cols[2].add({ stats.lead_count > 0
+		? "From xrWaitFrame returning to predictedDisplayTime"
+		: "Needs a runtime that converts clocks to XrTime" });
+	xr_tables.add(summary);
+
+	display_table_t histogram = {};
+	histogram.name_func    = "framePacing";
+	histogram.name_type    = "framePacingHistogram";
+	histogram.spec         = "frame-synchronization";
+	histogram.tag          = display_tag_misc;
+	histogram.column_count = 3;
+	histogram.header_row   = true;
+	histogram.cols[0].add({ "Wake-up interval (periods)" });
+	histogram.cols[1].add({ "Frames" });
+	histogram.cols[2].add({ "Share" });
+	for (int32_t b = 0; b < frames_bucket_count; b++) {
+		histogram.cols[0].add({ frames_bucket_names[b] });
+		histogram.cols[1].add({ new_string("%d",     stats.buckets[b]) });
+		histogram.cols[2].add({ new_string("%.2f%%", stats.buckets[b] * 100.0 / (stats.count - 1)) });
+	}
+	if (stats.nominal_ms <= 0) histogram.error = "The runtime reported no predictedDisplayPeriod";
+	xr_tables.add(histogram);
+}
+
+///////////////////////////////////////////
+
+static bool frames_pacing_csv(const frames_pacing_run_t *run, const char *csv_file) {
+	FILE *fp = fopen(csv_file, "w");
+	if (!fp) return false;
+
+	fprintf(fp, "frame,session_state,focused,should_render,predicted_display_time_ns,predicted_display_period_ns,wait_start_ms,wait_return_ms,wait_return_xr_ns\n");
+	for (int32_t i = 0; i < run->count; i++) {
+		const frames_pacing_t *f = &run->frames[i];
+		fprintf(fp, "%llu,%s,%d,%d,%lld,%lld,%.4f,%.4f,%lld\n",
+			(unsigned long long)f->frame,
+			session_state_str(f->session_state),
+			run->focused_at >= 0 && i >= run->focused_at,
+			f->should_render,
+			(long long)f->predicted_time,
+			(long long)f->predicted_period,
+			stm_ms(f->wait_start),
+			stm_ms(f->wait_return),
+			(long long)f->wait_return_xr);
+	}
+	fclose(fp);
+	return true;
+}
+
+///////////////////////////////////////////
+
+void frames_cpu(xr_settings_t settings, int32_t frames) {
+	settings = session_settings(settings);
+
+	const char *error = openxr_runtime_open(settings);
+	if (error) {
+		openxr_runtime_close();
+		display_table_t table = frames_cpu_table();
+		table.error = new_string("Couldn't open the runtime: %s", error);
+		xr_tables.add(table);
+		return;
+	}
+
+	frames_cpu_run_t run = {};
+	run.frames = frames;
+	run.warmup = -1;
+
+	// Layers need a swapchain to show, and a space to put them in
+	XrSystemProperties properties = { XR_TYPE_SYSTEM_PROPERTIES };
+	xrGetSystemProperties(xr_instance, xr_system_id, &properties);
+	uint32_t max_layers = properties.graphicsProperties.maxLayerCount;
+
+	XrSpace     space           = XR_NULL_HANDLE;
+	const char *swapchain_error = swapchain_create(&run.swapchain, 256, 256);
+	if (!swapchain_error) {
+		XrReferenceSpaceCreateInfo space_info = { XR_TYPE_REFERENCE_SPACE_CREATE_INFO };
+		space_info.referenceSpaceType   = XR_REFERENCE_SPACE_TYPE_VIEW;
+		space_info.poseInReferenceSpace = { {0,0,0,1}, {0,0,0} };
+		XrResult result = xrCreateReferenceSpace(xr_session, &space_info, &space);
+		if (XR_FAILED(result)) swapchain_error = new_string("xrCreateReferenceSpace: %s", openxr_result_string(result));
+	}
+
+	run.layer_counts[run.config_count++] = 0;
+	if (!swapchain_error && max_layers >= 1) run.layer_counts[run.config_count++] = 1;
+	if (!swapchain_error && max_layers >  1) run.layer_counts[run.config_count++] = max_layers;
+	if (!swapchain_error) {
+		run.quads     = (XrCompositionLayerQuad              *)malloc(sizeof(XrCompositionLayerQuad)                * max_layers);
+		run.quad_ptrs = (const XrCompositionLayerBaseHeader **)malloc(sizeof(XrCompositionLayerBaseHeader *) * max_layers);
+		swapchain_quads(&run.swapchain, space, run.quads, run.quad_ptrs, max_layers);
+	}
+	for (int32_t c = 0; c < run.config_count; c++)
+		run.samples[c] = (frames_cpu_sample_t *)malloc(sizeof(frames_cpu_sample_t) * frames);
+
+	session_hooks_t hooks = {};
+	hooks.data        = &run;
+	hooks.measure_cpu = true;
+	hooks.on_layers   = frames_cpu_layers;
+	hooks.on_frame    = frames_cpu_record;
+	if (session_start(settings, hooks)) {
+		// Generous, so a 30Hz runtime still finishes
+		float expected_s = (run.config_count * (frames + frames_cpu_warmup)) / 30.0f;
+		session_wait(expected_s + frames_focus_timeout_s);
+		session_stop();
+	}
+	session_info_t info = session_info();
+
+	if (info.error) {
+		display_table_t table = frames_cpu_table();
+		table.error = info.error;
+		xr_tables.add(table);
+	} else if (run.counts[0] == 0) {
+		display_table_t table = frames_cpu_table();
+		table.error = "The session never got to FOCUSED";
+		xr_tables.add(table);
+	} else {
+		if (!swapchain_error && XR_FAILED(run.cycle_result))
+			swapchain_error = new_string("Swapchain images: %s", openxr_result_string(run.cycle_result));
+		frames_cpu_report(&run, swapchain_error);
+	}
+
+	for (int32_t c = 0; c < run.config_count; c++) free(run.samples[c]);
+	free(run.quads);
+	free(run.quad_ptrs);
+	if (space != XR_NULL_HANDLE) xrDestroySpace(space);
+	swapchain_destroy(&run.swapchain);
+	openxr_runtime_close();
+}
+
+///////////////////////////////////////////
+
+static display_table_t frames_cpu_table() {
+	display_table_t table = {};
+	table.name_func    = "frameCpu";
+	table.name_type    = "frameCpuCost";
+	table.spec         = "frame-submission";
+	table.tag          = display_tag_misc;
+	table.column_count = 3;
+	table.header_row   = true;
+	table.cols[0].add({ "Call" });
+	table.cols[1].add({ "Thread CPU median / p99 / mean (us)" });
+	table.cols[2].add({ "Wall median / p99 / mean (us)" });
+	return table;
+}
+
+///////////////////////////////////////////
+
+static void frames_cpu_layers(session_frame_t *frame, void *data) {
+	frames_cpu_run_t *run   = (frames_cpu_run_t *)data;
+	uint32_t          count = run->config < run->config_count ? run->layer_counts[run->config] : 0;
+	if (count == 0 || XR_FAILED(run->cycle_result)) return;
+
+	// Every layer shows the same swapchain, so one image a frame will do
+	run->cycle_result = swapchain_cycle(&run->swapchain);
+	if (XR_FAILED(run->cycle_result)) return;
+	frame->layers      = run->quad_ptrs;
+	frame->layer_count = count;
+}
+
+///////////////////////////////////////////
+
+static bool frames_cpu_record(const session_frame_t *frame, void *data) {
+	frames_cpu_run_t *run = (frames_cpu_run_t *)data;
+	// The runtime may still want a few frames on the way out
+	if (run->config >= run->config_count) return false;
+
+	if (run->warmup < 0) {
+		if (frame->session_state == XR_SESSION_STATE_FOCUSED) run->warmup = frames_cpu_warmup;
+		return true;
+	}
+	if (run->warmup > 0) { run->warmup -= 1; return true; }
+
+	// Frames the runtime didn't want rendered submitted no layers, so they
+	// don't belong with the others
+	int32_t c = run->config;
+	if (frame->layer_count != run->layer_counts[c] || (c > 0 && !frame->state.shouldRender)) {
+		run->unrendered[c] += 1;
+		return run->unrendered[c] < run->frames;
+	}
+
+	frames_cpu_sample_t *sample = &run->samples[c][run->counts[c]++];
+	sample->wait_cpu   = frame->wait_cpu  / 1000.0f;
+	sample->begin_cpu  = frame->begin_cpu / 1000.0f;
+	sample->end_cpu    = frame->end_cpu   / 1000.0f;
+	sample->wait_wall  = (float)stm_us(stm_diff(frame->wait_end,  frame->wait_start ));
+	sample->begin_wall = (float)stm_us(stm_diff(frame->begin_end, frame->begin_start));
+	sample->end_wall   = (float)stm_us(stm_diff(frame->end_end,   frame->end_start  ));
+
+	if (run->counts[c] >= run->frames) {
+		run->config += 1;
+		run->warmup  = frames_cpu_warmup;
+	}
+	return run->config < run->config_count;
+}
+
+///////////////////////////////////////////
+
+static void frames_cpu_report(const frames_cpu_run_t *run, const char *swapchain_error) {
+	display_table_t table = frames_cpu_table();
+
+	const char *call_names[] = { "xrWaitFrame", "xrBeginFrame", "xrEndFrame", "All three" };
+	float      *cpu          = (float *)malloc(sizeof(float) * run->frames);
+	float      *wall         = (float *)malloc(sizeof(float) * run->frames);
+	for (int32_t c = 0; c < run->config_count; c++) {
+		int32_t count = run->counts[c];
+		if (count == 0) continue;
+
+		for (int32_t call = 0; call < 4; call++) {
+			double cpu_sum  = 0;
+			double wall_sum = 0;
+			for (int32_t i = 0; i < count; i++) {
+				const frames_cpu_sample_t *s = &run->samples[c][i];
+				switch (call) {
+				case 0:  cpu[i] = s->wait_cpu;  wall[i] = s->wait_wall;  break;
+				case 1:  cpu[i] = s->begin_cpu; wall[i] = s->begin_wall; break;
+				case 2:  cpu[i] = s->end_cpu;   wall[i] = s->end_wall;   break;
+				default: cpu[i] = s->wait_cpu  + s->begin_cpu  + s->end_cpu;
+				         wall[i] = s->wait_wall + s->begin_wall + s->end_wall; break;
+				}
+				cpu_sum  += cpu[i];
+				wall_sum += wall[i];
+			}
+			qsort(cpu,  count, sizeof(float), stats_float_cmp);
+			qsort(wall, count, sizeof(float), stats_float_cmp);
+
+			table.cols[0].add({ new_string("%s, %u layer%s", call_names[call], run->layer_counts[c], run->layer_counts[c] == 1 ? "" : "s") });
+			table.cols[1].add({ new_string("%.1f / %.1f / %.1f", stats_percentile(cpu,  count, 0.5f), stats_percentile(cpu,  count, 0.99f), cpu_sum  / count) });
+			table.cols[2].add({ new_string("%.1f / %.1f / %.1f", stats_percentile(wall, count, 0.5f), stats_percentile(wall, count, 0.99f), wall_sum / count) });
+		}
+	}
+	free(cpu);
+	free(wall);
+
+	if (swapchain_error)
+		table.error = new_string("Only measured without layers: %s", swapchain_error);
+	else if (run->config < run->config_count)
+		table.error = new_string("Stopped early, %d frames with %u layers measured", run->counts[run->config], run->layer_counts[run->config]);
+	xr_tables.add(table);
+}
+
+///////////////////////////////////////////
+
+void frames_experiments(xr_settings_t settings, int32_t frames) {
+	settings = session_settings(settings);
+
+	const char *error = openxr_runtime_open(settings);
+	if (error) {
+		openxr_runtime_close();
+		display_table_t table = frames_experiment_table();
+		table.error = new_string("Couldn't open the runtime: %s", error);
+		xr_tables.add(table);
+		return;
+	}
+
+	frames_experiment_t exp = {};
+	exp.frames        = frames;
+	exp.applied_rate  = -1;
+	exp.applied_level = -1;
+
+	// What the runtime lets us change, each only if its extension is on
+	PFN_xrEnumerateDisplayRefreshRatesFB enumerate_rates = nullptr;
+	if (XR_SUCCEEDED(xrGetInstanceProcAddr(xr_instance, "xrEnumerateDisplayRefreshRatesFB", (PFN_xrVoidFunction *)&enumerate_rates)) &&
+		XR_SUCCEEDED(xrGetInstanceProcAddr(xr_instance, "xrRequestDisplayRefreshRateFB",    (PFN_xrVoidFunction *)&exp.request_rate))) {
+		uint32_t count = 0;
+		if (XR_SUCCEEDED(enumerate_rates(xr_session, 0, &count, nullptr)) && count > 0) {
+			uint32_t max = sizeof(exp.rates) / sizeof(exp.rates[0]);
+			float   *all = (float *)malloc(sizeof(float) * count);
+			enumerate_rates(xr_session, count, &count, all);
+			exp.rate_count = (int32_t)(count < max ? count : max);
+			memcpy(exp.rates, all, sizeof(float) * exp.rate_count);
+			free(all);
+		}
+	}
+	XrViewConfigurationType view_config = session_view_config(settings);
+	PFN_xrEnumerateReprojectionModesMSFT enumerate_modes = nullptr;
+	if (XR_SUCCEEDED(xrGetInstanceProcAddr(xr_instance, "xrEnumerateReprojectionModesMSFT", (PFN_xrVoidFunction *)&enumerate_modes))) {
+		uint32_t count = 0;
+		if (XR_SUCCEEDED(enumerate_modes(xr_instance, xr_system_id, view_config, 0, &count, nullptr)) && count > 0) {
+			uint32_t                max = sizeof(exp.modes) / sizeof(exp.modes[0]);
+			XrReprojectionModeMSFT *all = (XrReprojectionModeMSFT *)malloc(sizeof(XrReprojectionModeMSFT) * count);
+			enumerate_modes(xr_instance, xr_system_id, view_config, count, &count, all);
+			exp.mode_count = (int32_t)(count < max ? count : max);
+			memcpy(exp.modes, all, sizeof(XrReprojectionModeMSFT) * exp.mode_count);
+			free(all);
+		}
+	}
+	if (XR_SUCCEEDED(xrGetInstanceProcAddr(xr_instance, "xrPerfSettingsSetPerformanceLevelEXT", (PFN_xrVoidFunction *)&exp.set_level)))
+		exp.level_count = sizeof(frames_levels) / sizeof(frames_levels[0]);
+
+	// A projection layer, like an app would submit, which is also what
+	// the reprojection mode rides along on
+	XrSpace     space      = XR_NULL_HANDLE;
+	const char *layer_note = nullptr;
+	XrReferenceSpaceCreateInfo space_info = { XR_TYPE_REFERENCE_SPACE_CREATE_INFO };
+	space_info.referenceSpaceType   = XR_REFERENCE_SPACE_TYPE_LOCAL;
+	space_info.poseInReferenceSpace = { {0,0,0,1}, {0,0,0} };
+	XrResult result = xrCreateReferenceSpace(xr_session, &space_info, &space);
+	if (XR_FAILED(result)) layer_note = new_string("xrCreateReferenceSpace: %s", openxr_result_string(result));
+	else                   layer_note = swapchain_projection_create(&exp.projection, view_config, space);
+	exp.has_projection = layer_note == nullptr;
+	exp.layer_ptr      = (const XrCompositionLayerBaseHeader *)&exp.projection.layer;
+	exp.reprojection   = { XR_TYPE_COMPOSITION_LAYER_REPROJECTION_INFO_MSFT };
+	if (!exp.has_projection) exp.mode_count = 0;
+
+	// Refresh rate outermost, since it's the slow one to change
+	int32_t rates  = exp.rate_count  > 0 ? exp.rate_count  : 1;
+	int32_t modes  = exp.mode_count  > 0 ? exp.mode_count  : 1;
+	int32_t levels = exp.level_count > 0 ? exp.level_count : 1;
+	exp.combo_count = rates * modes * levels;
+	exp.combos      = (frames_combo_t  *)malloc(sizeof(frames_combo_t ) * exp.combo_count);
+	exp.records     = (frames_pacing_t *)malloc(sizeof(frames_pacing_t) * exp.combo_count * frames);
+	exp.cpu_us      = (float           *)malloc(sizeof(float          ) * exp.combo_count * frames);
+	int32_t c = 0;
+	for (int32_t r = 0; r < rates;  r++) {
+	for (int32_t l = 0; l < levels; l++) {
+	for (int32_t m = 0; m < modes;  m++) {
+		frames_combo_t *combo = &exp.combos[c];
+		combo->rate  = exp.rate_count  > 0 ? r : -1;
+		combo->level = exp.level_count > 0 ? l : -1;
+		combo->mode  = exp.mode_count  > 0 ? m : -1;
+		combo->first = c * frames;
+		combo->count = 0;
+		c += 1;
+	} } }
+
+	session_hooks_t hooks = {};
+	hooks.data        = &exp;
+	hooks.measure_cpu = true;
+	hooks.on_layers   = frames_experiment_layers;
+	hooks.on_frame    = frames_experiment_frame;
+	if (session_start(settings, hooks)) {
+		// Generous, so 30Hz still finishes, plus time for rates to settle
+		float expected_s = exp.combo_count * ((frames + frames_cpu_warmup) / 30.0f) + rates * frames_settle_timeout_s;
+		session_wait(expected_s + frames_focus_timeout_s);
+		session_stop();
+	}
+	session_info_t info = session_info();
+
+	if (info.error || exp.combos[0].count == 0) {
+		display_table_t table = frames_experiment_table();
+		table.error = info.error ? info.error : "The session never got to FOCUSED";
+		xr_tables.add(table);
+	} else {
+		frames_experiment_report(&exp, layer_note);
+	}
+
+	free(exp.combos);
+	free(exp.records);
+	free(exp.cpu_us);
+	swapchain_projection_destroy(&exp.projection);
+	if (space != XR_NULL_HANDLE) xrDestroySpace(space);
+	openxr_runtime_close();
+}
+
+///////////////////////////////////////////
+
+static display_table_t frames_experiment_table() {
+	display_table_t table = {};
+	table.name_func    = "frameExperiments";
+	table.name_type    = "frameExperimentMatrix";
+	table.spec         = "XR_FB_display_refresh_rate";
+	table.tag          = display_tag_misc;
+	table.column_count = 3;
+	table.header_row   = true;
+	table.cols[0].add({ "Refresh rate, reprojection, performance level" });
+	table.cols[1].add({ "Measured Hz, jitter p50 / p99 (ms), missed" });
+	table.cols[2].add({ "Frame call CPU median / p99 (us)" });
+	return table;
+}
+
+///////////////////////////////////////////
+
+static void frames_experiment_layers(session_frame_t *frame, void *data) {
+	frames_experiment_t *exp = (frames_experiment_t *)data;
+	if (!exp->has_projection || XR_FAILED(exp->layer_result)) return;
+
+	exp->layer_result = swapchain_projection_update(&exp->projection, frame->state.predictedDisplayTime);
+	if (XR_FAILED(exp->layer_result)) return;
+
+	// The reprojection mode goes with every frame, so it takes no time to
+	// switch
+	int32_t mode = exp->combo < exp->combo_count ? exp->combos[exp->combo].mode : -1;
+	if (mode >= 0) {
+		exp->reprojection.reprojectionMode = exp->modes[mode];
+		exp->projection.layer.next         = &exp->reprojection;
+	} else {
+		exp->projection.layer.next         = nullptr;
+	}
+	frame->layers      = &exp->layer_ptr;
+	frame->layer_count = 1;
+}
+
+///////////////////////////////////////////
+
+static bool frames_experiment_frame(const session_frame_t *frame, void *data) {
+	frames_experiment_t *exp = (frames_experiment_t *)data;
+	if (exp->combo >= exp->combo_count) return false;
+	frames_combo_t *combo = &exp->combos[exp->combo];
+
+	switch (exp->phase) {
+	case frames_phase_focus: {
+		if (frame->session_state == XR_SESSION_STATE_FOCUSED) exp->phase = frames_phase_apply;
+	} break;
+	case frames_phase_apply: {
+		if (combo->rate >= 0 && combo->rate != exp->applied_rate) {
+			uint64_t start  = stm_now();
+			XrResult result = exp->request_rate(xr_session, exp->rates[combo->rate]);
+			frames_apply_t *apply = &exp->rate_apply[combo->rate];
+			apply->call_ms += stm_ms(stm_since(start));
+			apply->count   += 1;
+			if (XR_FAILED(result) && XR_SUCCEEDED(exp->apply_result)) exp->apply_result = result;
+			exp->applied_rate   = combo->rate;
+			exp->settling       = XR_SUCCEEDED(result);
+			exp->rate_requested = start;
+			exp->rate_target_ms = 1000.0 / exp->rates[combo->rate];
+		}
+		if (combo->level >= 0 && combo->level != exp->applied_level) {
+			uint64_t start  = stm_now();
+			XrResult result = exp->set_level(xr_session, XR_PERF_SETTINGS_DOMAIN_CPU_EXT, frames_levels[combo->level]);
+			if (XR_SUCCEEDED(result))
+				result = exp->set_level(xr_session, XR_PERF_SETTINGS_DOMAIN_GPU_EXT, frames_levels[combo->level]);
+			frames_apply_t *apply = &exp->level_apply[combo->level];
+			apply->call_ms += stm_ms(stm_since(start));
+			apply->count   += 1;
+			if (XR_FAILED(result) && XR_SUCCEEDED(exp->apply_result)) exp->apply_result = result;
+			exp->applied_level = combo->level;
+		}
+		exp->warmup = frames_cpu_warmup;
+		exp->phase  = frames_phase_settle;
+	} break;
+	case frames_phase_settle: {
+		// A new refresh rate has settled once the runtime predicts with it
+		if (exp->settling) {
+			double period_ms = frame->state.predictedDisplayPeriod / 1000000.0;
+			double since_ms  = stm_ms(stm_since(exp->rate_requested));
+			if (fabs(period_ms - exp->rate_target_ms) < exp->rate_target_ms * 0.02) {
+				frames_apply_t *apply = &exp->rate_apply[combo->rate];
+				apply->settle_ms += since_ms;
+				apply->settled   += 1;
+				exp->settling     = false;
+			} else if (since_ms > frames_settle_timeout_s * 1000) {
+				exp->settling = false;
+			}
+		}
+		if (exp->warmup > 0) exp->warmup -= 1;
+		if (exp->warmup == 0 && !exp->settling) exp->phase = frames_phase_measure;
+	} break;
+	case frames_phase_measure: {
+		int32_t          at  = combo->first + combo->count;
+		frames_pacing_t *rec = &exp->records[at];
+		rec->frame            = frame->index;
+		rec->session_state    = frame->session_state;
+		rec->should_render    = frame->state.shouldRender == XR_TRUE;
+		rec->predicted_time   = frame->state.predictedDisplayTime;
+		rec->predicted_period = frame->state.predictedDisplayPeriod;
+		rec->wait_start       = frame->wait_start;
+		rec->wait_return      = frame->wait_end;
+		rec->wait_return_xr   = 0;
+		exp->cpu_us[at]       = (frame->wait_cpu + frame->begin_cpu + frame->end_cpu) / 1000.0f;
+		combo->count += 1;
+
+		if (combo->count >= exp->frames) {
+			exp->combo += 1;
+			exp->phase  = frames_phase_apply;
+		}
+	} break;
+	}
+	return exp->combo < exp->combo_count;
+}
+
+///////////////////////////////////////////
+
+static void frames_experiment_report(const frames_experiment_t *exp, const char *layer_note) {
+	display_table_t matrix = frames_experiment_table();
+
+	float *cpu = (float *)malloc(sizeof(float) * exp->frames);
+	for (int32_t c = 0; c < exp->combo_count; c++) {
+		const frames_combo_t *combo = &exp->combos[c];
+		if (combo->count < 2) continue;
+
+		frames_pacing_stats_t stats = frames_pacing_stats(&exp->records[combo->first], combo->count);
+		memcpy(cpu, &exp->cpu_us[combo->first], sizeof(float) * combo->count);
+		qsort(cpu, combo->count, sizeof(float), stats_float_cmp);
+
+		matrix.cols[0].add({ new_string("%s, %s, %s",
+			combo->rate  >= 0 ? new_string("%.2f Hz", exp->rates[combo->rate]) : "Default rate",
+			combo->mode  >= 0 ? frames_mode_str (exp->modes[combo->mode])       : "Default reprojection",
+			combo->level >= 0 ? frames_level_str(frames_levels[combo->level])    : "Default level") });
+		matrix.cols[1].add({ new_string("%.2f, %.3f / %.3f, %d", stats.measured_hz, stats.wake_jitter[0], stats.wake_jitter[1], stats.missed) });
+		matrix.cols[2].add({ new_string("%.1f / %.1f", stats_percentile(cpu, combo->count, 0.5f), stats_percentile(cpu, combo->count, 0.99f)) });
+	}
+	free(cpu);
+
+	if (exp->combo < exp->combo_count)
+		matrix.error = new_string("Stopped early, %d of %d combinations measured", exp->combo, exp->combo_count);
+	else if (XR_FAILED(exp->apply_result))
+		matrix.error = new_string("A setting failed to apply: %s", openxr_result_string(exp->apply_result));
+	else if (XR_FAILED(exp->layer_result))
+		matrix.error = new_string("Projection layer: %s", openxr_result_string(exp->layer_result));
+	else if (layer_note)
+		matrix.error = new_string("Ran without layers, so reprojection modes were left out: %s", layer_note);
+	xr_tables.add(matrix);
+
+	display_table_t apply = {};
+	apply.name_func    = "frameExperiments";
+	apply.name_type    = "frameExperimentApply";
+	apply.spec         = "XR_EXT_performance_settings";
+	apply.tag          = display_tag_misc;
+	apply.column_count = 3;
+	apply.header_row   = true;
+	apply.cols[0].add({ "Setting" });
+	apply.cols[1].add({ "Call (ms, mean)" });
+	apply.cols[2].add({ "Predicting with it after (ms, mean)" });
+	for (int32_t r = 0; r < exp->rate_count; r++) {
+		const frames_apply_t *a = &exp->rate_apply[r];
+		if (a->count == 0) continue;
+		apply.cols[0].add({ new_string("xrRequestDisplayRefreshRateFB %.2f Hz", exp->rates[r]) });
+		apply.cols[1].add({ new_string("%.3f", a->call_ms / a->count) });
+		apply.cols[2].add({ a->settled > 0
+			? new_string("%.1f (%d of %d)", a->settle_ms / a->settled, a->settled, a->count)
+			: new_string("Never, within %.0f s", frames_settle_timeout_s) });
+	}
+	for (int32_t l = 0; l < exp->level_count; l++) {
+		const frames_apply_t *a = &exp->level_apply[l];
+		if (a->count == 0) continue;
+		apply.cols[0].add({ new_string("xrPerfSettingsSetPerformanceLevelEXT %s", frames_level_str(frames_levels[l])) });
+		apply.cols[1].add({ new_string("%.3f", a->call_ms / a->count) });
+		apply.cols[2].add({ "-" });
+	}
+	if (exp->rate_count == 0 && exp->level_count == 0)
+		apply.error = "The runtime offers neither XR_FB_display_refresh_rate nor XR_EXT_performance_settings";
+	xr_tables.add(apply);
+}
+
+///////////////////////////////////////////
+
+void frames_layers(xr_settings_t settings, int32_t frames) {
+	settings = session_settings(settings);
+
+	const char *error = openxr_runtime_open(settings);
+	if (error) {
+		openxr_runtime_close();
+		display_table_t table = frames_layer_table();
+		table.error = new_string("Couldn't open the runtime: %s", error);
+		xr_tables.add(table);
+		return;
+	}
+
+	frames_layer_run_t run = {};
+	run.frames = frames;
+	run.warmup = -1;
+
+	XrSystemProperties properties = { XR_TYPE_SYSTEM_PROPERTIES };
+	xrGetSystemProperties(xr_instance, xr_system_id, &properties);
+	uint32_t max_layers = properties.graphicsProperties.maxLayerCount;
+
+	// Why each layer type was left out, null for the ones that weren't
+	const char *notes[frames_layer_count] = {};
+	XrSpace     space = XR_NULL_HANDLE;
+	XrReferenceSpaceCreateInfo space_info = { XR_TYPE_REFERENCE_SPACE_CREATE_INFO };
+	space_info.referenceSpaceType   = XR_REFERENCE_SPACE_TYPE_VIEW;
+	space_info.poseInReferenceSpace = { {0,0,0,1}, {0,0,0} };
+	XrResult result = xrCreateReferenceSpace(xr_session, &space_info, &space);
+	const char *space_error = XR_FAILED(result) ? new_string("xrCreateReferenceSpace: %s", openxr_result_string(result)) : nullptr;
+
+	notes[frames_layer_projection] = space_error ? space_error : swapchain_projection_create(&run.projection, session_view_config(settings), space);
+	notes[frames_layer_quad]       = space_error ? space_error : swapchain_create(&run.swapchain, 256, 256);
+	notes[frames_layer_cylinder]   = notes[frames_layer_quad];
+	notes[frames_layer_cube]       = space_error ? space_error : swapchain_create_cube(&run.cube_swapchain, 256);
+	if (!openxr_has_ext(XR_KHR_COMPOSITION_LAYER_CYLINDER_EXTENSION_NAME)) notes[frames_layer_cylinder] = "No " XR_KHR_COMPOSITION_LAYER_CYLINDER_EXTENSION_NAME;
+	if (!openxr_has_ext(XR_KHR_COMPOSITION_LAYER_CUBE_EXTENSION_NAME))     notes[frames_layer_cube]     = "No " XR_KHR_COMPOSITION_LAYER_CUBE_EXTENSION_NAME;
+
+	if (max_layers > 0) {
+		run.projections = (XrCompositionLayerProjection  *)malloc(sizeof(XrCompositionLayerProjection)  * max_layers);
+		run.quads       = (XrCompositionLayerQuad        *)malloc(sizeof(XrCompositionLayerQuad)        * max_layers);
+		run.cylinders   = (XrCompositionLayerCylinderKHR *)malloc(sizeof(XrCompositionLayerCylinderKHR) * max_layers);
+		run.cubes       = (XrCompositionLayerCubeKHR     *)malloc(sizeof(XrCompositionLayerCubeKHR)     * max_layers);
+		for (int32_t t = 0; t < frames_layer_count; t++)
+			run.layer_ptrs[t] = (const XrCompositionLayerBaseHeader **)malloc(sizeof(XrCompositionLayerBaseHeader *) * max_layers);
+	}
+	// Every projection layer shares the one set of views that
+	// swapchain_projection_update locates, and blends, so none of them
+	// hides the others
+	if (!notes[frames_layer_projection]) {
+		for (uint32_t i = 0; i < max_layers; i++) {
+			run.projections[i] = run.projection.layer;
+			run.projections[i].layerFlags = XR_COMPOSITION_LAYER_BLEND_TEXTURE_SOURCE_ALPHA_BIT;
+			run.layer_ptrs[frames_layer_projection][i] = (const XrCompositionLayerBaseHeader *)&run.projections[i];
+		}
+	}
+	if (!notes[frames_layer_quad])     swapchain_quads    (&run.swapchain,      space, run.quads,     run.layer_ptrs[frames_layer_quad],     max_layers);
+	if (!notes[frames_layer_cylinder]) swapchain_cylinders(&run.swapchain,      space, run.cylinders, run.layer_ptrs[frames_layer_cylinder], max_layers);
+	if (!notes[frames_layer_cube])     swapchain_cubes    (&run.cube_swapchain, space, run.cubes,     run.layer_ptrs[frames_layer_cube],     max_layers);
+
+	// No layers first, then 1, 2, 4... and maxLayerCount of each type
+	int32_t counts_per_type = 1;
+	for (uint32_t n = 1; n < max_layers; n *= 2) counts_per_type += 1;
+	run.steps = (frames_layer_step_t *)malloc(sizeof(frames_layer_step_t) * (1 + frames_layer_count * counts_per_type));
+	run.steps[run.step_count++] = { frames_layer_projection, 0 };
+	for (int32_t t = 0; t < frames_layer_count; t++) {
+		if (notes[t] || max_layers == 0) continue;
+		for (uint32_t n = 1; n < max_layers; n *= 2)
+			run.steps[run.step_count++] = { (frames_layer_)t, n };
+		run.steps[run.step_count++] = { (frames_layer_)t, max_layers };
+	}
+	for (int32_t i = 0; i < run.step_count; i++) run.steps[i].first = i * frames;
+	run.records  = (frames_pacing_t *)malloc(sizeof(frames_pacing_t) * run.step_count * frames);
+	run.end_cpu  = (float           *)malloc(sizeof(float)           * run.step_count * frames);
+	run.end_wall = (float           *)malloc(sizeof(float)           * run.step_count * frames);
+
+	session_hooks_t hooks = {};
+	hooks.data        = &run;
+	hooks.measure_cpu = true;
+	hooks.on_layers   = frames_layer_layers;
+	hooks.on_frame    = frames_layer_frame;
+	if (session_start(settings, hooks)) {
+		// Generous, so a 30Hz runtime still finishes, even when it drops
+		// frames under the heaviest counts
+		float expected_s = (run.step_count * (frames + frames_cpu_warmup)) / 30.0f;
+		session_wait(expected_s * 2 + frames_focus_timeout_s);
+		session_stop();
+	}
+	session_info_t info = session_info();
+
+	if (run.steps[0].measured == 0) {
+		display_table_t table = frames_layer_table();
+		table.error = info.error ? info.error : "The session never got to FOCUSED";
+		xr_tables.add(table);
+	} else {
+		// A runtime refusing some count in xrEndFrame is a result in
+		// itself, so everything before it still gets reported
+		frames_layer_report(&run, notes, info.error);
+	}
+
+	for (int32_t t = 0; t < frames_layer_count; t++) free(run.layer_ptrs[t]);
+	free(run.projections);
+	free(run.quads);
+	free(run.cylinders);
+	free(run.cubes);
+	free(run.steps);
+	free(run.records);
+	free(run.end_cpu);
+	free(run.end_wall);
+	swapchain_projection_destroy(&run.projection);
+	swapchain_destroy(&run.swapchain);
+	swapchain_destroy(&run.cube_swapchain);
+	if (space != XR_NULL_HANDLE) xrDestroySpace(space);
+	openxr_runtime_close();
+}
+
+///////////////////////////////////////////
+
+static display_table_t frames_layer_table() {
+	display_table_t table = {};
+	table.name_func    = "frameLayers";
+	table.name_type    = "frameLayerCost";
+	table.spec         = "XrSystemGraphicsProperties";
+	table.tag          = display_tag_misc;
+	table.column_count = 3;
+	table.header_row   = true;
+	table.cols[0].add({ "Layers" });
+	table.cols[1].add({ "xrEndFrame CPU p50 / p99, wall p50 (us), CPU per added layer" });
+	table.cols[2].add({ "Measured Hz, jitter p99 (ms), missed" });
+	return table;
+}
+
+///////////////////////////////////////////
+
+static void frames_layer_layers(session_frame_t *frame, void *data) {
+	frames_layer_run_t *run = (frames_layer_run_t *)data;
+	if (run->step >= run->step_count) return;
+	const frames_layer_step_t *step = &run->steps[run->step];
+	if (step->count == 0 || XR_FAILED(run->results[step->type])) return;
+
+	// Every layer of a type shows the same swapchain, so one image a
+	// frame will do
+	XrResult result = XR_SUCCESS;
+	switch (step->type) {
+	case frames_layer_projection: result = swapchain_projection_update(&run->projection, frame->state.predictedDisplayTime); break;
+	case frames_layer_quad:
+	case frames_layer_cylinder:   result = swapchain_cycle(&run->swapchain);      break;
+	case frames_layer_cube:       result = swapchain_cycle(&run->cube_swapchain); break;
+	default: break;
+	}
+	if (XR_FAILED(result)) { run->results[step->type] = result; return; }
+
+	frame->layers      = run->layer_ptrs[step->type];
+	frame->layer_count = step->count;
+}
+
+///////////////////////////////////////////
+
+static bool frames_layer_frame(const session_frame_t *frame, void *data) {
+	frames_layer_run_t *run = (frames_layer_run_t *)data;
+	// The runtime may still want a few frames on the way out
+	if (run->step >= run->step_count) return false;
+
+	if (run->warmup < 0) {
+		if (frame->session_state == XR_SESSION_STATE_FOCUSED) run->warmup = frames_cpu_warmup;
+		return true;
+	}
+	if (run->warmup > 0) { run->warmup -= 1; return true; }
+
+	// A type whose swapchain stopped cycling has nothing left to measure
+	frames_layer_step_t *step = &run->steps[run->step];
+	if (step->count > 0 && XR_FAILED(run->results[step->type])) {
+		while (run->step < run->step_count && run->steps[run->step].type == step->type) run->step += 1;
+		run->warmup = frames_cpu_warmup;
+		return run->step < run->step_count;
+	}
+
+	int32_t          at  = step->first + step->measured;
+	frames_pacing_t *rec = &run->records[at];
+	rec->frame            = frame->index;
+	rec->session_state    = frame->session_state;
+	rec->should_render    = frame->state.shouldRender == XR_TRUE;
+	rec->predicted_time   = frame->state.predictedDisplayTime;
+	rec->predicted_period = frame->state.predictedDisplayPeriod;
+	rec->wait_start       = frame->wait_start;
+	rec->wait_return      = frame->wait_end;
+	rec->wait_return_xr   = 0;
+	// Frames the runtime didn't want rendered submitted no layers, so they
+	// count for pacing, but not for what the layers cost
+	bool submitted = frame->layer_count == step->count && (step->count == 0 || frame->state.shouldRender);
+	run->end_cpu [at] = submitted ? frame->end_cpu / 1000.0f : -1;
+	run->end_wall[at] = submitted ? (float)stm_us(stm_diff(frame->end_end, frame->end_start)) : -1;
+	step->measured += 1;
+
+	if (step->measured >= run->frames) {
+		run->step  += 1;
+		run->warmup = frames_cpu_warmup;
+	}
+	return run->step < run->step_count;
+}
+
+///////////////////////////////////////////
+
+static void frames_layer_report(const frames_layer_run_t *run, const char **notes, const char *stop_error) {
+	display_table_t table = frames_layer_table();
+
+	float *cpu  = (float *)malloc(sizeof(float) * run->frames);
+	float *wall = (float *)malloc(sizeof(float) * run->frames);
+	float    baseline_p50 = 0;
+	float    prev_p50     = 0;
+	uint32_t prev_count   = 0;
+	float    first_cost   = 0;
+	bool     bent         = false;
+	for (int32_t s = 0; s < run->step_count; s++) {
+		const frames_layer_step_t *step = &run->steps[s];
+		if (step->count <= 1) {
+			prev_p50   = baseline_p50;
+			prev_count = 0;
+			first_cost = 0;
+			bent       = false;
+		}
+		if (step->measured < 2) continue;
+
+		int32_t count = 0;
+		for (int32_t i = 0; i < step->measured; i++) {
+			if (run->end_cpu[step->first + i] < 0) continue;
+			cpu [count] = run->end_cpu [step->first + i];
+			wall[count] = run->end_wall[step->first + i];
+			count += 1;
+		}
+		frames_pacing_stats_t stats = frames_pacing_stats(&run->records[step->first], step->measured);
+
+		table.cols[0].add({ step->count == 0
+			? "None"
+			: new_string("%s x%u", frames_layer_names[step->type], step->count) });
+		table.cols[2].add({ new_string("%.2f, %.3f, %d", stats.measured_hz, stats.wake_jitter[1], stats.missed) });
+		if (count == 0) {
+			table.cols[1].add({ "Never rendered" });
+			continue;
+		}
+		qsort(cpu,  count, sizeof(float), stats_float_cmp);
+		qsort(wall, count, sizeof(float), stats_float_cmp);
+		float p50 = stats_percentile(cpu, count, 0.5f);
+
+		// What each layer added since the count before it. Where that
+		// jumps past frames_bend_ratio times what the first layer cost,
+		// the runtime's composition cost stops being linear.
+		const char *added = "";
+		if (step->count == 0) {
+			baseline_p50 = p50;
+		} else {
+			float per_layer = (p50 - prev_p50) / (step->count - prev_count);
+			if (prev_count == 0) first_cost = per_layer > 1 ? per_layer : 1;
+			bool bends = !bent && prev_count > 0 && per_layer > first_cost * frames_bend_ratio;
+			bent       = bent || bends;
+			added      = new_string(", %+.1f a layer%s", per_layer, bends ? ", bends here" : "");
+			prev_p50   = p50;
+			prev_count = step->count;
+		}
+		table.cols[1].add({ new_string("%.1f / %.1f, %.1f%s",
+			p50, stats_percentile(cpu, count, 0.99f), stats_percentile(wall, count, 0.5f), added) });
+	}
+	free(cpu);
+	free(wall);
+
+	// Which types never made it into the table, and why, with the types
+	// that share a reason listed together
+	const char *reasons[frames_layer_count] = {};
+	for (int32_t t = 0; t < frames_layer_count; t++)
+		reasons[t] = notes[t] ? notes[t] : XR_FAILED(run->results[t]) ? openxr_result_string(run->results[t]) : nullptr;
+	char   left_out[512] = "";
+	size_t used = 0;
+	for (int32_t t = 0; t < frames_layer_count && used < sizeof(left_out); t++) {
+		bool listed = false;
+		for (int32_t p = 0; p < t; p++) listed = listed || (reasons[p] && reasons[t] && strcmp(reasons[p], reasons[t]) == 0);
+		if (!reasons[t] || listed) continue;
+
+		used += snprintf(left_out + used, sizeof(left_out) - used, "%s%s", used > 0 ? "; " : "", frames_layer_names[t]);
+		for (int32_t o = t + 1; o < frames_layer_count && used < sizeof(left_out); o++) {
+			if (reasons[o] && strcmp(reasons[o], reasons[t]) == 0)
+				used += snprintf(left_out + used, sizeof(left_out) - used, ", %s", frames_layer_names[o]);
+		}
+		if (used < sizeof(left_out))
+			used += snprintf(left_out + used, sizeof(left_out) - used, ": %s", reasons[t]);
+	}
+	if (stop_error && run->step < run->step_count)
+		table.error = new_string("Stopped at %s x%u: %s", frames_layer_names[run->steps[run->step].type], run->steps[run->step].count, stop_error);
+	else if (run->step < run->step_count)
+		table.error = new_string("Stopped early, %d of %d layer counts measured", run->step, run->step_count);
+	else if (used > 0)
+		table.error = new_string("Left out %s", left_out);
+	xr_tables.add(table);
+}
+
+///////////////////////////////////////////
+
+static const char *frames_mode_str(XrReprojectionModeMSFT mode) {
+	switch (mode) {
+#define ENTRY(NAME, VALUE) \
+	case VALUE: return #NAME;
+		XR_LIST_ENUM_XrReprojectionModeMSFT(ENTRY)
+#undef ENTRY
+	default: return "Unknown";
+	}
+}
+
+///////////////////////////////////////////
+
+static const char *frames_level_str(XrPerfSettingsLevelEXT level) {
+	switch (level) {
+#define ENTRY(NAME, VALUE) \
+	case VALUE: return #NAME;
+		XR_LIST_ENUM_XrPerfSettingsLevelEXT(ENTRY)
+#undef ENTRY
+	default: return "Unknown";
+	}
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "openxr_info.h"
+
+#include <stdint.h>
+
+// Measurements taken from inside a running session's frame loop, see
+// openxr_session.h. Each one opens the runtime, runs the session for a
+// while, adds its tables to xr_tables, and closes everything again.
+// Headless sessions run these too, but a headless runtime has no display
+// to pace against, so only a real compositor gives meaningful numbers.
+
+/*** Signatures **************************/
+
+// Records every frame's XrFrameState and when xrWaitFrame returned, for
+// `seconds` once the session is FOCUSED, and reports the wake-up interval
+// histogram, jitter percentiles, missed and duplicated predicted display
+// times, and drift against the runtime's own predictedDisplayPeriod. If
+// csv_file isn't null, every frame is also written there.
+void frames_pacing(xr_settings_t settings, float seconds, const char *csv_file);
+
+// Reads the session thread's CPU clock around xrWaitFrame, xrBeginFrame
+// and xrEndFrame, so blocking in xrWaitFrame doesn't count, and reports
+// its distribution next to wall time. `frames` frames are measured with no
+// layers, with one quad layer, and with maxLayerCount of them, after a
+// short warm-up for each. Without swapchains (headless), only no layers.
+void frames_cpu   (xr_settings_t settings, int32_t frames);
+
+// Runs `frames` frames for every combination of the refresh rates from
+// XR_FB_display_refresh_rate, the reprojection modes from
+// XR_MSFT_composition_layer_reprojection, and the XR_EXT_performance_settings
+// levels the runtime offers, and compares their pacing and frame call CPU
+// cost. Also times each setting change, and for refresh rates, how long
+// until the runtime predicts frames with the new period.
+void frames_experiments(xr_settings_t settings, int32_t frames);
+
+// Submits 1, 2, 4... up to maxLayerCount projection, quad, cylinder
+// (XR_KHR_composition_layer_cylinder) and cube (XR_KHR_composition_layer_cube)
+// layers, one type at a time, for `frames` frames at each count, and
+// reports xrEndFrame's CPU cost and the pacing at each against no layers.
+// Each count's cost per added layer shows where composition stops scaling
+// linearly. Without swapchains (headless, which is all the CLI has off
+// Windows), only no layers.
+void frames_layers(xr_settings_t settings, int32_t frames);
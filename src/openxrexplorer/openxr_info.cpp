@@ -1,5 +1,10 @@
 #include "openxr_info.h"
 #include "openxr_properties.h"
+#include "openxr_footprint.h"
+#include "app_perf.h"
+#include "xrruntime.h"
+#include "xrprefetch.h"
+#include "imgui/sokol_time.h"
 #if defined(__linux__) && defined(SKG_OPENGL)
 #include <X11/Xlib.h>
 #include <GL/glx.h>
@@ -63,6 +68,9 @@ XrSession   xr_session      = {};
 const char *xr_session_err  = nullptr;
 XrSystemId  xr_system_id    = {};
 const char *xr_system_err   = nullptr;
+// The XrSwapchainImage*KHR type that goes with the session's graphics
+// binding, XR_TYPE_UNKNOWN for headless
+XrStructureType xr_session_image_type = XR_TYPE_UNKNOWN;
 
 const char* xr_runtime_name = "No runtime set";
 
@@ -81,21 +89,43 @@ void            openxr_load_enums     (xr_settings_t settings);
 const char *    openxr_result_string  (XrResult result);
 void            openxr_register_enums ();
 bool            openxr_has_ext        (const char *ext_name);
+void            openxr_prefetch       (xr_prefetch_t mode);
 
 
 /*** Code ********************************/
 
 void openxr_info_reload(xr_settings_t settings) {
 	openxr_info_release();
+	perf_probe_clear();
 
+	uint64_t start = stm_now();
+	if (settings.prefetch != xr_prefetch_off) {
+		openxr_prefetch(settings.prefetch);
+		perf_probe_record("Prefetch", start); start = stm_now();
+	}
+	xr_tables.add(openxr_layer_manifest_table());
+	perf_probe_record("Layer manifests", start);
+
+	if (settings.footprint) footprint_sample(footprint_step_start);
+	start = stm_now();
 	xr_extensions = openxr_load_exts();
+	perf_probe_record("Extensions & layers", start); start = stm_now();
 	openxr_init_instance(xr_extensions.extensions, settings);
+	perf_probe_record("xrCreateInstance", start);
+	if (settings.footprint) footprint_sample(footprint_step_instance);
+	start = stm_now();
 	openxr_init_system  (settings.form);
+	perf_probe_record("xrGetSystem", start);
+	if (settings.footprint) footprint_sample(footprint_step_system);
+	start = stm_now();
 	xr_properties = openxr_load_properties();
+	perf_probe_record("Properties", start); start = stm_now();
 	xr_view       = openxr_load_view      (settings.view_config);
+	perf_probe_record("View configuration", start);
 
 	openxr_register_enums();
 	openxr_load_enums    (settings);
+	if (settings.footprint) footprint_tables();
 
 	if (xr_session) {
 		xrDestroySession(xr_session);
@@ -108,6 +138,18 @@ void openxr_info_reload(xr_settings_t settings) {
 void openxr_info_release() {
 	xr_misc_enums.each([](xr_enum_info_t &i) { i.items.free(); });
 	xr_misc_enums.free();
+
+	xr_table_strings.each(free);
+	xr_table_strings.free();
+	xr_tables.each([](display_table_t &t) {for (int32_t i=0; i<t.column_count; i++) t.cols[i].free(); });
+	xr_tables.free();
+
+	openxr_runtime_close();
+}
+
+///////////////////////////////////////////
+
+void openxr_runtime_close() {
 	xr_properties = {};
 	xr_view.available_configs     .free();
 	xr_view.available_config_names.free();
@@ -118,11 +160,6 @@ void openxr_info_release() {
 	xr_extensions = {};
 	xr_runtime_name = "No runtime set";
 
-	xr_table_strings.each(free);
-	xr_table_strings.free();
-	xr_tables.each([](display_table_t &t) {for (int32_t i=0; i<t.column_count; i++) t.cols[i].free(); });
-	xr_tables.free();
-
 	if (xr_session)  xrDestroySession (xr_session);
 	if (xr_instance) xrDestroyInstance(xr_instance);
 #if defined(XR_USE_GRAPHICS_API_D3D11)
@@ -138,6 +175,7 @@ void openxr_info_release() {
 
 	xr_session      = XR_NULL_HANDLE;
 	xr_instance     = XR_NULL_HANDLE;
+	xr_session_image_type = XR_TYPE_UNKNOWN;
 	xr_system_id    = XR_NULL_SYSTEM_ID;
 	xr_session_err  = nullptr;
 	xr_instance_err = nullptr;
@@ -146,6 +184,121 @@ void openxr_info_release() {
 
 ///////////////////////////////////////////
 
+xr_startup_times_t openxr_time_startup(xr_settings_t settings) {
+	openxr_info_release();
+	xr_startup_times_t result = {};
+
+	uint64_t start = stm_now();
+	xr_extensions = openxr_load_exts();
+	openxr_init_instance(xr_extensions.extensions, settings);
+	result.instance_ms = (float)stm_ms(stm_since(start));
+	openxr_init_system(settings.form);
+	result.system_ms   = (float)stm_ms(stm_since(start));
+	if (settings.allow_session && !xr_system_err) {
+		openxr_init_session(settings);
+		result.session_ms = (float)stm_ms(stm_since(start));
+	}
+
+	if      (xr_instance_err) result.error = xr_instance_err;
+	else if (xr_system_err  ) result.error = xr_system_err;
+	else if (settings.allow_session && xr_session_err) result.error = xr_session_err;
+
+	openxr_info_release();
+	return result;
+}
+
+///////////////////////////////////////////
+
+const char *openxr_runtime_open(xr_settings_t settings) {
+	openxr_info_release();
+	xr_extensions = openxr_load_exts();
+	openxr_init_instance(xr_extensions.extensions, settings);
+	openxr_init_system  (settings.form);
+	if (settings.allow_session && !xr_system_err)
+		openxr_init_session(settings);
+
+	if (xr_instance_err) return xr_instance_err;
+	if (xr_system_err  ) return xr_system_err;
+	if (settings.allow_session && xr_session_err) return xr_session_err;
+	return nullptr;
+}
+
+///////////////////////////////////////////
+
+int32_t openxr_poll_events() {
+	if (xr_instance == XR_NULL_HANDLE) return 0;
+
+	int32_t           count = 0;
+	XrEventDataBuffer event = { XR_TYPE_EVENT_DATA_BUFFER };
+	while (xrPollEvent(xr_instance, &event) == XR_SUCCESS) {
+		count += 1;
+		event = { XR_TYPE_EVENT_DATA_BUFFER };
+	}
+	return count;
+}
+
+///////////////////////////////////////////
+
+void openxr_prefetch(xr_prefetch_t mode) {
+	// The active runtime goes first, so its reads are the first queued
+	prefetch_set_t set = {};
+	prefetch_add_active(&set);
+	if (mode == xr_prefetch_all) {
+		runtime_t *runtime_list  = nullptr;
+		int32_t    runtime_count = 0;
+		load_runtimes(runtime_config_path(), &runtime_list, &runtime_count);
+		for (int32_t i = 0; i < runtime_count; i++) {
+			if (runtime_list[i].present) prefetch_add_runtime(&set, &runtime_list[i]);
+		}
+		free(runtime_list);
+	}
+	prefetch_run (&set);
+	prefetch_free(&set);
+}
+
+///////////////////////////////////////////
+
+display_table_t openxr_layer_manifest_table() {
+	layer_t *layer_list  = nullptr;
+	int32_t  layer_count = 0;
+	load_layers(&layer_list, &layer_count);
+
+	display_table_t table = {};
+	table.name_func    = "apiLayerManifests";
+	table.name_type    = "ApiLayerManifest";
+	table.spec         = "api-layers";
+	table.tag          = display_tag_features;
+	table.column_count = 3;
+	table.header_row   = true;
+	table.cols[0].add({ "Layer Name" });
+	table.cols[1].add({ "Loads" });
+	table.cols[2].add({ "Manifest" });
+	for (int32_t i = 0; i < layer_count; i++) {
+		const layer_t          *layer    = &layer_list[i];
+		const layer_manifest_t *manifest = &layer->manifest;
+		if (!layer->present) continue;
+
+		// What the loader will decide for an app started from this
+		// environment
+		const char *loads = "When requested";
+		if (layer->implicit) {
+			if      (manifest->disable_environment[0] == '\0')                                      loads = "Never, no disable_environment";
+			else if (getenv(manifest->disable_environment))                                       loads = new_string("No, %s is set", manifest->disable_environment);
+			else if (manifest->enable_environment[0] != '\0' && !getenv(manifest->enable_environment)) loads = new_string("Only with %s set", manifest->enable_environment);
+			else                                                                                 loads = "Always, implicit";
+		}
+		table.cols[0].add({ new_string("%s", manifest->name) });
+		table.cols[1].add({ loads });
+		table.cols[2].add({ new_string("%s", layer->file) });
+	}
+	if (table.cols[0].count == 1)
+		table.error = "No API layer manifests found";
+	free(layer_list);
+	return table;
+}
+
+///////////////////////////////////////////
+
 const char *openxr_result_string(XrResult result) {
 	switch (result) {
 #define ENTRY(NAME, VALUE) \
@@ -158,6 +311,71 @@ const char *openxr_result_string(XrResult result) {
 
 ///////////////////////////////////////////
 
+const char *openxr_format_name(int64_t format) {
+	switch (skg_tex_fmt_from_native(format)) {
+	case skg_tex_fmt_rgba32:        return "rgba32";
+	case skg_tex_fmt_rgba32_linear: return "rgba32 linear";
+	case skg_tex_fmt_bgra32:        return "bgra32";
+	case skg_tex_fmt_bgra32_linear: return "bgra32 linear";
+	case skg_tex_fmt_rg11b10:       return "rg11 b10";
+	case skg_tex_fmt_rgb10a2:       return "rgb10 a2";
+	case skg_tex_fmt_rgba64u:       return "rgba64u";
+	case skg_tex_fmt_rgba64s:       return "rgba64s";
+	case skg_tex_fmt_rgba64f:       return "rgba64f";
+	case skg_tex_fmt_rgba128:       return "rgba128";
+	case skg_tex_fmt_r8:            return "r8";
+	case skg_tex_fmt_r16:           return "r16";
+	case skg_tex_fmt_r32:           return "r32";
+	case skg_tex_fmt_depthstencil:  return "depth24 stencil8";
+	case skg_tex_fmt_depth32:       return "depth32";
+	case skg_tex_fmt_depth16:       return "depth16";
+	default:                        return nullptr;
+	}
+}
+
+///////////////////////////////////////////
+
+bool openxr_format_is_depth(int64_t format) {
+	skg_tex_fmt_ skg_format = skg_tex_fmt_from_native(format);
+	return skg_format == skg_tex_fmt_depthstencil
+		|| skg_format == skg_tex_fmt_depth32
+		|| skg_format == skg_tex_fmt_depth16;
+}
+
+///////////////////////////////////////////
+
+XrResult openxr_swapchain_images(XrSwapchain swapchain, uint32_t *out_count) {
+	*out_count = 0;
+	uint32_t count  = 0;
+	XrResult result = xrEnumerateSwapchainImages(swapchain, 0, &count, nullptr);
+	if (XR_FAILED(result) || count == 0) return result;
+	*out_count = count;
+
+	// The images are graphics API structs, so the second call needs an
+	// array of whichever one the session was created with
+	size_t image_size = 0;
+	switch (xr_session_image_type) {
+#if defined(XR_USE_GRAPHICS_API_D3D11)
+	case XR_TYPE_SWAPCHAIN_IMAGE_D3D11_KHR:  image_size = sizeof(XrSwapchainImageD3D11KHR);  break;
+#endif
+#if defined(XR_USE_GRAPHICS_API_D3D12)
+	case XR_TYPE_SWAPCHAIN_IMAGE_D3D12_KHR:  image_size = sizeof(XrSwapchainImageD3D12KHR);  break;
+#endif
+#if defined(XR_USE_GRAPHICS_API_OPENGL)
+	case XR_TYPE_SWAPCHAIN_IMAGE_OPENGL_KHR: image_size = sizeof(XrSwapchainImageOpenGLKHR); break;
+#endif
+	default: return result;
+	}
+	uint8_t *images = (uint8_t *)calloc(count, image_size);
+	for (uint32_t i = 0; i < count; i++)
+		((XrSwapchainImageBaseHeader *)(images + i * image_size))->type = xr_session_image_type;
+	result = xrEnumerateSwapchainImages(swapchain, count, &count, (XrSwapchainImageBaseHeader *)images);
+	free(images);
+	return result;
+}
+
+///////////////////////////////////////////
+
 const char* openxr_path_string(XrPath path) {
 	uint32_t count  = 0;
 	XrResult result = xrPathToString(xr_instance, path, 0, &count, nullptr);
@@ -253,6 +471,16 @@ void openxr_init_instance(array_t<XrExtensionProperties> extensions, xr_settings
 		}
 	}
 
+	// Whatever else the caller's probes need
+	for (int32_t e = 0; e < settings.extension_count; e++) {
+		for (size_t i = 0; i < extensions.count; i++) {
+			if (strcmp(extensions[i].extensionName, settings.extensions[e]) == 0) {
+				exts.add(settings.extensions[e]);
+				break;
+			}
+		}
+	}
+
 	XrInstanceCreateInfo create_info = { XR_TYPE_INSTANCE_CREATE_INFO };
 	create_info.enabledExtensionCount = (uint32_t)exts.count;
 	create_info.enabledExtensionNames = exts.data;
@@ -399,6 +627,16 @@ void openxr_init_session(xr_settings_t settings) {
 	XrResult result = xrCreateSession(xr_instance, &session_info, &xr_session);
 	if (XR_FAILED(result)) { xr_session_err = openxr_result_string(result); }
 
+	if (binding_ptr && session_info.next) {
+		switch (((XrBaseInStructure*)binding_ptr)->type) {
+		case XR_TYPE_GRAPHICS_BINDING_D3D11_KHR:        xr_session_image_type = XR_TYPE_SWAPCHAIN_IMAGE_D3D11_KHR;  break;
+		case XR_TYPE_GRAPHICS_BINDING_D3D12_KHR:        xr_session_image_type = XR_TYPE_SWAPCHAIN_IMAGE_D3D12_KHR;  break;
+		case XR_TYPE_GRAPHICS_BINDING_OPENGL_WIN32_KHR:
+		case XR_TYPE_GRAPHICS_BINDING_OPENGL_XLIB_KHR:  xr_session_image_type = XR_TYPE_SWAPCHAIN_IMAGE_OPENGL_KHR; break;
+		default: break;
+		}
+	}
+
 	if (binding_ptr) {
 #if defined(XR_USE_GRAPHICS_API_D3D11)
 		if (((XrBaseInStructure*)binding_ptr)->type == XR_TYPE_GRAPHICS_BINDING_D3D11_KHR) delete (XrGraphicsBindingD3D11KHR*)binding_ptr;
@@ -624,7 +862,10 @@ void openxr_load_enums(xr_settings_t settings) {
 			requires_session = requires_session || xr_misc_enums[i].requires_session;
 		}
 		if (requires_session) {
+			uint64_t start = stm_now();
 			openxr_init_session(settings);
+			perf_probe_record("xrCreateSession", start);
+			if (settings.footprint) footprint_sample(footprint_step_session);
 		}
 	} else if (!xr_session_err) {
 		xr_session_err = "Reload with Session enabled";
@@ -644,7 +885,9 @@ void openxr_load_enums(xr_settings_t settings) {
 			(!xr_misc_enums[i].requires_instance || !xr_instance_err) &&
 			(!xr_misc_enums[i].requires_system   || !xr_system_err  )) {
 
+			uint64_t start = stm_now();
 			XrResult error = xr_misc_enums[i].load_info(&xr_misc_enums[i], settings);
+			perf_probe_record(xr_misc_enums[i].source_fn_name, start);
 
 			for (size_t e = 0; e < xr_misc_enums[i].items.count; e++) {
 				table.cols[0].add({ xr_misc_enums[i].items[e] });
@@ -733,26 +976,8 @@ void openxr_register_enums() {
 		xrEnumerateSwapchainFormats(xr_session, count, &count, formats.data);
 
 		for (size_t i = 0; i < formats.count; i++) {
-			skg_tex_fmt_ format = skg_tex_fmt_from_native(formats[i]);
-			switch (format) {
-			case skg_tex_fmt_none:          ref_info->items.add(new_string("Unknown 0x%x #%d", formats[i], formats[i])); break;
-			case skg_tex_fmt_rgba32:        ref_info->items.add("rgba32");          break;
-			case skg_tex_fmt_rgba32_linear: ref_info->items.add("rgba32 linear");   break;
-			case skg_tex_fmt_bgra32:        ref_info->items.add("bgra32");          break;
-			case skg_tex_fmt_bgra32_linear: ref_info->items.add("bgra32 linear");   break;
-			case skg_tex_fmt_rg11b10:       ref_info->items.add("rg11 b10");        break;
-			case skg_tex_fmt_rgb10a2:       ref_info->items.add("rgb10 a2");        break;
-			case skg_tex_fmt_rgba64u:       ref_info->items.add("rgba64u");         break;
-			case skg_tex_fmt_rgba64s:       ref_info->items.add("rgba64s");         break;
-			case skg_tex_fmt_rgba64f:       ref_info->items.add("rgba64f");         break;
-			case skg_tex_fmt_rgba128:       ref_info->items.add("rgba128");         break;
-			case skg_tex_fmt_r8:            ref_info->items.add("r8");              break;
-			case skg_tex_fmt_r16:           ref_info->items.add("r16");             break;
-			case skg_tex_fmt_r32:           ref_info->items.add("r32");             break;
-			case skg_tex_fmt_depthstencil:  ref_info->items.add("depth24 stencil8");break;
-			case skg_tex_fmt_depth32:       ref_info->items.add("depth32");         break;
-			case skg_tex_fmt_depth16:       ref_info->items.add("depth16");         break;
-			}
+			const char *name = openxr_format_name(formats[i]);
+			ref_info->items.add(name ? name : new_string("Unknown 0x%x #%d", formats[i], formats[i]));
 		}
 		formats.free();
 		return error;
@@ -27,6 +27,7 @@ enum display_tag_ {
 	display_tag_features,
 	display_tag_view,
 	display_tag_misc,
+	display_tag_footprint,
 };
 
 struct display_item_t {
@@ -55,11 +56,31 @@ enum xr_graphics_preference_t {
 	xr_gfx_d3d12,
 };
 
+// Which runtime libraries to read into the page cache before loading one
+enum xr_prefetch_t {
+	xr_prefetch_off = 0,
+	xr_prefetch_active,
+	xr_prefetch_all,
+};
+
 struct xr_settings_t {
 	XrViewConfigurationType   view_config;
 	XrFormFactor              form;
 	bool                      allow_session;
 	xr_graphics_preference_t  graphics_preference; // new
+	bool                      footprint;           // Sample /proc around runtime startup, see openxr_footprint.h
+	xr_prefetch_t             prefetch;            // See xrprefetch.h
+	const char *const        *extensions;          // Also enabled, where the runtime offers them
+	int32_t                   extension_count;
+};
+
+// Milliseconds from the start of openxr_time_startup until each object
+// was ready, so each includes the ones before it.
+struct xr_startup_times_t {
+	float       instance_ms; // Includes enumerating extensions and layers
+	float       system_ms;
+	float       session_ms;  // 0 unless settings.allow_session
+	const char *error;       // First failure, null if everything was created
 };
 
 struct xr_enum_info_t {
@@ -95,6 +116,9 @@ extern array_t<xr_enum_info_t> xr_misc_enums;
 extern xr_properties_t         xr_properties;
 extern xr_view_info_t          xr_view;
 
+extern XrInstance  xr_instance;
+extern XrSession   xr_session;
+extern XrSystemId  xr_system_id;
 extern const char *xr_instance_err;
 extern const char *xr_session_err;
 extern const char *xr_system_err;
@@ -105,6 +129,37 @@ extern const char* xr_runtime_name;
 
 void openxr_info_reload (xr_settings_t settings);
 void openxr_info_release();
+// Closes the session, instance and graphics device like openxr_info_release,
+// but leaves xr_tables and their strings alone, so a measurement can close
+// the runtime and still hand its tables back to the caller.
+void openxr_runtime_close();
+
+// Creates just the instance, system and (optionally) session, times them,
+// and releases everything again. No tables are loaded.
+xr_startup_times_t openxr_time_startup(xr_settings_t settings);
+
+// Creates the instance, system and (optionally) session and leaves them
+// open, for probes that need a live runtime. Returns the first error, or
+// null. openxr_runtime_close or openxr_info_release closes it again.
+const char *openxr_runtime_open(xr_settings_t settings);
+// Drains the runtime's event queue the way an idle app would, and returns
+// how many events there were.
+int32_t     openxr_poll_events ();
+// Whether the runtime has the extension. openxr_runtime_open enables each
+// of settings.extensions the runtime has, so for those, it's also whether
+// the extension is on.
+bool        openxr_has_ext     (const char *ext_name);
+// Lists the API layer manifests straight from the loader's search paths,
+// so it needs no runtime and costs no more than reading a few files.
+display_table_t openxr_layer_manifest_table();
 
 const char *openxr_result_string(XrResult result);
+// A short name for a native swapchain format, or null if sk_gpu doesn't
+// know it.
+const char *openxr_format_name    (int64_t format);
+bool        openxr_format_is_depth(int64_t format);
+// xrEnumerateSwapchainImages, both the count and the images themselves
+// in the struct that goes with the session's graphics binding. Headless
+// sessions only get the count.
+XrResult    openxr_swapchain_images(XrSwapchain swapchain, uint32_t *out_count);
 const char *new_string(const char *format, ...);
\ No newline at end of file
@@ -0,0 +1,407 @@
+#include "openxr_session.h"
+#include "imgui/sokol_time.h"
+
+#if defined(_WIN32)
+#include <Windows.h>
+#else
+#define XR_USE_TIMESPEC
+#include <time.h>
+#endif
+#include <openxr/openxr_platform.h>
+#include <openxr/openxr_reflection.h>
+
+#include <stdio.h>
+#include <string.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+/*** Types *******************************/
+
+struct session_change_t {
+	XrSessionState state;
+	float          ms;
+	uint64_t       frame;
+};
+
+/*** Global Variables ********************/
+
+std::thread             session_thread;
+std::mutex              session_mutex;
+std::condition_variable session_done_cv;
+bool                    session_done      = false;
+std::atomic<bool>       session_stop_flag = {false};
+std::atomic<int32_t>    session_state     = {XR_SESSION_STATE_UNKNOWN};
+std::atomic<uint64_t>   session_frames    = {0};
+
+session_hooks_t         session_hooks     = {};
+session_info_t          session_result    = {};
+char                    session_error[128];
+uint64_t                session_start_time;
+
+// Preallocated, so recording a change never allocates on the session thread
+session_change_t        session_changes[64];
+int32_t                 session_change_count = 0;
+
+// How long to wait for the runtime to walk us through STOPPING and EXITING
+// after asking it to end the session.
+const float             session_exit_timeout_ms = 3000;
+
+// The extensions session_settings asks for
+const char             *session_extensions[] = {
+#if defined(_WIN32)
+	XR_KHR_WIN32_CONVERT_PERFORMANCE_COUNTER_TIME_EXTENSION_NAME,
+#else
+	XR_KHR_CONVERT_TIMESPEC_TIME_EXTENSION_NAME,
+#endif
+	XR_FB_DISPLAY_REFRESH_RATE_EXTENSION_NAME,
+	XR_MSFT_COMPOSITION_LAYER_REPROJECTION_EXTENSION_NAME,
+	XR_EXT_PERFORMANCE_SETTINGS_EXTENSION_NAME,
+	XR_KHR_LOCATE_SPACES_EXTENSION_NAME,
+	XR_EXT_HAND_TRACKING_EXTENSION_NAME,
+	XR_EXT_EYE_GAZE_INTERACTION_EXTENSION_NAME,
+	XR_KHR_COMPOSITION_LAYER_CYLINDER_EXTENSION_NAME,
+	XR_KHR_COMPOSITION_LAYER_CUBE_EXTENSION_NAME,
+};
+
+// XrTime minus stm nanoseconds, found once per instance
+XrInstance              session_clock_instance = XR_NULL_HANDLE;
+int64_t                 session_clock_offset   = 0;
+
+/*** Signatures **************************/
+
+static void        session_run      ();
+static void        session_set_state(XrSessionState state);
+static void        session_fail     (const char *call, XrResult result);
+
+/*** Code ********************************/
+
+xr_settings_t session_settings(xr_settings_t settings) {
+	settings.allow_session   = true;
+	settings.extensions      = session_extensions;
+	settings.extension_count = sizeof(session_extensions) / sizeof(session_extensions[0]);
+#if !defined(_WIN32)
+	// There's no graphics binding for sessions on Linux in this build,
+	// so frames can only run headless.
+	if (settings.graphics_preference == xr_gfx_auto)
+		settings.graphics_preference = xr_gfx_headless;
+#endif
+	return settings;
+}
+
+///////////////////////////////////////////
+
+XrViewConfigurationType session_view_config(xr_settings_t settings) {
+	if (settings.view_config != 0) return settings.view_config;
+
+	// The runtime lists its primary one first
+	uint32_t                count  = 0;
+	XrViewConfigurationType config = XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO;
+	if (XR_SUCCEEDED(xrEnumerateViewConfigurations(xr_instance, xr_system_id, 1, &count, &config)) && count > 0)
+		return config;
+	return XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO;
+}
+
+///////////////////////////////////////////
+
+bool session_start(xr_settings_t settings, session_hooks_t hooks) {
+	session_stop();
+
+	session_result       = {};
+	session_result.ms_to_ready   = -1;
+	session_result.ms_to_focused = -1;
+	session_change_count = 0;
+	session_done         = false;
+	session_stop_flag    = false;
+	session_state        = XR_SESSION_STATE_UNKNOWN;
+	session_frames       = 0;
+	session_hooks        = hooks;
+	session_start_time   = stm_now();
+
+	if (xr_session == XR_NULL_HANDLE) {
+		session_result.error = xr_session_err ? xr_session_err : "No XrSession available";
+		return false;
+	}
+
+	// Whatever blend mode the view configuration lists first, since the
+	// composited image isn't what we're here for.
+	session_result.view_config = session_view_config(settings);
+	uint32_t               count = 0;
+	XrEnvironmentBlendMode blend = XR_ENVIRONMENT_BLEND_MODE_OPAQUE;
+	if (XR_SUCCEEDED(xrEnumerateEnvironmentBlendModes(xr_instance, xr_system_id, session_result.view_config, 1, &count, &blend)) && count > 0)
+		session_result.blend_mode = blend;
+	else
+		session_result.blend_mode = XR_ENVIRONMENT_BLEND_MODE_OPAQUE;
+
+	session_thread = std::thread(session_run);
+	return true;
+}
+
+///////////////////////////////////////////
+
+bool session_wait(float timeout_s) {
+	std::unique_lock<std::mutex> lock(session_mutex);
+	return session_done_cv.wait_for(lock, std::chrono::milliseconds((int64_t)(timeout_s * 1000)), []() { return session_done; });
+}
+
+///////////////////////////////////////////
+
+bool session_wait_state(XrSessionState state, float timeout_s) {
+	uint64_t start = stm_now();
+	while (session_state.load() != state) {
+		{
+			std::lock_guard<std::mutex> lock(session_mutex);
+			if (session_done) return false;
+		}
+		if (stm_sec(stm_since(start)) > timeout_s) return false;
+		std::this_thread::sleep_for(std::chrono::milliseconds(5));
+	}
+	return true;
+}
+
+///////////////////////////////////////////
+
+void session_stop() {
+	session_stop_flag = true;
+	if (session_thread.joinable()) session_thread.join();
+}
+
+///////////////////////////////////////////
+
+session_info_t session_info() {
+	session_info_t result = session_result;
+	result.state       = (XrSessionState)session_state.load();
+	result.frame_count = session_frames.load();
+	return result;
+}
+
+///////////////////////////////////////////
+
+void session_tables() {
+	session_info_t info = session_info();
+
+	display_table_t table = {};
+	table.name_func    = "runSession";
+	table.name_type    = "sessionStates";
+	table.spec         = "session-lifecycle";
+	table.tag          = display_tag_misc;
+	table.column_count = 3;
+	table.header_row   = true;
+	table.cols[0].add({ "Session State" });
+	table.cols[1].add({ "At (ms)" });
+	table.cols[2].add({ "Frames so far" });
+	for (int32_t i = 0; i < session_change_count; i++) {
+		table.cols[0].add({ session_state_str(session_changes[i].state) });
+		table.cols[1].add({ new_string("%.1f",   session_changes[i].ms) });
+		table.cols[2].add({ new_string("%llu", (unsigned long long)session_changes[i].frame) });
+	}
+	if      (info.error)                table.error = info.error;
+	else if (session_change_count == 0) table.error = "The runtime never changed the session's state";
+	xr_tables.add(table);
+}
+
+///////////////////////////////////////////
+
+static void session_run() {
+	bool     running        = false; // Between xrBeginSession and xrEndSession
+	bool     quit           = false;
+	bool     exit_requested = false;
+	uint64_t exit_time      = 0;
+
+	session_frame_t frame = {};
+	while (!quit) {
+		XrEventDataBuffer event = { XR_TYPE_EVENT_DATA_BUFFER };
+		while (!quit && xrPollEvent(xr_instance, &event) == XR_SUCCESS) {
+			if (session_hooks.on_event) session_hooks.on_event(&event, session_hooks.data);
+
+			if (event.type == XR_TYPE_EVENT_DATA_INSTANCE_LOSS_PENDING) {
+				quit = true;
+			} else if (event.type == XR_TYPE_EVENT_DATA_SESSION_STATE_CHANGED) {
+				const XrEventDataSessionStateChanged *changed = (XrEventDataSessionStateChanged *)&event;
+				session_set_state(changed->state);
+				switch (changed->state) {
+				case XR_SESSION_STATE_READY: {
+					XrSessionBeginInfo begin_info = { XR_TYPE_SESSION_BEGIN_INFO };
+					begin_info.primaryViewConfigurationType = session_result.view_config;
+					XrResult result = xrBeginSession(xr_session, &begin_info);
+					if (XR_FAILED(result)) { session_fail("xrBeginSession", result); quit = true; break; }
+					running = true;
+					if (session_hooks.on_running) session_hooks.on_running(session_hooks.data);
+				} break;
+				case XR_SESSION_STATE_STOPPING: {
+					if (session_hooks.on_stopping) session_hooks.on_stopping(session_hooks.data);
+					XrResult result = xrEndSession(xr_session);
+					if (XR_FAILED(result)) session_fail("xrEndSession", result);
+					running = false;
+					// Whether we asked for it or the runtime took the
+					// session away, that's the end of the measurement.
+					// EXITING may follow, but there's nothing left to do.
+					quit = true;
+				} break;
+				case XR_SESSION_STATE_EXITING:
+				case XR_SESSION_STATE_LOSS_PENDING: quit = true; break;
+				default: break;
+				}
+			}
+			event = { XR_TYPE_EVENT_DATA_BUFFER };
+		}
+		if (quit) break;
+
+		if (session_stop_flag && !exit_requested) {
+			exit_requested = true;
+			exit_time      = stm_now();
+			if (!running) break;
+			XrResult result = xrRequestExitSession(xr_session);
+			if (XR_FAILED(result)) { session_fail("xrRequestExitSession", result); break; }
+		}
+		if (exit_requested && stm_ms(stm_since(exit_time)) > session_exit_timeout_ms)
+			break;
+
+		if (!running) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(5));
+			continue;
+		}
+
+		// The frame loop. Frames keep going while exiting, the runtime
+		// may need a few to get us to STOPPING.
+		XrFrameWaitInfo  wait_info  = { XR_TYPE_FRAME_WAIT_INFO  };
+		XrFrameBeginInfo begin_info = { XR_TYPE_FRAME_BEGIN_INFO };
+		frame.index         = session_frames.load();
+		frame.session_state = (XrSessionState)session_state.load();
+		frame.state         = { XR_TYPE_FRAME_STATE };
+		frame.layers        = nullptr;
+		frame.layer_count   = 0;
+
+		bool     cpu = session_hooks.measure_cpu;
+		uint64_t cpu_start;
+
+		cpu_start          = cpu ? session_thread_cpu() : 0;
+		frame.wait_start   = stm_now();
+		frame.wait_result  = xrWaitFrame (xr_session, &wait_info, &frame.state);
+		frame.wait_end     = stm_now();
+		frame.wait_cpu     = cpu ? session_thread_cpu() - cpu_start : 0;
+		if (XR_FAILED(frame.wait_result)) { session_fail("xrWaitFrame", frame.wait_result); break; }
+		cpu_start          = cpu ? session_thread_cpu() : 0;
+		frame.begin_start  = stm_now();
+		frame.begin_result = xrBeginFrame(xr_session, &begin_info);
+		frame.begin_end    = stm_now();
+		frame.begin_cpu    = cpu ? session_thread_cpu() - cpu_start : 0;
+		if (XR_FAILED(frame.begin_result)) { session_fail("xrBeginFrame", frame.begin_result); break; }
+
+		if (session_hooks.on_layers && frame.state.shouldRender)
+			session_hooks.on_layers(&frame, session_hooks.data);
+
+		XrFrameEndInfo end_info = { XR_TYPE_FRAME_END_INFO };
+		end_info.displayTime          = frame.state.predictedDisplayTime;
+		end_info.environmentBlendMode = session_result.blend_mode;
+		end_info.layerCount           = frame.state.shouldRender ? frame.layer_count : 0;
+		end_info.layers               = frame.state.shouldRender ? frame.layers      : nullptr;
+		cpu_start        = cpu ? session_thread_cpu() : 0;
+		frame.end_start  = stm_now();
+		frame.end_result = xrEndFrame(xr_session, &end_info);
+		frame.end_end    = stm_now();
+		frame.end_cpu    = cpu ? session_thread_cpu() - cpu_start : 0;
+		if (XR_FAILED(frame.end_result)) { session_fail("xrEndFrame", frame.end_result); break; }
+
+		session_frames += 1;
+		if (session_hooks.on_frame && !session_hooks.on_frame(&frame, session_hooks.data))
+			session_stop_flag = true;
+	}
+
+	// Gave up on the runtime, so let the hooks clean up anyway
+	if (running && session_hooks.on_stopping)
+		session_hooks.on_stopping(session_hooks.data);
+
+	std::lock_guard<std::mutex> lock(session_mutex);
+	session_done = true;
+	session_done_cv.notify_all();
+}
+
+///////////////////////////////////////////
+
+static void session_set_state(XrSessionState state) {
+	session_state = state;
+
+	float ms = (float)stm_ms(stm_since(session_start_time));
+	if (state == XR_SESSION_STATE_READY   && session_result.ms_to_ready   < 0) session_result.ms_to_ready   = ms;
+	if (state == XR_SESSION_STATE_FOCUSED && session_result.ms_to_focused < 0) session_result.ms_to_focused = ms;
+
+	if (session_change_count < (int32_t)(sizeof(session_changes) / sizeof(session_changes[0])))
+		session_changes[session_change_count++] = { state, ms, session_frames.load() };
+}
+
+///////////////////////////////////////////
+
+static void session_fail(const char *call, XrResult result) {
+	// Not new_string, the table text isn't ours to touch from this thread
+	if (session_result.error != nullptr) return;
+	snprintf(session_error, sizeof(session_error), "%s: %s", call, openxr_result_string(result));
+	session_result.error = session_error;
+}
+
+///////////////////////////////////////////
+
+const char *session_state_str(XrSessionState state) {
+	switch (state) {
+#define ENTRY(NAME, VALUE) \
+	case VALUE: return #NAME;
+		XR_LIST_ENUM_XrSessionState(ENTRY)
+#undef ENTRY
+	default: return "Unknown";
+	}
+}
+
+///////////////////////////////////////////
+
+XrTime session_xr_time(uint64_t stm_ticks) {
+	if (xr_instance == XR_NULL_HANDLE) return 0;
+	if (session_clock_instance != xr_instance) {
+		session_clock_instance = xr_instance;
+		session_clock_offset   = 0;
+
+		// Both clocks are read back to back, so the offset is off by the
+		// time between the two reads, well under a microsecond.
+		XrTime  xr_now = 0;
+		int64_t tick_ns = 0;
+#if defined(_WIN32)
+		PFN_xrConvertWin32PerformanceCounterToTimeKHR convert = nullptr;
+		if (XR_FAILED(xrGetInstanceProcAddr(xr_instance, "xrConvertWin32PerformanceCounterToTimeKHR", (PFN_xrVoidFunction *)&convert)))
+			return 0;
+		LARGE_INTEGER counter;
+		QueryPerformanceCounter(&counter);
+		tick_ns = (int64_t)stm_ns(stm_now());
+		if (XR_FAILED(convert(xr_instance, &counter, &xr_now))) return 0;
+#else
+		PFN_xrConvertTimespecTimeToTimeKHR convert = nullptr;
+		if (XR_FAILED(xrGetInstanceProcAddr(xr_instance, "xrConvertTimespecTimeToTimeKHR", (PFN_xrVoidFunction *)&convert)))
+			return 0;
+		timespec now;
+		clock_gettime(CLOCK_MONOTONIC, &now);
+		tick_ns = (int64_t)stm_ns(stm_now());
+		if (XR_FAILED(convert(xr_instance, &now, &xr_now))) return 0;
+#endif
+		session_clock_offset = xr_now - tick_ns;
+	}
+	if (session_clock_offset == 0) return 0;
+	return (XrTime)((int64_t)stm_ns(stm_ticks) + session_clock_offset);
+}
+
+///////////////////////////////////////////
+
+uint64_t session_thread_cpu() {
+#if defined(_WIN32)
+	// 100ns units, but only updated on scheduler ticks, so single short
+	// calls mostly read as 0 and the mean is the number to trust.
+	FILETIME created, exited, kernel, user;
+	if (!GetThreadTimes(GetCurrentThread(), &created, &exited, &kernel, &user)) return 0;
+	uint64_t k = ((uint64_t)kernel.dwHighDateTime << 32) | kernel.dwLowDateTime;
+	uint64_t u = ((uint64_t)user  .dwHighDateTime << 32) | user  .dwLowDateTime;
+	return (k + u) * 100;
+#else
+	timespec now;
+	if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now) != 0) return 0;
+	return (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec;
+#endif
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include "openxr_info.h"
+
+#include <stdint.h>
+
+// Drives the session openxr_runtime_open created, on a thread of its own:
+// pumps xrPollEvent, follows the runtime through READY, FOCUSED and
+// STOPPING with xrBeginSession/xrEndSession, and runs the xrWaitFrame,
+// xrBeginFrame, xrEndFrame loop for as long as the runtime wants frames.
+// Measurements plug in through the hooks, which all run on the session
+// thread. Headless sessions (XR_MND_headless) run frames too, they just
+// have no swapchains to submit layers with.
+
+/*** Types *******************************/
+
+struct session_frame_t {
+	uint64_t       index;
+	XrSessionState session_state;
+	XrFrameState   state;        // From xrWaitFrame
+
+	// stm ticks around each call
+	uint64_t       wait_start;
+	uint64_t       wait_end;
+	uint64_t       begin_start;
+	uint64_t       begin_end;
+	uint64_t       end_start;
+	uint64_t       end_end;
+	XrResult       wait_result;
+	XrResult       begin_result;
+	XrResult       end_result;
+
+	// Thread CPU time spent in each call, in nanoseconds, only filled in
+	// when session_hooks_t.measure_cpu is set
+	uint64_t       wait_cpu;
+	uint64_t       begin_cpu;
+	uint64_t       end_cpu;
+
+	// Set by on_layers, and submitted by xrEndFrame if shouldRender is set
+	const XrCompositionLayerBaseHeader *const *layers;
+	uint32_t       layer_count;
+};
+
+struct session_hooks_t {
+	void *data;
+	// Read the thread's CPU clock around each frame call too. It's a
+	// syscall on Linux, so it isn't free.
+	bool  measure_cpu;
+	// After xrBeginSession, before the first frame
+	void (*on_running )(void *data);
+	// Between xrBeginFrame and xrEndFrame
+	void (*on_layers  )(session_frame_t *frame, void *data);
+	// After xrEndFrame, return false to stop the session
+	bool (*on_frame   )(const session_frame_t *frame, void *data);
+	// Before xrEndSession, or before the thread gives up on the session
+	void (*on_stopping)(void *data);
+	// Every event, before the driver acts on it
+	void (*on_event   )(const XrEventDataBuffer *event, void *data);
+};
+
+struct session_info_t {
+	XrViewConfigurationType view_config;
+	XrEnvironmentBlendMode  blend_mode;
+	XrSessionState          state;
+	uint64_t                frame_count;
+	float                   ms_to_ready;   // Since session_start, -1 if it never happened
+	float                   ms_to_focused;
+	const char             *error;         // First call that failed, null if none did
+};
+
+/*** Signatures **************************/
+
+// Settings for a session the driver can run: a session, headless where
+// this build has no graphics binding, and the extensions the session
+// measurements use, such as the ones that convert clocks to XrTime.
+xr_settings_t  session_settings(xr_settings_t settings);
+
+// settings.view_config, or the runtime's primary view configuration when
+// that's left at 0. This is the one the session runs with.
+XrViewConfigurationType session_view_config(xr_settings_t settings);
+// Starts the session thread. Needs openxr_runtime_open to have created a
+// session, and returns false if it didn't.
+bool           session_start (xr_settings_t settings, session_hooks_t hooks);
+// Waits for the session to end on its own, from a hook or the runtime.
+// Returns false if it was still going after timeout_s.
+bool           session_wait  (float timeout_s);
+// Waits until the session is in `state`, for measurements that run on
+// another thread alongside the frame loop. Returns false if it ended, or
+// still wasn't there after timeout_s.
+bool           session_wait_state(XrSessionState state, float timeout_s);
+// Asks the runtime to end the session, and waits for the thread.
+void           session_stop  ();
+// Safe from any thread, but only complete once the session has stopped.
+session_info_t session_info  ();
+// Adds a table with the state changes seen since session_start.
+void           session_tables();
+
+// Converts stm ticks to the runtime's XrTime clock. Needs the runtime open,
+// with XR_KHR_convert_timespec_time (or the Win32 performance counter
+// flavor on Windows) enabled, returns 0 without it.
+XrTime         session_xr_time (uint64_t stm_ticks);
+const char    *session_state_str(XrSessionState state);
+// CPU time the calling thread has used, in nanoseconds
+uint64_t       session_thread_cpu();
@@ -0,0 +1,536 @@
+#include "openxr_spaces.h"
+#include "imgui/sokol_time.h"
+
+#include <openxr/openxr_reflection.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*** Types *******************************/
+
+enum spaces_time_ {
+	spaces_time_past,
+	spaces_time_now,
+	spaces_time_predicted,
+	spaces_time_count,
+};
+
+enum spaces_call_ {
+	spaces_call_locate_space,
+	spaces_call_locate_views,
+	spaces_call_locate_spaces,
+};
+
+struct spaces_case_t {
+	spaces_call_            call;
+	spaces_time_            time;
+	int32_t                 space;       // xrLocateSpace
+	XrViewConfigurationType view_config; // xrLocateViews
+	uint32_t                view_count;
+	int32_t                 batch;       // xrLocateSpaces
+};
+
+/*** Global Variables ********************/
+
+const int32_t spaces_batch_sizes[]   = { 1, 2, 4, 8, 16, 32, 64 };
+const int32_t spaces_max_batch       = 64;
+const int32_t spaces_max_views       = 8;
+// Calls between clock reads, so reading the clock doesn't count much
+const int32_t spaces_chunk           = 32;
+// How far back "past" is from now, in nanoseconds
+const int64_t spaces_past_ns         = 100 * 1000000LL;
+const float   spaces_focus_timeout_s = 10;
+
+/*** Signatures **************************/
+
+static void        spaces_add        (spaces_t *spaces, XrSpace space, const char *name);
+static const char *spaces_gaze_error ();
+static bool        spaces_frame_hook (const session_frame_t *frame, void *data);
+static XrTime      spaces_case_time  (spaces_time_ time, const spaces_frame_t *frame);
+static double      spaces_run_case   (const spaces_t *spaces, const spaces_case_t *test, const spaces_frame_t *frame, PFN_xrLocateSpaces locate_spaces, float ms, XrResult *out_result);
+static const char *spaces_ns_str     (const double *ns, const XrResult *results, double divide);
+static display_table_t spaces_table  (const char *name_type, const char *spec, const char *col0, const char *col1, const char *col2);
+
+/*** Code ********************************/
+
+const char *spaces_create(spaces_t *out_spaces) {
+	*out_spaces = {};
+	out_spaces->view = -1;
+	out_spaces->gaze = -1;
+	if (xr_session == XR_NULL_HANDLE) return "No XrSession available";
+
+	// One of every reference space, with LOCAL as the base
+	uint32_t count  = 0;
+	XrResult result = xrEnumerateReferenceSpaces(xr_session, 0, &count, nullptr);
+	if (XR_FAILED(result)) return new_string("xrEnumerateReferenceSpaces: %s", openxr_result_string(result));
+	XrReferenceSpaceType *types = (XrReferenceSpaceType *)malloc(sizeof(XrReferenceSpaceType) * count);
+	xrEnumerateReferenceSpaces(xr_session, count, &count, types);
+	for (uint32_t i = 0; i < count; i++) {
+		XrReferenceSpaceCreateInfo info = { XR_TYPE_REFERENCE_SPACE_CREATE_INFO };
+		info.referenceSpaceType   = types[i];
+		info.poseInReferenceSpace = { {0,0,0,1}, {0,0,0} };
+		XrSpace space = XR_NULL_HANDLE;
+		if (XR_FAILED(xrCreateReferenceSpace(xr_session, &info, &space))) continue;
+
+		const char *name = "Unknown";
+		switch (types[i]) {
+#define CASE_GET_NAME(e, val) case e: name = #e; break;
+			XR_LIST_ENUM_XrReferenceSpaceType(CASE_GET_NAME)
+#undef CASE_GET_NAME
+		default: break;
+		}
+		if (types[i] == XR_REFERENCE_SPACE_TYPE_LOCAL) out_spaces->base = space;
+		if (types[i] == XR_REFERENCE_SPACE_TYPE_VIEW ) out_spaces->view = out_spaces->count;
+		spaces_add(out_spaces, space, name);
+	}
+	free(types);
+	out_spaces->reference_count = out_spaces->count;
+	if (out_spaces->base == XR_NULL_HANDLE) {
+		spaces_destroy(out_spaces);
+		return "The session has no LOCAL reference space";
+	}
+
+	// Grip and aim poses for each hand. Without them there's still plenty
+	// to measure, so failures from here on only go in action_error.
+	out_spaces->gaze_error = spaces_gaze_error();
+	xrStringToPath(xr_instance, "/user/hand/left",  &out_spaces->hand_paths[0]);
+	xrStringToPath(xr_instance, "/user/hand/right", &out_spaces->hand_paths[1]);
+
+	XrActionSetCreateInfo set_info = { XR_TYPE_ACTION_SET_CREATE_INFO };
+	snprintf(set_info.actionSetName,          sizeof(set_info.actionSetName),          "explorer");
+	snprintf(set_info.localizedActionSetName, sizeof(set_info.localizedActionSetName), "OpenXR Explorer");
+	result = xrCreateActionSet(xr_instance, &set_info, &out_spaces->action_set);
+	if (XR_FAILED(result)) {
+		out_spaces->action_error = new_string("xrCreateActionSet: %s", openxr_result_string(result));
+		return nullptr;
+	}
+
+	const char *action_names[2] = { "grip_pose", "aim_pose" };
+	const char *action_paths[2] = { "grip",      "aim"      };
+	for (int32_t a = 0; a < 2; a++) {
+		XrActionCreateInfo action_info = { XR_TYPE_ACTION_CREATE_INFO };
+		action_info.actionType          = XR_ACTION_TYPE_POSE_INPUT;
+		action_info.countSubactionPaths = 2;
+		action_info.subactionPaths      = out_spaces->hand_paths;
+		snprintf(action_info.actionName,          sizeof(action_info.actionName),          "%s", action_names[a]);
+		snprintf(action_info.localizedActionName, sizeof(action_info.localizedActionName), "%s", action_names[a]);
+		result = xrCreateAction(out_spaces->action_set, &action_info, &out_spaces->pose_actions[a]);
+		if (XR_FAILED(result)) {
+			out_spaces->action_error = new_string("xrCreateAction: %s", openxr_result_string(result));
+			return nullptr;
+		}
+	}
+
+	// Every runtime has to take khr/simple_controller, so it's the one
+	// binding that works everywhere
+	XrActionSuggestedBinding bindings[4];
+	for (int32_t a = 0; a < 2; a++) {
+		for (int32_t h = 0; h < 2; h++) {
+			char path[128];
+			snprintf(path, sizeof(path), "/user/hand/%s/input/%s/pose", h == 0 ? "left" : "right", action_paths[a]);
+			bindings[a * 2 + h].action = out_spaces->pose_actions[a];
+			xrStringToPath(xr_instance, path, &bindings[a * 2 + h].binding);
+		}
+	}
+	XrInteractionProfileSuggestedBinding suggested = { XR_TYPE_INTERACTION_PROFILE_SUGGESTED_BINDING };
+	xrStringToPath(xr_instance, "/interaction_profiles/khr/simple_controller", &suggested.interactionProfile);
+	suggested.countSuggestedBindings = 4;
+	suggested.suggestedBindings      = bindings;
+	result = xrSuggestInteractionProfileBindings(xr_instance, &suggested);
+	if (XR_FAILED(result)) {
+		out_spaces->action_error = new_string("xrSuggestInteractionProfileBindings: %s", openxr_result_string(result));
+		return nullptr;
+	}
+
+	// The eye gaze has an interaction profile of its own
+	if (out_spaces->gaze_error == nullptr) {
+		XrActionCreateInfo action_info = { XR_TYPE_ACTION_CREATE_INFO };
+		action_info.actionType = XR_ACTION_TYPE_POSE_INPUT;
+		snprintf(action_info.actionName,          sizeof(action_info.actionName),          "eye_gaze");
+		snprintf(action_info.localizedActionName, sizeof(action_info.localizedActionName), "Eye gaze");
+		result = xrCreateAction(out_spaces->action_set, &action_info, &out_spaces->gaze_action);
+
+		XrActionSuggestedBinding gaze_binding = { out_spaces->gaze_action };
+		xrStringToPath(xr_instance, "/user/eyes_ext/input/gaze_ext/pose", &gaze_binding.binding);
+		XrInteractionProfileSuggestedBinding gaze_suggested = { XR_TYPE_INTERACTION_PROFILE_SUGGESTED_BINDING };
+		xrStringToPath(xr_instance, "/interaction_profiles/ext/eye_gaze_interaction", &gaze_suggested.interactionProfile);
+		gaze_suggested.countSuggestedBindings = 1;
+		gaze_suggested.suggestedBindings      = &gaze_binding;
+		if (XR_SUCCEEDED(result))
+			result = xrSuggestInteractionProfileBindings(xr_instance, &gaze_suggested);
+		if (XR_FAILED(result)) {
+			out_spaces->gaze_error  = new_string("Eye gaze action: %s", openxr_result_string(result));
+			out_spaces->gaze_action = XR_NULL_HANDLE;
+		}
+	}
+
+	XrSessionActionSetsAttachInfo attach_info = { XR_TYPE_SESSION_ACTION_SETS_ATTACH_INFO };
+	attach_info.countActionSets = 1;
+	attach_info.actionSets      = &out_spaces->action_set;
+	result = xrAttachSessionActionSets(xr_session, &attach_info);
+	if (XR_FAILED(result)) {
+		out_spaces->action_error = new_string("xrAttachSessionActionSets: %s", openxr_result_string(result));
+		return nullptr;
+	}
+	out_spaces->attached = true;
+
+	const char *space_names[2][2] = {
+		{ "Left grip pose", "Right grip pose" },
+		{ "Left aim pose",  "Right aim pose"  } };
+	for (int32_t a = 0; a < 2; a++) {
+		for (int32_t h = 0; h < 2; h++) {
+			XrActionSpaceCreateInfo info = { XR_TYPE_ACTION_SPACE_CREATE_INFO };
+			info.action            = out_spaces->pose_actions[a];
+			info.subactionPath     = out_spaces->hand_paths[h];
+			info.poseInActionSpace = { {0,0,0,1}, {0,0,0} };
+			XrSpace space = XR_NULL_HANDLE;
+			result = xrCreateActionSpace(xr_session, &info, &space);
+			if (XR_FAILED(result)) {
+				out_spaces->action_error = new_string("xrCreateActionSpace: %s", openxr_result_string(result));
+				continue;
+			}
+			spaces_add(out_spaces, space, space_names[a][h]);
+		}
+	}
+	if (out_spaces->gaze_action != XR_NULL_HANDLE) {
+		XrActionSpaceCreateInfo info = { XR_TYPE_ACTION_SPACE_CREATE_INFO };
+		info.action            = out_spaces->gaze_action;
+		info.poseInActionSpace = { {0,0,0,1}, {0,0,0} };
+		XrSpace space = XR_NULL_HANDLE;
+		result = xrCreateActionSpace(xr_session, &info, &space);
+		if (XR_FAILED(result)) {
+			out_spaces->gaze_error = new_string("xrCreateActionSpace: %s", openxr_result_string(result));
+		} else {
+			out_spaces->gaze = out_spaces->count;
+			spaces_add(out_spaces, space, "Eye gaze");
+		}
+	}
+	return nullptr;
+}
+
+///////////////////////////////////////////
+
+static const char *spaces_gaze_error() {
+	if (!openxr_has_ext(XR_EXT_EYE_GAZE_INTERACTION_EXTENSION_NAME))
+		return "Needs " XR_EXT_EYE_GAZE_INTERACTION_EXTENSION_NAME;
+
+	XrSystemEyeGazeInteractionPropertiesEXT gaze_properties = { XR_TYPE_SYSTEM_EYE_GAZE_INTERACTION_PROPERTIES_EXT };
+	XrSystemProperties                      properties      = { XR_TYPE_SYSTEM_PROPERTIES };
+	properties.next = &gaze_properties;
+	XrResult result = xrGetSystemProperties(xr_instance, xr_system_id, &properties);
+	if (XR_FAILED(result))                          return new_string("xrGetSystemProperties: %s", openxr_result_string(result));
+	if (!gaze_properties.supportsEyeGazeInteraction) return "The system doesn't support eye gaze interaction";
+	return nullptr;
+}
+
+///////////////////////////////////////////
+
+void spaces_destroy(spaces_t *spaces) {
+	for (int32_t i = 0; i < spaces->count; i++) xrDestroySpace(spaces->spaces[i]);
+	// Takes the actions along with it
+	if (spaces->action_set != XR_NULL_HANDLE) xrDestroyActionSet(spaces->action_set);
+	*spaces = {};
+}
+
+///////////////////////////////////////////
+
+void spaces_sync(const spaces_t *spaces) {
+	if (!spaces->attached) return;
+
+	XrActiveActionSet active    = { spaces->action_set, XR_NULL_PATH };
+	XrActionsSyncInfo sync_info = { XR_TYPE_ACTIONS_SYNC_INFO };
+	sync_info.countActiveActionSets = 1;
+	sync_info.activeActionSets      = &active;
+	xrSyncActions(xr_session, &sync_info);
+}
+
+///////////////////////////////////////////
+
+static void spaces_add(spaces_t *spaces, XrSpace space, const char *name) {
+	const int32_t max = sizeof(spaces->spaces) / sizeof(spaces->spaces[0]);
+	if (spaces->count >= max) {
+		xrDestroySpace(space);
+		return;
+	}
+	spaces->spaces[spaces->count] = space;
+	spaces->names [spaces->count] = name;
+	spaces->count += 1;
+}
+
+///////////////////////////////////////////
+
+const char *spaces_session_start(xr_settings_t settings, spaces_t *out_spaces, spaces_frame_t *out_frame) {
+	*out_spaces = {};
+	const char *error = openxr_runtime_open(settings);
+	if (error) {
+		openxr_runtime_close();
+		return new_string("Couldn't open the runtime: %s", error);
+	}
+	error = spaces_create(out_spaces);
+	if (error) {
+		openxr_runtime_close();
+		return error;
+	}
+
+	out_frame->spaces = out_spaces;
+	out_frame->predicted_time.store(0);
+	session_hooks_t hooks = {};
+	hooks.data     = out_frame;
+	hooks.on_frame = spaces_frame_hook;
+	bool focused = session_start(settings, hooks) && session_wait_state(XR_SESSION_STATE_FOCUSED, spaces_focus_timeout_s);
+	if (!focused) {
+		session_stop();
+		session_info_t info = session_info();
+		spaces_session_stop(out_spaces);
+		return info.error ? info.error : "The session never got to FOCUSED";
+	}
+	return nullptr;
+}
+
+///////////////////////////////////////////
+
+void spaces_session_stop(spaces_t *spaces) {
+	session_stop();
+	spaces_destroy(spaces);
+	openxr_runtime_close();
+}
+
+///////////////////////////////////////////
+
+void spaces_bench_locate(xr_settings_t settings, float ms_per_case) {
+	settings = session_settings(settings);
+
+	display_table_t single = spaces_table("xrLocateSpace", "xrLocateSpace",
+		"Space, in LOCAL", "ns per call, past / now / predicted", "Calls per second, predicted");
+
+	spaces_t       spaces = {};
+	spaces_frame_t frame  = {};
+	const char    *error  = spaces_session_start(settings, &spaces, &frame);
+	if (error) {
+		single.error = error;
+		xr_tables.add(single);
+		return;
+	}
+
+	// Batched locates are core in 1.1, and XR_KHR_locate_spaces before that
+	PFN_xrLocateSpaces locate_spaces = nullptr;
+	const char        *batch_name    = "xrLocateSpaces";
+	if (XR_FAILED(xrGetInstanceProcAddr(xr_instance, "xrLocateSpaces", (PFN_xrVoidFunction *)&locate_spaces))) {
+		locate_spaces = nullptr;
+		batch_name    = "xrLocateSpacesKHR";
+		if (XR_FAILED(xrGetInstanceProcAddr(xr_instance, "xrLocateSpacesKHR", (PFN_xrVoidFunction *)&locate_spaces)))
+			locate_spaces = nullptr;
+	}
+
+	// Past and now need the runtime's clock, predicted only needs frames
+	bool has_clock = session_xr_time(stm_now()) != 0;
+
+	// xrLocateSpace, for each space
+	double single_mean = 0;
+	for (int32_t s = 0; s < spaces.count; s++) {
+		double   ns     [spaces_time_count];
+		XrResult results[spaces_time_count];
+		for (int32_t t = 0; t < spaces_time_count; t++) {
+			ns[t] = -1; results[t] = XR_SUCCESS;
+			if (t != spaces_time_predicted && !has_clock) continue;
+
+			spaces_case_t test = {};
+			test.call  = spaces_call_locate_space;
+			test.time  = (spaces_time_)t;
+			test.space = s;
+			ns[t] = spaces_run_case(&spaces, &test, &frame, locate_spaces, ms_per_case, &results[t]);
+		}
+		if (ns[spaces_time_predicted] > 0) single_mean += ns[spaces_time_predicted] / spaces.count;
+
+		single.cols[0].add({ s < spaces.reference_count ? spaces.names[s] : new_string("%s (action)", spaces.names[s]) });
+		single.cols[1].add({ spaces_ns_str(ns, results, 1) });
+		single.cols[2].add({ ns[spaces_time_predicted] > 0 && XR_SUCCEEDED(results[spaces_time_predicted])
+			? new_string("%.0f", 1e9 / ns[spaces_time_predicted])
+			: "-" });
+	}
+	if (spaces.action_error) {
+		single.cols[0].add({ "Action spaces" });
+		single.cols[1].add({ spaces.action_error });
+		single.cols[2].add({ "-" });
+	}
+	xr_tables.add(single);
+
+	// xrLocateViews, for each view configuration
+	display_table_t views = spaces_table("xrLocateViews", "xrLocateViews",
+		"View configuration", "ns per call, past / now / predicted", "ns per view, predicted");
+	uint32_t                config_count = 0;
+	XrViewConfigurationType configs[16];
+	XrResult result = xrEnumerateViewConfigurations(xr_instance, xr_system_id, 16, &config_count, configs);
+	if (XR_FAILED(result)) {
+		views.error  = new_string("xrEnumerateViewConfigurations: %s", openxr_result_string(result));
+		config_count = 0;
+	}
+	for (uint32_t c = 0; c < config_count; c++) {
+		uint32_t view_count = 0;
+		xrEnumerateViewConfigurationViews(xr_instance, xr_system_id, configs[c], 0, &view_count, nullptr);
+		if (view_count == 0 || view_count > (uint32_t)spaces_max_views) continue;
+
+		double   ns     [spaces_time_count];
+		XrResult results[spaces_time_count];
+		for (int32_t t = 0; t < spaces_time_count; t++) {
+			ns[t] = -1; results[t] = XR_SUCCESS;
+			if (t != spaces_time_predicted && !has_clock) continue;
+
+			spaces_case_t test = {};
+			test.call        = spaces_call_locate_views;
+			test.time        = (spaces_time_)t;
+			test.view_config = configs[c];
+			test.view_count  = view_count;
+			ns[t] = spaces_run_case(&spaces, &test, &frame, locate_spaces, ms_per_case, &results[t]);
+		}
+
+		const char *name = "Unknown";
+		switch (configs[c]) {
+#define CASE_GET_NAME(e, val) case e: name = #e; break;
+			XR_LIST_ENUM_XrViewConfigurationType(CASE_GET_NAME)
+#undef CASE_GET_NAME
+		default: break;
+		}
+		views.cols[0].add({ new_string("%s, %u views", name, view_count) });
+		views.cols[1].add({ spaces_ns_str(ns, results, 1) });
+		views.cols[2].add({ ns[spaces_time_predicted] > 0 && XR_SUCCEEDED(results[spaces_time_predicted])
+			? new_string("%.0f", ns[spaces_time_predicted] / view_count)
+			: "-" });
+	}
+	xr_tables.add(views);
+
+	// xrLocateSpaces, for each batch size, cycling through the spaces
+	display_table_t batched = spaces_table("xrLocateSpaces", batch_name,
+		"Batch size", "ns per space, past / now / predicted", "Against xrLocateSpace, predicted");
+	if (locate_spaces == nullptr) batched.error = "Needs OpenXR 1.1 or XR_KHR_locate_spaces";
+	const int32_t batch_count = locate_spaces ? sizeof(spaces_batch_sizes) / sizeof(spaces_batch_sizes[0]) : 0;
+	for (int32_t b = 0; b < batch_count; b++) {
+		double   ns     [spaces_time_count];
+		XrResult results[spaces_time_count];
+		for (int32_t t = 0; t < spaces_time_count; t++) {
+			ns[t] = -1; results[t] = XR_SUCCESS;
+			if (t != spaces_time_predicted && !has_clock) continue;
+
+			spaces_case_t test = {};
+			test.call  = spaces_call_locate_spaces;
+			test.time  = (spaces_time_)t;
+			test.batch = spaces_batch_sizes[b];
+			ns[t] = spaces_run_case(&spaces, &test, &frame, locate_spaces, ms_per_case, &results[t]);
+		}
+		double per_space = ns[spaces_time_predicted] / spaces_batch_sizes[b];
+		batched.cols[0].add({ new_string("%d", spaces_batch_sizes[b]) });
+		batched.cols[1].add({ spaces_ns_str(ns, results, spaces_batch_sizes[b]) });
+		batched.cols[2].add({ per_space > 0 && single_mean > 0 && XR_SUCCEEDED(results[spaces_time_predicted])
+			? new_string("%.2fx the speed", single_mean / per_space)
+			: "-" });
+	}
+	xr_tables.add(batched);
+
+	spaces_session_stop(&spaces);
+}
+
+///////////////////////////////////////////
+
+static bool spaces_frame_hook(const session_frame_t *frame, void *data) {
+	spaces_frame_t *bench = (spaces_frame_t *)data;
+	spaces_sync(bench->spaces);
+	if (frame->state.predictedDisplayTime != 0)
+		bench->predicted_time.store(frame->state.predictedDisplayTime);
+	return true;
+}
+
+///////////////////////////////////////////
+
+static XrTime spaces_case_time(spaces_time_ time, const spaces_frame_t *frame) {
+	switch (time) {
+	case spaces_time_past:      return session_xr_time(stm_now()) - spaces_past_ns;
+	case spaces_time_now:       return session_xr_time(stm_now());
+	case spaces_time_predicted: return frame->predicted_time.load();
+	default:                    return 0;
+	}
+}
+
+///////////////////////////////////////////
+
+static double spaces_run_case(const spaces_t *spaces, const spaces_case_t *test, const spaces_frame_t *frame, PFN_xrLocateSpaces locate_spaces, float ms, XrResult *out_result) {
+	XrSpaceLocation location = { XR_TYPE_SPACE_LOCATION };
+
+	XrView      view_list[spaces_max_views];
+	XrViewState view_state = { XR_TYPE_VIEW_STATE };
+	for (int32_t i = 0; i < spaces_max_views; i++) view_list[i] = { XR_TYPE_VIEW };
+	XrViewLocateInfo view_info = { XR_TYPE_VIEW_LOCATE_INFO };
+	view_info.viewConfigurationType = test->view_config;
+	view_info.space                 = spaces->base;
+
+	XrSpace             batch_spaces   [spaces_max_batch];
+	XrSpaceLocationData batch_locations[spaces_max_batch];
+	for (int32_t i = 0; i < test->batch; i++) batch_spaces[i] = spaces->spaces[i % spaces->count];
+	XrSpacesLocateInfo batch_info = { XR_TYPE_SPACES_LOCATE_INFO };
+	batch_info.baseSpace  = spaces->base;
+	batch_info.spaceCount = (uint32_t)test->batch;
+	batch_info.spaces     = batch_spaces;
+	XrSpaceLocations batch_out = { XR_TYPE_SPACE_LOCATIONS };
+	batch_out.locationCount = (uint32_t)test->batch;
+	batch_out.locations     = batch_locations;
+
+	// The time is picked again between chunks, so "now" stays now, and
+	// "predicted" follows the frame loop
+	XrResult result = XR_SUCCESS;
+	uint64_t ticks  = 0;
+	int64_t  calls  = 0;
+	while (stm_ms(ticks) < ms) {
+		XrTime   time  = spaces_case_time(test->time, frame);
+		uint64_t start = stm_now();
+		switch (test->call) {
+		case spaces_call_locate_space: {
+			for (int32_t i = 0; i < spaces_chunk; i++)
+				result = xrLocateSpace(spaces->spaces[test->space], spaces->base, time, &location);
+		} break;
+		case spaces_call_locate_views: {
+			view_info.displayTime = time;
+			uint32_t count = 0;
+			for (int32_t i = 0; i < spaces_chunk; i++)
+				result = xrLocateViews(xr_session, &view_info, &view_state, test->view_count, &count, view_list);
+		} break;
+		case spaces_call_locate_spaces: {
+			batch_info.time = time;
+			for (int32_t i = 0; i < spaces_chunk; i++)
+				result = locate_spaces(xr_session, &batch_info, &batch_out);
+		} break;
+		}
+		ticks += stm_since(start);
+		calls += spaces_chunk;
+		if (XR_FAILED(result)) break;
+	}
+	*out_result = result;
+	return stm_ns(ticks) / calls;
+}
+
+///////////////////////////////////////////
+
+static const char *spaces_ns_str(const double *ns, const XrResult *results, double divide) {
+	char text[spaces_time_count][64];
+	for (int32_t t = 0; t < spaces_time_count; t++) {
+		if      (XR_FAILED(results[t])) snprintf(text[t], sizeof(text[t]), "%s", openxr_result_string(results[t]));
+		else if (ns[t] < 0)             snprintf(text[t], sizeof(text[t]), "-");
+		else                            snprintf(text[t], sizeof(text[t]), "%.0f", ns[t] / divide);
+	}
+	return new_string("%s / %s / %s", text[0], text[1], text[2]);
+}
+
+///////////////////////////////////////////
+
+static display_table_t spaces_table(const char *name_type, const char *spec, const char *col0, const char *col1, const char *col2) {
+	display_table_t table = {};
+	table.name_func    = "benchLocate";
+	table.name_type    = name_type;
+	table.spec         = spec;
+	table.tag          = display_tag_misc;
+	table.column_count = 3;
+	table.header_row   = true;
+	table.cols[0].add({ col0 });
+	table.cols[1].add({ col1 });
+	table.cols[2].add({ col2 });
+	return table;
+}
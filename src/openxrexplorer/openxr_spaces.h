@@ -0,0 +1,67 @@
+#pragma once
+
+#include "openxr_info.h"
+#include "openxr_session.h"
+
+#include <stdint.h>
+#include <atomic>
+
+// Spaces for the session measurements, see openxr_session.h: one of every
+// reference space the runtime has, and action spaces for the grip and aim
+// poses of both hands, bound through khr/simple_controller so any runtime
+// with controllers can drive them. With XR_EXT_eye_gaze_interaction, an
+// action space for the eye gaze too.
+
+/*** Types *******************************/
+
+struct spaces_t {
+	XrSpace     spaces[24];      // Reference spaces first, then action spaces
+	const char *names [24];
+	int32_t     count;
+	int32_t     reference_count;
+	XrSpace     base;            // LOCAL, what everything else is located in
+
+	int32_t     view;            // Index of VIEW, -1 if there isn't one
+	int32_t     gaze;            // Index of the eye gaze space, -1 if there isn't one
+
+	XrActionSet action_set;
+	XrAction    pose_actions[2]; // Grip, aim
+	XrPath      hand_paths  [2]; // Left, right
+	XrAction    gaze_action;
+	bool        attached;
+	const char *action_error;    // Why there are no action spaces, or null
+	const char *gaze_error;      // Why there's no eye gaze space, or null
+};
+
+// For measurements that run on their own thread while the frame loop
+// keeps the session going, see spaces_session_start.
+struct spaces_frame_t {
+	const spaces_t      *spaces;
+	std::atomic<int64_t> predicted_time; // Latest predictedDisplayTime
+};
+
+/*** Signatures **************************/
+
+// Needs openxr_runtime_open to have created a session. The action set is
+// attached to the session, which can only happen once per session.
+const char *spaces_create (spaces_t *out_spaces);
+void        spaces_destroy(spaces_t *spaces);
+// xrSyncActions, so the action spaces track. Call it from the frame loop.
+void        spaces_sync   (const spaces_t *spaces);
+
+// Opens the runtime, creates the spaces, and runs the session until it's
+// FOCUSED, with a frame loop that keeps the actions synced and fills out
+// `frame`. Returns an error, or null, and on error everything is closed
+// again.
+const char *spaces_session_start(xr_settings_t settings, spaces_t *out_spaces, spaces_frame_t *out_frame);
+// Stops the session, and closes everything spaces_session_start opened.
+// xr_tables and their strings are left alone, so the measurements built on
+// this can add their tables on either side of it.
+void        spaces_session_stop (spaces_t *spaces);
+
+// -benchLocate: runs a session and, once it's FOCUSED, times xrLocateSpace
+// for every space, xrLocateViews for every view configuration, and batched
+// xrLocateSpaces (OpenXR 1.1 or XR_KHR_locate_spaces) across batch sizes,
+// each for a time in the past, now, and the predicted display time.
+// Each case runs for ms_per_case.
+void        spaces_bench_locate(xr_settings_t settings, float ms_per_case);
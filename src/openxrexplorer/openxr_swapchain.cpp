@@ -0,0 +1,549 @@
+#include "openxr_swapchain.h"
+#include "openxr_session.h"
+#include "app_stats.h"
+#include "imgui/sokol_time.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+/*** Types *******************************/
+
+// One format's trip through -benchSwapchains. Everything but the table is
+// filled in on the session thread.
+struct swapchain_bench_format_t {
+	int64_t     format;
+	bool        depth;
+	bool        started;
+	XrResult    result;       // First call that failed, XR_SUCCESS if none did
+	const char *failed_call;
+	float       create_ms;
+	float       enumerate_ms;
+	float       destroy_ms;
+	uint32_t    image_count;
+	int32_t     count;        // Frames measured
+	float      *acquire;      // us, one per frame
+	float      *wait;
+	float      *release;
+};
+
+struct swapchain_bench_t {
+	swapchain_bench_format_t *formats;
+	int32_t                   format_count;
+	int32_t                   current;
+	int32_t                   frames;        // Per format
+	int32_t                   warmup;        // Frames left to skip, -1 until FOCUSED
+	int32_t                   width;
+	int32_t                   height;
+
+	XrSpace                             space;
+	swapchain_t                         swapchain;
+	XrCompositionLayerQuad              quad;
+	const XrCompositionLayerBaseHeader *quad_ptr;
+};
+
+/*** Global Variables ********************/
+
+const int32_t swapchain_bench_warmup  = 30;
+const float   swapchain_focus_timeout = 10;
+
+/*** Signatures **************************/
+
+static const char     *swapchain_create_faces(swapchain_t *out_swapchain, int32_t width, int32_t height, uint32_t faces);
+static void            swapchain_bench_layers(session_frame_t *frame, void *data);
+static bool            swapchain_bench_frame (const session_frame_t *frame, void *data);
+static void            swapchain_bench_report(const swapchain_bench_t *run);
+static display_table_t swapchain_bench_table ();
+
+/*** Code ********************************/
+
+static const char *swapchain_create_faces(swapchain_t *out_swapchain, int32_t width, int32_t height, uint32_t faces) {
+	*out_swapchain = {};
+	if (xr_session == XR_NULL_HANDLE) return "No XrSession available";
+
+	// Formats come in the runtime's order of preference
+	uint32_t count  = 0;
+	XrResult result = xrEnumerateSwapchainFormats(xr_session, 0, &count, nullptr);
+	if (XR_FAILED(result)) return new_string("xrEnumerateSwapchainFormats: %s", openxr_result_string(result));
+	if (count == 0)        return "The session has no swapchain formats, headless sessions can't have swapchains and the CLI is only headless off Windows";
+	int64_t *formats = (int64_t *)malloc(sizeof(int64_t) * count);
+	xrEnumerateSwapchainFormats(xr_session, count, &count, formats);
+	int64_t format = formats[0];
+	free(formats);
+
+	XrSwapchainCreateInfo info = { XR_TYPE_SWAPCHAIN_CREATE_INFO };
+	info.usageFlags  = XR_SWAPCHAIN_USAGE_COLOR_ATTACHMENT_BIT | XR_SWAPCHAIN_USAGE_SAMPLED_BIT;
+	info.format      = format;
+	info.sampleCount = 1;
+	info.width       = width;
+	info.height      = height;
+	info.faceCount   = faces;
+	info.arraySize   = 1;
+	info.mipCount    = 1;
+	result = xrCreateSwapchain(xr_session, &info, &out_swapchain->handle);
+	if (XR_FAILED(result)) return new_string("xrCreateSwapchain: %s", openxr_result_string(result));
+
+	out_swapchain->format = format;
+	out_swapchain->width  = width;
+	out_swapchain->height = height;
+	// Just the count, the images themselves are graphics API specific
+	xrEnumerateSwapchainImages(out_swapchain->handle, 0, &out_swapchain->image_count, nullptr);
+	return nullptr;
+}
+
+///////////////////////////////////////////
+
+const char *swapchain_create(swapchain_t *out_swapchain, int32_t width, int32_t height) {
+	return swapchain_create_faces(out_swapchain, width, height, 1);
+}
+
+///////////////////////////////////////////
+
+const char *swapchain_create_cube(swapchain_t *out_swapchain, int32_t size) {
+	return swapchain_create_faces(out_swapchain, size, size, 6);
+}
+
+///////////////////////////////////////////
+
+void swapchain_destroy(swapchain_t *swapchain) {
+	if (swapchain->handle != XR_NULL_HANDLE) xrDestroySwapchain(swapchain->handle);
+	*swapchain = {};
+}
+
+///////////////////////////////////////////
+
+XrResult swapchain_cycle(const swapchain_t *swapchain) {
+	uint32_t                    index        = 0;
+	XrSwapchainImageAcquireInfo acquire_info = { XR_TYPE_SWAPCHAIN_IMAGE_ACQUIRE_INFO };
+	XrResult result = xrAcquireSwapchainImage(swapchain->handle, &acquire_info, &index);
+	if (XR_FAILED(result)) return result;
+
+	XrSwapchainImageWaitInfo wait_info = { XR_TYPE_SWAPCHAIN_IMAGE_WAIT_INFO };
+	wait_info.timeout = XR_INFINITE_DURATION;
+	result = xrWaitSwapchainImage(swapchain->handle, &wait_info);
+	if (XR_FAILED(result)) return result;
+
+	XrSwapchainImageReleaseInfo release_info = { XR_TYPE_SWAPCHAIN_IMAGE_RELEASE_INFO };
+	return xrReleaseSwapchainImage(swapchain->handle, &release_info);
+}
+
+///////////////////////////////////////////
+
+void swapchain_quads(const swapchain_t *swapchain, XrSpace space, XrCompositionLayerQuad *out_layers, const XrCompositionLayerBaseHeader **out_layer_ptrs, uint32_t count) {
+	// A grid of small quads a meter out, so they overlap as little as
+	// possible and the compositor can't skip any of them
+	uint32_t columns = 1;
+	while (columns * columns < count) columns += 1;
+	float size = 0.8f / columns;
+
+	for (uint32_t i = 0; i < count; i++) {
+		XrCompositionLayerQuad *quad = &out_layers[i];
+		*quad = { XR_TYPE_COMPOSITION_LAYER_QUAD };
+		quad->layerFlags    = XR_COMPOSITION_LAYER_BLEND_TEXTURE_SOURCE_ALPHA_BIT;
+		quad->space         = space;
+		quad->eyeVisibility = XR_EYE_VISIBILITY_BOTH;
+		quad->subImage.swapchain        = swapchain->handle;
+		quad->subImage.imageRect.extent = { swapchain->width, swapchain->height };
+		quad->pose.orientation          = { 0, 0, 0, 1 };
+		quad->pose.position             = {
+			((i % columns) + 0.5f) * size - 0.4f,
+			((i / columns) + 0.5f) * size - 0.4f,
+			-1 };
+		quad->size = { size * 0.9f, size * 0.9f };
+		out_layer_ptrs[i] = (const XrCompositionLayerBaseHeader *)quad;
+	}
+}
+
+///////////////////////////////////////////
+
+void swapchain_cylinders(const swapchain_t *swapchain, XrSpace space, XrCompositionLayerCylinderKHR *out_layers, const XrCompositionLayerBaseHeader **out_layer_ptrs, uint32_t count) {
+	// Columns turn around the viewer rather than slide across, so every
+	// cylinder is the same distance out
+	uint32_t columns = 1;
+	while (columns * columns < count) columns += 1;
+	float size = 0.8f / columns;
+
+	for (uint32_t i = 0; i < count; i++) {
+		XrCompositionLayerCylinderKHR *cylinder = &out_layers[i];
+		*cylinder = { XR_TYPE_COMPOSITION_LAYER_CYLINDER_KHR };
+		cylinder->layerFlags    = XR_COMPOSITION_LAYER_BLEND_TEXTURE_SOURCE_ALPHA_BIT;
+		cylinder->space         = space;
+		cylinder->eyeVisibility = XR_EYE_VISIBILITY_BOTH;
+		cylinder->subImage.swapchain        = swapchain->handle;
+		cylinder->subImage.imageRect.extent = { swapchain->width, swapchain->height };
+		float yaw = 0.4f - ((i % columns) + 0.5f) * size;
+		cylinder->pose.orientation = { 0, sinf(yaw / 2), 0, cosf(yaw / 2) };
+		cylinder->pose.position    = { 0, ((i / columns) + 0.5f) * size - 0.4f, 0 };
+		cylinder->radius       = 1;
+		cylinder->centralAngle = size * 0.9f;
+		cylinder->aspectRatio  = 1;
+		out_layer_ptrs[i] = (const XrCompositionLayerBaseHeader *)cylinder;
+	}
+}
+
+///////////////////////////////////////////
+
+void swapchain_cubes(const swapchain_t *swapchain, XrSpace space, XrCompositionLayerCubeKHR *out_layers, const XrCompositionLayerBaseHeader **out_layer_ptrs, uint32_t count) {
+	// A cube surrounds the viewer, so there's nowhere to spread them out
+	// to, and blending keeps the compositor from dropping the ones below
+	for (uint32_t i = 0; i < count; i++) {
+		XrCompositionLayerCubeKHR *cube = &out_layers[i];
+		*cube = { XR_TYPE_COMPOSITION_LAYER_CUBE_KHR };
+		cube->layerFlags      = XR_COMPOSITION_LAYER_BLEND_TEXTURE_SOURCE_ALPHA_BIT;
+		cube->space           = space;
+		cube->eyeVisibility   = XR_EYE_VISIBILITY_BOTH;
+		cube->swapchain       = swapchain->handle;
+		cube->imageArrayIndex = 0;
+		cube->orientation     = { 0, 0, 0, 1 };
+		out_layer_ptrs[i] = (const XrCompositionLayerBaseHeader *)cube;
+	}
+}
+
+///////////////////////////////////////////
+
+const char *swapchain_projection_create(swapchain_projection_t *out_projection, XrViewConfigurationType view_config, XrSpace space) {
+	*out_projection = {};
+	out_projection->view_config = view_config;
+
+	const uint32_t          max_views = sizeof(out_projection->views) / sizeof(out_projection->views[0]);
+	XrViewConfigurationView config_views[max_views];
+	for (uint32_t i = 0; i < max_views; i++) config_views[i] = { XR_TYPE_VIEW_CONFIGURATION_VIEW };
+	uint32_t count  = 0;
+	XrResult result = xrEnumerateViewConfigurationViews(xr_instance, xr_system_id, view_config, 0, &count, nullptr);
+	if (XR_FAILED(result)) return new_string("xrEnumerateViewConfigurationViews: %s", openxr_result_string(result));
+	if (count == 0 || count > max_views) return new_string("Unexpected view count: %u", count);
+	xrEnumerateViewConfigurationViews(xr_instance, xr_system_id, view_config, count, &count, config_views);
+
+	// One image wide enough for every view, each view its own rect
+	int32_t width  = (int32_t)config_views[0].recommendedImageRectWidth;
+	int32_t height = (int32_t)config_views[0].recommendedImageRectHeight;
+	const char *error = swapchain_create(&out_projection->swapchain, width * (int32_t)count, height);
+	if (error) return error;
+
+	out_projection->view_count = count;
+	for (uint32_t i = 0; i < count; i++) {
+		out_projection->views[i] = { XR_TYPE_VIEW };
+		XrCompositionLayerProjectionView *view = &out_projection->proj_views[i];
+		*view = { XR_TYPE_COMPOSITION_LAYER_PROJECTION_VIEW };
+		view->subImage.swapchain        = out_projection->swapchain.handle;
+		view->subImage.imageRect.offset = { width * (int32_t)i, 0 };
+		view->subImage.imageRect.extent = { width, height };
+	}
+	out_projection->layer           = { XR_TYPE_COMPOSITION_LAYER_PROJECTION };
+	out_projection->layer.space     = space;
+	out_projection->layer.viewCount = count;
+	out_projection->layer.views     = out_projection->proj_views;
+	return nullptr;
+}
+
+///////////////////////////////////////////
+
+void swapchain_projection_destroy(swapchain_projection_t *projection) {
+	swapchain_destroy(&projection->swapchain);
+	*projection = {};
+}
+
+///////////////////////////////////////////
+
+XrResult swapchain_projection_update(swapchain_projection_t *projection, XrTime display_time) {
+	XrResult result = swapchain_cycle(&projection->swapchain);
+	if (XR_FAILED(result)) return result;
+
+	XrViewLocateInfo locate_info = { XR_TYPE_VIEW_LOCATE_INFO };
+	locate_info.viewConfigurationType = projection->view_config;
+	locate_info.displayTime           = display_time;
+	locate_info.space                 = projection->layer.space;
+	XrViewState state = { XR_TYPE_VIEW_STATE };
+	uint32_t    count = 0;
+	result = xrLocateViews(xr_session, &locate_info, &state, projection->view_count, &count, projection->views);
+	if (XR_FAILED(result)) return result;
+
+	for (uint32_t i = 0; i < projection->view_count; i++) {
+		projection->proj_views[i].pose = projection->views[i].pose;
+		projection->proj_views[i].fov  = projection->views[i].fov;
+	}
+	return XR_SUCCESS;
+}
+
+///////////////////////////////////////////
+
+void swapchain_bench(xr_settings_t settings, int32_t frames) {
+	settings = session_settings(settings);
+	if (frames < 1) frames = 1;
+
+	const char *error = openxr_runtime_open(settings);
+	if (error) {
+		openxr_runtime_close();
+		display_table_t table = swapchain_bench_table();
+		table.error = new_string("Couldn't open the runtime: %s", error);
+		xr_tables.add(table);
+		return;
+	}
+
+	uint32_t format_count = 0;
+	XrResult result       = xrEnumerateSwapchainFormats(xr_session, 0, &format_count, nullptr);
+	if (XR_FAILED(result) || format_count == 0) {
+		display_table_t table = swapchain_bench_table();
+		table.error = XR_FAILED(result)
+			? new_string("xrEnumerateSwapchainFormats: %s", openxr_result_string(result))
+			: "The session has no swapchain formats, headless sessions can't have swapchains and the CLI is only headless off Windows";
+		xr_tables.add(table);
+		openxr_runtime_close();
+		return;
+	}
+	int64_t *formats = (int64_t *)malloc(sizeof(int64_t) * format_count);
+	xrEnumerateSwapchainFormats(xr_session, format_count, &format_count, formats);
+
+	// The size an app would really ask for, the first view's recommended
+	// size
+	swapchain_bench_t run = {};
+	run.frames = frames;
+	run.warmup = -1;
+	XrViewConfigurationType view_config = session_view_config(settings);
+	XrViewConfigurationView config_views[4];
+	uint32_t                view_count = 0;
+	for (int32_t i = 0; i < 4; i++) config_views[i] = { XR_TYPE_VIEW_CONFIGURATION_VIEW };
+	result = xrEnumerateViewConfigurationViews(xr_instance, xr_system_id, view_config, 0, &view_count, nullptr);
+	if (XR_SUCCEEDED(result) && view_count > 0 && view_count <= 4)
+		result = xrEnumerateViewConfigurationViews(xr_instance, xr_system_id, view_config, view_count, &view_count, config_views);
+	if (XR_FAILED(result) || view_count == 0 || view_count > 4) {
+		display_table_t table = swapchain_bench_table();
+		table.error = XR_FAILED(result)
+			? new_string("xrEnumerateViewConfigurationViews: %s", openxr_result_string(result))
+			: new_string("Unexpected view count: %u", view_count);
+		xr_tables.add(table);
+		free(formats);
+		openxr_runtime_close();
+		return;
+	}
+	run.width  = (int32_t)config_views[0].recommendedImageRectWidth;
+	run.height = (int32_t)config_views[0].recommendedImageRectHeight;
+
+	// Color formats get submitted as a quad, as a runtime may not release
+	// images it never saw in a layer the same way
+	XrReferenceSpaceCreateInfo space_info = { XR_TYPE_REFERENCE_SPACE_CREATE_INFO };
+	space_info.referenceSpaceType   = XR_REFERENCE_SPACE_TYPE_VIEW;
+	space_info.poseInReferenceSpace = { {0,0,0,1}, {0,0,0} };
+	result = xrCreateReferenceSpace(xr_session, &space_info, &run.space);
+	if (XR_FAILED(result)) {
+		display_table_t table = swapchain_bench_table();
+		table.error = new_string("xrCreateReferenceSpace: %s", openxr_result_string(result));
+		xr_tables.add(table);
+		free(formats);
+		openxr_runtime_close();
+		return;
+	}
+
+	run.format_count = (int32_t)format_count;
+	run.formats      = (swapchain_bench_format_t *)calloc(format_count, sizeof(swapchain_bench_format_t));
+	for (int32_t f = 0; f < run.format_count; f++) {
+		swapchain_bench_format_t *fmt = &run.formats[f];
+		fmt->format  = formats[f];
+		fmt->depth   = openxr_format_is_depth(formats[f]);
+		fmt->acquire = (float *)malloc(sizeof(float) * frames);
+		fmt->wait    = (float *)malloc(sizeof(float) * frames);
+		fmt->release = (float *)malloc(sizeof(float) * frames);
+	}
+	free(formats);
+
+	session_hooks_t hooks = {};
+	hooks.data      = &run;
+	hooks.on_layers = swapchain_bench_layers;
+	hooks.on_frame  = swapchain_bench_frame;
+	if (session_start(settings, hooks)) {
+		// Generous, so a 30Hz runtime with slow allocations still finishes
+		float expected_s = (run.format_count * (frames + 2) + swapchain_bench_warmup) / 30.0f + run.format_count;
+		session_wait(expected_s + swapchain_focus_timeout);
+		session_stop();
+	}
+	session_info_t info = session_info();
+
+	if (info.error) {
+		display_table_t table = swapchain_bench_table();
+		table.error = info.error;
+		xr_tables.add(table);
+	} else if (run.warmup < 0) {
+		display_table_t table = swapchain_bench_table();
+		table.error = "The session never got to FOCUSED";
+		xr_tables.add(table);
+	} else {
+		swapchain_bench_report(&run);
+	}
+
+	// The session stopped part way through a format
+	if (run.swapchain.handle != XR_NULL_HANDLE) xrDestroySwapchain(run.swapchain.handle);
+	for (int32_t f = 0; f < run.format_count; f++) {
+		free(run.formats[f].acquire);
+		free(run.formats[f].wait);
+		free(run.formats[f].release);
+	}
+	free(run.formats);
+	if (run.space != XR_NULL_HANDLE) xrDestroySpace(run.space);
+	openxr_runtime_close();
+}
+
+///////////////////////////////////////////
+
+static void swapchain_bench_layers(session_frame_t *frame, void *data) {
+	swapchain_bench_t *run = (swapchain_bench_t *)data;
+	if (run->warmup != 0 || run->current >= run->format_count) return;
+	swapchain_bench_format_t *fmt = &run->formats[run->current];
+	if (XR_FAILED(fmt->result)) return;
+
+	if (run->swapchain.handle == XR_NULL_HANDLE) {
+		XrSwapchainCreateInfo info = { XR_TYPE_SWAPCHAIN_CREATE_INFO };
+		info.usageFlags  = fmt->depth
+			? XR_SWAPCHAIN_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT
+			: XR_SWAPCHAIN_USAGE_COLOR_ATTACHMENT_BIT | XR_SWAPCHAIN_USAGE_SAMPLED_BIT;
+		info.format      = fmt->format;
+		info.sampleCount = 1;
+		info.width       = run->width;
+		info.height      = run->height;
+		info.faceCount   = 1;
+		info.arraySize   = 1;
+		info.mipCount    = 1;
+		XrSwapchain handle = XR_NULL_HANDLE;
+		fmt->started = true;
+		uint64_t    start  = stm_now();
+		XrResult    result = xrCreateSwapchain(xr_session, &info, &handle);
+		fmt->create_ms = (float)stm_ms(stm_since(start));
+		if (XR_FAILED(result)) { fmt->result = result; fmt->failed_call = "xrCreateSwapchain"; return; }
+
+		run->swapchain.handle = handle;
+		run->swapchain.format = fmt->format;
+		run->swapchain.width  = run->width;
+		run->swapchain.height = run->height;
+
+		start  = stm_now();
+		result = openxr_swapchain_images(handle, &fmt->image_count);
+		fmt->enumerate_ms = (float)stm_ms(stm_since(start));
+		run->swapchain.image_count = fmt->image_count;
+		if (XR_FAILED(result)) { fmt->result = result; fmt->failed_call = "xrEnumerateSwapchainImages"; return; }
+
+		if (!fmt->depth) swapchain_quads(&run->swapchain, run->space, &run->quad, &run->quad_ptr, 1);
+	}
+	if (fmt->count >= run->frames) return;
+
+	// swapchain_cycle, with a clock read between each call
+	uint32_t                    index        = 0;
+	XrSwapchainImageAcquireInfo acquire_info = { XR_TYPE_SWAPCHAIN_IMAGE_ACQUIRE_INFO };
+	XrSwapchainImageWaitInfo    wait_info    = { XR_TYPE_SWAPCHAIN_IMAGE_WAIT_INFO };
+	XrSwapchainImageReleaseInfo release_info = { XR_TYPE_SWAPCHAIN_IMAGE_RELEASE_INFO };
+	wait_info.timeout = XR_INFINITE_DURATION;
+
+	uint64_t t0     = stm_now();
+	XrResult result = xrAcquireSwapchainImage(run->swapchain.handle, &acquire_info, &index);
+	uint64_t t1     = stm_now();
+	if (XR_FAILED(result)) { fmt->result = result; fmt->failed_call = "xrAcquireSwapchainImage"; return; }
+	result          = xrWaitSwapchainImage(run->swapchain.handle, &wait_info);
+	uint64_t t2     = stm_now();
+	if (XR_FAILED(result)) { fmt->result = result; fmt->failed_call = "xrWaitSwapchainImage"; return; }
+	result          = xrReleaseSwapchainImage(run->swapchain.handle, &release_info);
+	uint64_t t3     = stm_now();
+	if (XR_FAILED(result)) { fmt->result = result; fmt->failed_call = "xrReleaseSwapchainImage"; return; }
+
+	fmt->acquire[fmt->count] = (float)stm_us(stm_diff(t1, t0));
+	fmt->wait   [fmt->count] = (float)stm_us(stm_diff(t2, t1));
+	fmt->release[fmt->count] = (float)stm_us(stm_diff(t3, t2));
+	fmt->count += 1;
+
+	// Depth can't go in a layer on its own
+	if (!fmt->depth) {
+		frame->layers      = &run->quad_ptr;
+		frame->layer_count = 1;
+	}
+}
+
+///////////////////////////////////////////
+
+static bool swapchain_bench_frame(const session_frame_t *frame, void *data) {
+	swapchain_bench_t *run = (swapchain_bench_t *)data;
+	// The runtime may still want a few frames on the way out
+	if (run->current >= run->format_count) return false;
+
+	if (run->warmup < 0) {
+		if (frame->session_state == XR_SESSION_STATE_FOCUSED) run->warmup = swapchain_bench_warmup;
+		return true;
+	}
+	if (run->warmup > 0) { run->warmup -= 1; return true; }
+
+	// Destroyed after xrEndFrame, so it's never in a layer that's still on
+	// its way to the compositor
+	swapchain_bench_format_t *fmt = &run->formats[run->current];
+	if (XR_FAILED(fmt->result) || fmt->count >= run->frames) {
+		if (run->swapchain.handle != XR_NULL_HANDLE) {
+			uint64_t start = stm_now();
+			xrDestroySwapchain(run->swapchain.handle);
+			fmt->destroy_ms = (float)stm_ms(stm_since(start));
+			run->swapchain  = {};
+		}
+		run->current += 1;
+	}
+	return run->current < run->format_count;
+}
+
+///////////////////////////////////////////
+
+static void swapchain_bench_report(const swapchain_bench_t *run) {
+	display_table_t table = swapchain_bench_table();
+
+	float *sorted = (float *)malloc(sizeof(float) * run->frames * 3);
+	for (int32_t f = 0; f < run->format_count; f++) {
+		const swapchain_bench_format_t *fmt  = &run->formats[f];
+		const char                     *name = openxr_format_name(fmt->format);
+		if (!fmt->started) {
+			table.cols[0].add({ name ? name : new_string("Unknown 0x%llx", (long long)fmt->format) });
+			table.cols[1].add({ "Not reached" });
+			table.cols[2].add({ "-" });
+			continue;
+		}
+
+		table.cols[0].add({ new_string("%s%s, %u images",
+			name ? name : new_string("Unknown 0x%llx", (long long)fmt->format),
+			fmt->depth ? " (not submitted)" : "",
+			fmt->image_count) });
+		if (XR_FAILED(fmt->result) && fmt->count == 0) {
+			table.cols[1].add({ new_string("%s: %s", fmt->failed_call, openxr_result_string(fmt->result)) });
+			table.cols[2].add({ "-" });
+			continue;
+		}
+		table.cols[1].add({ new_string("%.2f / %.2f / %.2f", fmt->create_ms, fmt->enumerate_ms, fmt->destroy_ms) });
+		if (fmt->count == 0) {
+			table.cols[2].add({ "-" });
+			continue;
+		}
+
+		// Acquire, wait and release side by side in one buffer
+		int32_t count = fmt->count;
+		float  *calls[3] = { &sorted[0], &sorted[run->frames], &sorted[run->frames * 2] };
+		memcpy(calls[0], fmt->acquire, sizeof(float) * count);
+		memcpy(calls[1], fmt->wait,    sizeof(float) * count);
+		memcpy(calls[2], fmt->release, sizeof(float) * count);
+		for (int32_t c = 0; c < 3; c++) qsort(calls[c], count, sizeof(float), stats_float_cmp);
+		table.cols[2].add({ new_string("%.1f / %.1f / %.1f, %.1f / %.1f / %.1f%s",
+			stats_percentile(calls[0], count, 0.5f),  stats_percentile(calls[1], count, 0.5f),  stats_percentile(calls[2], count, 0.5f),
+			stats_percentile(calls[0], count, 0.99f), stats_percentile(calls[1], count, 0.99f), stats_percentile(calls[2], count, 0.99f),
+			XR_FAILED(fmt->result) ? new_string(", then %s: %s", fmt->failed_call, openxr_result_string(fmt->result)) : "") });
+	}
+	free(sorted);
+
+	if (run->current < run->format_count)
+		table.error = new_string("Stopped early, %d of %d formats measured", run->current, run->format_count);
+	xr_tables.add(table);
+}
+
+///////////////////////////////////////////
+
+static display_table_t swapchain_bench_table() {
+	display_table_t table = {};
+	table.name_func    = "benchSwapchains";
+	table.name_type    = "swapchainLifecycle";
+	table.spec         = "xrCreateSwapchain";
+	table.tag          = display_tag_misc;
+	table.column_count = 3;
+	table.header_row   = true;
+	table.cols[0].add({ "Format" });
+	table.cols[1].add({ "Create / enumerate / destroy (ms)" });
+	table.cols[2].add({ "Acquire / wait / release p50, p99 (us)" });
+	return table;
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "openxr_info.h"
+
+#include <stdint.h>
+
+// Swapchains and composition layers for the session measurements, see
+// openxr_session.h. Nothing is ever rendered into the images, they're only
+// acquired and released so there's something valid to submit. Headless
+// sessions can't have swapchains, so everything here fails on them.
+
+/*** Types *******************************/
+
+struct swapchain_t {
+	XrSwapchain handle;
+	int64_t     format;
+	int32_t     width;
+	int32_t     height;
+	uint32_t    image_count;
+};
+
+// A projection layer over one swapchain, with each view side by side
+struct swapchain_projection_t {
+	swapchain_t                      swapchain;
+	XrViewConfigurationType          view_config;
+	uint32_t                         view_count;
+	XrView                           views     [4];
+	XrCompositionLayerProjectionView proj_views[4];
+	XrCompositionLayerProjection     layer;
+};
+
+/*** Signatures **************************/
+
+// A color swapchain in the runtime's preferred format. Returns an error,
+// or null.
+const char *swapchain_create (swapchain_t *out_swapchain, int32_t width, int32_t height);
+// The same, with six faces, for XrCompositionLayerCubeKHR
+const char *swapchain_create_cube(swapchain_t *out_swapchain, int32_t size);
+void        swapchain_destroy(swapchain_t *swapchain);
+// Acquires, waits for and releases the next image, the least a swapchain
+// needs before xrEndFrame will take a layer that uses it.
+XrResult    swapchain_cycle  (const swapchain_t *swapchain);
+
+// Fills out `count` quad layers showing the swapchain, spread out in
+// front of the viewer in `space`, and a pointer to each in out_layer_ptrs,
+// which is the form XrFrameEndInfo takes them in.
+void        swapchain_quads  (const swapchain_t *swapchain, XrSpace space, XrCompositionLayerQuad *out_layers, const XrCompositionLayerBaseHeader **out_layer_ptrs, uint32_t count);
+// The same grid as swapchain_quads, bent onto cylinders a meter around
+// the viewer, for XR_KHR_composition_layer_cylinder.
+void        swapchain_cylinders(const swapchain_t *swapchain, XrSpace space, XrCompositionLayerCylinderKHR *out_layers, const XrCompositionLayerBaseHeader **out_layer_ptrs, uint32_t count);
+// `count` copies of one cube layer over a swapchain from
+// swapchain_create_cube, for XR_KHR_composition_layer_cube.
+void        swapchain_cubes    (const swapchain_t *swapchain, XrSpace space, XrCompositionLayerCubeKHR *out_layers, const XrCompositionLayerBaseHeader **out_layer_ptrs, uint32_t count);
+
+// A projection layer at the view configuration's recommended size, shown
+// in `space`. Returns an error, or null.
+const char *swapchain_projection_create (swapchain_projection_t *out_projection, XrViewConfigurationType view_config, XrSpace space);
+void        swapchain_projection_destroy(swapchain_projection_t *projection);
+// Cycles the swapchain and locates the views for display_time, once a
+// frame before the layer goes to xrEndFrame.
+XrResult    swapchain_projection_update (swapchain_projection_t *projection, XrTime display_time);
+
+// -benchSwapchains: for each of the session's swapchain formats, at the
+// first view's recommended size, times xrCreateSwapchain, the
+// xrEnumerateSwapchainImages calls and xrDestroySwapchain, and each of
+// acquire, wait and release over `frames` frames of the running session.
+// Color formats are submitted as a quad, depth formats are only cycled.
+void        swapchain_bench(xr_settings_t settings, int32_t frames);
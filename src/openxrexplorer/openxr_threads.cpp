@@ -0,0 +1,319 @@
+#include "openxr_threads.h"
+#include "openxr_session.h"
+#include "openxr_spaces.h"
+#include "app_stats.h"
+#include "imgui/sokol_time.h"
+
+#if defined(_WIN32)
+#include <Windows.h>
+#else
+#define XR_USE_TIMESPEC
+#include <time.h>
+#endif
+#include <openxr/openxr_platform.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+/*** Types *******************************/
+
+enum threads_call_ {
+	threads_call_locate_space,
+	threads_call_paths,
+	threads_call_action_pose,
+	threads_call_convert_time,
+	threads_call_count,
+};
+
+struct threads_run_t {
+	threads_call_         call;
+	const spaces_t       *spaces;
+	const spaces_frame_t *frame;
+#if defined(_WIN32)
+	PFN_xrConvertWin32PerformanceCounterToTimeKHR convert;
+#else
+	PFN_xrConvertTimespecTimeToTimeKHR            convert;
+#endif
+	std::atomic<int32_t>  ready;
+	std::atomic<bool>     go;
+	std::atomic<bool>     stop;
+};
+
+// Everything a worker touches while it's measuring is allocated up front
+struct threads_worker_t {
+	threads_run_t *run;
+	int32_t        index;
+	XrSpace        space;        // Its own, so no two threads locate the same handle
+	char           path[64];     // Its own, so no two threads look up the same path
+	uint64_t       calls;
+	uint64_t       ticks;
+	float         *samples;      // ns per call, an even spread of them once full
+	int32_t        sample_count;
+	uint32_t       random;
+	XrResult       result;
+};
+
+/*** Global Variables ********************/
+
+// Calls between clock reads
+const int32_t threads_chunk        = 16;
+const int32_t threads_max_samples  = 16384;
+const int32_t threads_max          = 64;
+const char   *threads_call_names[] = {
+	"xrLocateSpace",
+	"xrStringToPath + xrPathToString",
+	"xrGetActionStatePose",
+#if defined(_WIN32)
+	"xrConvertWin32PerformanceCounterToTimeKHR",
+#else
+	"xrConvertTimespecTimeToTimeKHR",
+#endif
+};
+
+/*** Signatures **************************/
+
+static void            threads_worker   (threads_worker_t *worker);
+static display_table_t threads_table    (threads_call_ call);
+static void            threads_sample   (threads_worker_t *worker, float ns);
+
+/*** Code ********************************/
+
+void threads_bench(xr_settings_t settings, int32_t max_threads, float ms_per_case) {
+	settings = session_settings(settings);
+	if (max_threads < 1)           max_threads = 1;
+	if (max_threads > threads_max) max_threads = threads_max;
+
+	spaces_t       spaces = {};
+	spaces_frame_t frame  = {};
+	const char    *error  = spaces_session_start(settings, &spaces, &frame);
+	if (error) {
+		display_table_t table = threads_table(threads_call_locate_space);
+		table.error = error;
+		xr_tables.add(table);
+		return;
+	}
+
+	display_table_t tables[threads_call_count];
+	for (int32_t c = 0; c < threads_call_count; c++) tables[c] = threads_table((threads_call_)c);
+
+	threads_run_t run = {};
+	run.spaces = &spaces;
+	run.frame  = &frame;
+#if defined(_WIN32)
+	const char *convert_name = "xrConvertWin32PerformanceCounterToTimeKHR";
+#else
+	const char *convert_name = "xrConvertTimespecTimeToTimeKHR";
+#endif
+	if (XR_FAILED(xrGetInstanceProcAddr(xr_instance, convert_name, (PFN_xrVoidFunction *)&run.convert)))
+		run.convert = nullptr;
+	if (run.convert == nullptr)
+		tables[threads_call_convert_time].error = new_string("The runtime doesn't have %s", convert_name);
+	if (!spaces.attached)
+		tables[threads_call_action_pose].error = spaces.action_error ? spaces.action_error : "No actions";
+
+	// Each thread gets its own space and path, as an engine's threads would.
+	// VIEW if there is one, since it's the space an engine locates most.
+	// The pose actions can't be per thread, nothing can be added to an
+	// action set once it's attached, so threads share the grip and aim
+	// actions of both hands between them.
+	XrReferenceSpaceCreateInfo space_info = { XR_TYPE_REFERENCE_SPACE_CREATE_INFO };
+	space_info.referenceSpaceType   = spaces.view >= 0 ? XR_REFERENCE_SPACE_TYPE_VIEW : XR_REFERENCE_SPACE_TYPE_LOCAL;
+	space_info.poseInReferenceSpace = { {0,0,0,1}, {0,0,0} };
+
+	threads_worker_t workers[threads_max] = {};
+	std::thread      threads[threads_max];
+	float           *all_samples = (float *)malloc(sizeof(float) * threads_max_samples * max_threads);
+	for (int32_t t = 0; t < max_threads; t++) {
+		workers[t].samples = (float *)malloc(sizeof(float) * threads_max_samples);
+		workers[t].run     = &run;
+		workers[t].index   = t;
+		workers[t].random  = 0x9E3779B9u * (t + 1);
+		XrResult result = xrCreateReferenceSpace(xr_session, &space_info, &workers[t].space);
+		if (XR_FAILED(result) && !tables[threads_call_locate_space].error)
+			tables[threads_call_locate_space].error = new_string("xrCreateReferenceSpace: %s", openxr_result_string(result));
+
+		// Looked up once here, so the timed calls are lookups rather than
+		// the runtime adding a new path
+		XrPath path = XR_NULL_PATH;
+		snprintf(workers[t].path, sizeof(workers[t].path), "/bench_threads/thread_%d", t);
+		result = xrStringToPath(xr_instance, workers[t].path, &path);
+		if (XR_FAILED(result) && !tables[threads_call_paths].error)
+			tables[threads_call_paths].error = new_string("xrStringToPath: %s", openxr_result_string(result));
+	}
+
+	// 1, 2, 4... and max_threads itself if it isn't a power of two
+	int32_t counts[16];
+	int32_t count_count = 0;
+	for (int32_t n = 1; n < max_threads && count_count < 15; n *= 2) counts[count_count++] = n;
+	counts[count_count++] = max_threads;
+
+	for (int32_t c = 0; c < threads_call_count; c++) {
+		if (tables[c].error) continue;
+		run.call = (threads_call_)c;
+
+		double single_rate = 0;
+		for (int32_t i = 0; i < count_count; i++) {
+			int32_t thread_count = counts[i];
+			run.ready.store(0);
+			run.go   .store(false);
+			run.stop .store(false);
+			for (int32_t t = 0; t < thread_count; t++) {
+				workers[t].calls        = 0;
+				workers[t].ticks        = 0;
+				workers[t].sample_count = 0;
+				workers[t].result       = XR_SUCCESS;
+				threads[t] = std::thread(threads_worker, &workers[t]);
+			}
+
+			// Everyone starts together, so thread creation isn't in the
+			// measurement
+			while (run.ready.load() < thread_count) std::this_thread::yield();
+			uint64_t start = stm_now();
+			run.go.store(true);
+			std::this_thread::sleep_for(std::chrono::microseconds((int64_t)(ms_per_case * 1000)));
+			run.stop.store(true);
+			for (int32_t t = 0; t < thread_count; t++) threads[t].join();
+			double seconds = stm_sec(stm_since(start));
+
+			uint64_t calls   = 0;
+			double   slowest = 0;
+			int32_t  samples = 0;
+			XrResult result  = XR_SUCCESS;
+			for (int32_t t = 0; t < thread_count; t++) {
+				calls += workers[t].calls;
+				if (workers[t].calls > 0) {
+					double mean = stm_ns(workers[t].ticks) / workers[t].calls;
+					if (mean > slowest) slowest = mean;
+				}
+				if (XR_FAILED(workers[t].result)) result = workers[t].result;
+				memcpy(&all_samples[samples], workers[t].samples, sizeof(float) * workers[t].sample_count);
+				samples += workers[t].sample_count;
+			}
+			qsort(all_samples, samples, sizeof(float), stats_float_cmp);
+
+			double rate = calls / seconds;
+			if (i == 0) single_rate = rate;
+			tables[c].cols[0].add({ new_string("%d", thread_count) });
+			if (XR_FAILED(result)) {
+				tables[c].cols[1].add({ openxr_result_string(result) });
+				tables[c].cols[2].add({ "-" });
+				break;
+			}
+			tables[c].cols[1].add({ new_string("%.0f, %.2fx one thread", rate, single_rate > 0 ? rate / single_rate : 0) });
+			tables[c].cols[2].add({ samples > 0
+				? new_string("%.0f / %.0f, %.0f", stats_percentile(all_samples, samples, 0.5f), stats_percentile(all_samples, samples, 0.99f), slowest)
+				: "-" });
+		}
+	}
+	for (int32_t c = 0; c < threads_call_count; c++) xr_tables.add(tables[c]);
+
+	for (int32_t t = 0; t < max_threads; t++) {
+		if (workers[t].space != XR_NULL_HANDLE) xrDestroySpace(workers[t].space);
+		free(workers[t].samples);
+	}
+	free(all_samples);
+	spaces_session_stop(&spaces);
+}
+
+///////////////////////////////////////////
+
+static void threads_worker(threads_worker_t *worker) {
+	threads_run_t  *run    = worker->run;
+	const spaces_t *spaces = run->spaces;
+
+	XrSpaceLocation      location   = { XR_TYPE_SPACE_LOCATION };
+	char                 path_buffer[XR_MAX_PATH_LENGTH];
+	XrActionStatePose    pose_state = { XR_TYPE_ACTION_STATE_POSE };
+	XrActionStateGetInfo pose_info  = { XR_TYPE_ACTION_STATE_GET_INFO };
+	pose_info.action        = spaces->pose_actions[worker->index % 2];
+	pose_info.subactionPath = spaces->hand_paths  [(worker->index / 2) % 2];
+	XrTime converted = 0;
+
+	run->ready.fetch_add(1);
+	while (!run->go.load()) std::this_thread::yield();
+
+	XrResult result = XR_SUCCESS;
+	while (!run->stop.load()) {
+		XrTime time = run->frame->predicted_time.load();
+#if defined(_WIN32)
+		LARGE_INTEGER now;
+		QueryPerformanceCounter(&now);
+#else
+		timespec now;
+		clock_gettime(CLOCK_MONOTONIC, &now);
+#endif
+		// Every call is timed on its own, so a slow one shows in the p99
+		// rather than being averaged away. Each call's end is the next
+		// one's start, so that's one clock read per call.
+		uint64_t start = stm_now();
+		uint64_t prev  = start;
+		for (int32_t i = 0; i < threads_chunk && XR_SUCCEEDED(result); i++) {
+			switch (run->call) {
+			case threads_call_locate_space: {
+				result = xrLocateSpace(worker->space, spaces->base, time, &location);
+			} break;
+			case threads_call_paths: {
+				XrPath   path   = XR_NULL_PATH;
+				uint32_t length = 0;
+				result = xrStringToPath(xr_instance, worker->path, &path);
+				if (XR_SUCCEEDED(result))
+					result = xrPathToString(xr_instance, path, sizeof(path_buffer), &length, path_buffer);
+			} break;
+			case threads_call_action_pose: {
+				result = xrGetActionStatePose(xr_session, &pose_info, &pose_state);
+			} break;
+			case threads_call_convert_time: {
+				result = run->convert(xr_instance, &now, &converted);
+			} break;
+			default: break;
+			}
+			uint64_t end = stm_now();
+			threads_sample(worker, (float)stm_ns(end - prev));
+			worker->calls += 1;
+			prev = end;
+		}
+		worker->ticks += prev - start;
+		if (XR_FAILED(result)) {
+			worker->result = result;
+			break;
+		}
+	}
+}
+
+///////////////////////////////////////////
+
+static void threads_sample(threads_worker_t *worker, float ns) {
+	// Reservoir sampling: once the buffer is full, each new call replaces a
+	// random earlier one with the odds that keep every call equally likely
+	// to be in it, so the percentiles cover the whole run, not its start.
+	if (worker->sample_count < threads_max_samples) {
+		worker->samples[worker->sample_count++] = ns;
+		return;
+	}
+	worker->random ^= worker->random << 13;
+	worker->random ^= worker->random >> 17;
+	worker->random ^= worker->random << 5;
+	uint64_t slot = worker->random % (worker->calls + 1);
+	if (slot < (uint64_t)threads_max_samples)
+		worker->samples[slot] = ns;
+}
+
+///////////////////////////////////////////
+
+static display_table_t threads_table(threads_call_ call) {
+	display_table_t table = {};
+	table.name_func    = "benchThreads";
+	table.name_type    = threads_call_names[call];
+	table.spec         = call == threads_call_paths ? "xrStringToPath" : threads_call_names[call];
+	table.tag          = display_tag_misc;
+	table.column_count = 3;
+	table.header_row   = true;
+	table.cols[0].add({ "Threads" });
+	table.cols[1].add({ "Calls per second, all threads" });
+	table.cols[2].add({ "ns per call p50 / p99, slowest thread's mean" });
+	return table;
+}
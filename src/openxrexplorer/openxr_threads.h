@@ -0,0 +1,21 @@
+#pragma once
+
+#include "openxr_info.h"
+
+#include <stdint.h>
+
+// Calls OpenXR from several threads at once against one running session,
+// to show when a runtime serializes them on its own locks. See
+// openxr_session.h and openxr_spaces.h for the session they run against.
+
+/*** Signatures **************************/
+
+// -benchThreads: for 1, 2, 4... up to max_threads threads, runs
+// xrLocateSpace, xrStringToPath with xrPathToString, xrGetActionStatePose,
+// and the runtime's clock conversion on every thread at once for
+// ms_per_case, and reports total calls per second against one thread, and
+// per call latency. A runtime that takes a lock on these shows as a flat
+// or falling line as threads are added. Each thread locates its own space
+// and looks up its own path, the pose actions are shared since an attached
+// action set can't grow. Latencies include one clock read per call.
+void threads_bench(xr_settings_t settings, int32_t max_threads, float ms_per_case);
@@ -0,0 +1,530 @@
+#include "openxr_tracking.h"
+#include "openxr_session.h"
+#include "openxr_spaces.h"
+#include "app_stats.h"
+#include "imgui/sokol_time.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <chrono>
+#include <thread>
+
+/*** Types *******************************/
+
+struct tracking_source_t {
+	const char      *name;
+	XrSpace          space;      // Null for a hand
+	XrHandTrackerEXT hand;
+	int32_t          pose_count; // 1, or every joint for a hand
+};
+
+struct tracking_t {
+	tracking_source_t           sources[16];
+	int32_t                     count;
+	XrHandTrackerEXT            hands[2];
+	PFN_xrLocateHandJointsEXT   locate_joints;
+	PFN_xrDestroyHandTrackerEXT destroy_hand;
+	const char                 *hand_error;
+};
+
+// One per source, everything sampling touches is allocated up front
+struct tracking_rate_t {
+	XrPosef  last[XR_HAND_JOINT_COUNT_EXT];
+	bool     has_last;
+	bool     was_valid;
+	uint64_t last_change;     // stm ticks, 0 until the first change seen
+	int64_t  samples;
+	int64_t  changes;
+	int64_t  valid;
+	int64_t  tracked;
+	int64_t  dropouts;
+	float   *intervals;       // ms between changes
+	int32_t  interval_count;
+	float   *staleness;       // ms since the last change, every valid read
+	int32_t  staleness_count;
+};
+
+// Where a source was predicted to be, for one query and horizon
+struct tracking_pending_t {
+	XrTime  target;
+	XrPosef poses[16];
+	bool    valid[16];
+};
+
+struct tracking_error_t {
+	float   time_ms;     // Since sampling started, when the prediction was made
+	uint8_t source;
+	uint8_t horizon;
+	float   position_mm;
+	float   angle_deg;
+};
+
+// Holds the latest `capacity` errors, count is every error ever added
+struct tracking_ring_t {
+	tracking_error_t *errors;
+	int32_t           capacity;
+	int64_t           count;
+};
+
+/*** Global Variables ********************/
+
+const float tracking_sample_hz = 2000;
+// Reads that change nearly every time mean the runtime extrapolates to
+// the time it's asked for, rather than handing back its latest sample
+const float tracking_extrapolated = 0.9f;
+const float   tracking_horizons_ms[]  = { 0, 10, 20, 30, 40, 50 };
+const int32_t tracking_horizon_count  = sizeof(tracking_horizons_ms) / sizeof(tracking_horizons_ms[0]);
+const float   tracking_query_ms       = 10;
+// How long after a predicted time to locate it again, so the runtime has
+// tracking samples from either side of it
+const float   tracking_settle_ms      = 100;
+// Queries in flight per horizon, enough for (50 + 100) / 10 of them
+const int32_t tracking_pending_max    = 32;
+// 8 MB of errors, a couple of minutes with every source tracked
+const int32_t tracking_ring_capacity  = 1 << 19;
+const XrSpaceLocationFlags tracking_valid_bits   = XR_SPACE_LOCATION_ORIENTATION_VALID_BIT   | XR_SPACE_LOCATION_POSITION_VALID_BIT;
+const XrSpaceLocationFlags tracking_tracked_bits = XR_SPACE_LOCATION_ORIENTATION_TRACKED_BIT | XR_SPACE_LOCATION_POSITION_TRACKED_BIT;
+
+/*** Signatures **************************/
+
+static void                 tracking_create    (tracking_t *out_tracking, const spaces_t *spaces);
+static void                 tracking_destroy   (tracking_t *tracking);
+static XrSpaceLocationFlags tracking_locate    (const tracking_t *tracking, const tracking_source_t *source, XrSpace base, XrTime time, XrPosef *out_poses, XrHandJointLocationEXT *joints);
+static void                 tracking_ring_add  (tracking_ring_t *ring, const tracking_error_t *error);
+static tracking_error_t     tracking_pose_error(const XrPosef *predicted, const XrPosef *actual);
+static bool                 tracking_csv       (const tracking_ring_t *ring, const tracking_t *tracking, const char *csv_file);
+static void                 tracking_add_unavailable(display_table_t *table, const spaces_t *spaces, const tracking_t *tracking);
+static display_table_t      tracking_table     (const char *name_func, const char *name_type, const char *spec, const char *col0, const char *col1, const char *col2);
+
+/*** Code ********************************/
+
+static void tracking_create(tracking_t *out_tracking, const spaces_t *spaces) {
+	*out_tracking = {};
+
+	// The head, then the controllers and eye gaze
+	if (spaces->view >= 0) {
+		tracking_source_t *source = &out_tracking->sources[out_tracking->count++];
+		source->name       = "Head (VIEW)";
+		source->space      = spaces->spaces[spaces->view];
+		source->pose_count = 1;
+	}
+	for (int32_t s = spaces->reference_count; s < spaces->count; s++) {
+		tracking_source_t *source = &out_tracking->sources[out_tracking->count++];
+		source->name       = spaces->names[s];
+		source->space      = spaces->spaces[s];
+		source->pose_count = 1;
+	}
+
+	// And the hands
+	if (!openxr_has_ext(XR_EXT_HAND_TRACKING_EXTENSION_NAME)) {
+		out_tracking->hand_error = "Needs " XR_EXT_HAND_TRACKING_EXTENSION_NAME;
+		return;
+	}
+	XrSystemHandTrackingPropertiesEXT hand_properties = { XR_TYPE_SYSTEM_HAND_TRACKING_PROPERTIES_EXT };
+	XrSystemProperties                properties      = { XR_TYPE_SYSTEM_PROPERTIES };
+	properties.next = &hand_properties;
+	xrGetSystemProperties(xr_instance, xr_system_id, &properties);
+	if (!hand_properties.supportsHandTracking) {
+		out_tracking->hand_error = "The system doesn't support hand tracking";
+		return;
+	}
+
+	PFN_xrCreateHandTrackerEXT create_hand = nullptr;
+	if (XR_FAILED(xrGetInstanceProcAddr(xr_instance, "xrCreateHandTrackerEXT",  (PFN_xrVoidFunction *)&create_hand)) ||
+		XR_FAILED(xrGetInstanceProcAddr(xr_instance, "xrDestroyHandTrackerEXT", (PFN_xrVoidFunction *)&out_tracking->destroy_hand)) ||
+		XR_FAILED(xrGetInstanceProcAddr(xr_instance, "xrLocateHandJointsEXT",   (PFN_xrVoidFunction *)&out_tracking->locate_joints))) {
+		out_tracking->hand_error = "Couldn't load the XR_EXT_hand_tracking functions";
+		return;
+	}
+	const char *hand_names[2] = { "Left hand joints", "Right hand joints" };
+	for (int32_t h = 0; h < 2; h++) {
+		XrHandTrackerCreateInfoEXT info = { XR_TYPE_HAND_TRACKER_CREATE_INFO_EXT };
+		info.hand         = h == 0 ? XR_HAND_LEFT_EXT : XR_HAND_RIGHT_EXT;
+		info.handJointSet = XR_HAND_JOINT_SET_DEFAULT_EXT;
+		XrResult result = create_hand(xr_session, &info, &out_tracking->hands[h]);
+		if (XR_FAILED(result)) {
+			out_tracking->hand_error = new_string("xrCreateHandTrackerEXT: %s", openxr_result_string(result));
+			continue;
+		}
+		tracking_source_t *source = &out_tracking->sources[out_tracking->count++];
+		source->name       = hand_names[h];
+		source->hand       = out_tracking->hands[h];
+		source->pose_count = XR_HAND_JOINT_COUNT_EXT;
+	}
+}
+
+///////////////////////////////////////////
+
+static void tracking_destroy(tracking_t *tracking) {
+	for (int32_t h = 0; h < 2; h++) {
+		if (tracking->hands[h] != XR_NULL_HANDLE) tracking->destroy_hand(tracking->hands[h]);
+	}
+	*tracking = {};
+}
+
+///////////////////////////////////////////
+
+static XrSpaceLocationFlags tracking_locate(const tracking_t *tracking, const tracking_source_t *source, XrSpace base, XrTime time, XrPosef *out_poses, XrHandJointLocationEXT *joints) {
+	if (source->space != XR_NULL_HANDLE) {
+		XrSpaceLocation location = { XR_TYPE_SPACE_LOCATION };
+		if (XR_FAILED(xrLocateSpace(source->space, base, time, &location))) return 0;
+		out_poses[0] = location.pose;
+		return location.locationFlags;
+	}
+
+	// A hand counts as valid and tracked by its palm, and as changed if
+	// any of its joints did
+	XrHandJointsLocateInfoEXT info = { XR_TYPE_HAND_JOINTS_LOCATE_INFO_EXT };
+	info.baseSpace = base;
+	info.time      = time;
+	XrHandJointLocationsEXT locations = { XR_TYPE_HAND_JOINT_LOCATIONS_EXT };
+	locations.jointCount     = XR_HAND_JOINT_COUNT_EXT;
+	locations.jointLocations = joints;
+	if (XR_FAILED(tracking->locate_joints(source->hand, &info, &locations)) || !locations.isActive) return 0;
+	for (int32_t j = 0; j < XR_HAND_JOINT_COUNT_EXT; j++) out_poses[j] = joints[j].pose;
+	return joints[XR_HAND_JOINT_PALM_EXT].locationFlags;
+}
+
+///////////////////////////////////////////
+
+void tracking_rate(xr_settings_t settings, float seconds) {
+	settings = session_settings(settings);
+
+	spaces_t       spaces = {};
+	spaces_frame_t frame  = {};
+	const char    *error  = spaces_session_start(settings, &spaces, &frame);
+	if (error) {
+		display_table_t table = tracking_table("trackingRate", "trackingRateUpdates", "xrLocateSpace",
+			"Source", "Updates per second", "Between updates p50 / p99 (ms)");
+		table.error = error;
+		xr_tables.add(table);
+		return;
+	}
+	tracking_t tracking = {};
+	tracking_create(&tracking, &spaces);
+
+	int32_t                capacity = (int32_t)(seconds * tracking_sample_hz) + 16;
+	tracking_rate_t        rates[16] = {};
+	XrPosef                poses [XR_HAND_JOINT_COUNT_EXT];
+	XrHandJointLocationEXT joints[XR_HAND_JOINT_COUNT_EXT];
+	for (int32_t s = 0; s < tracking.count; s++) {
+		rates[s].intervals = (float *)malloc(sizeof(float) * capacity);
+		rates[s].staleness = (float *)malloc(sizeof(float) * capacity);
+	}
+
+	// Reads are asked for now, as an app reading input would. Without the
+	// clock conversion, the frame loop's latest predicted display time is
+	// the closest thing there is.
+	bool     has_clock = session_xr_time(stm_now()) != 0;
+	int64_t  reads     = 0;
+	uint64_t start     = stm_now();
+	while (stm_sec(stm_since(start)) < seconds) {
+		double next_ns = reads * (1e9 / tracking_sample_hz);
+		while (stm_ns(stm_since(start)) < next_ns) {
+			if (next_ns - stm_ns(stm_since(start)) > 200000) std::this_thread::sleep_for(std::chrono::microseconds(100));
+			else                                            std::this_thread::yield();
+		}
+		reads += 1;
+
+		XrTime time = has_clock ? session_xr_time(stm_now()) : frame.predicted_time.load();
+		for (int32_t s = 0; s < tracking.count; s++) {
+			const tracking_source_t *source = &tracking.sources[s];
+			tracking_rate_t         *rate   = &rates[s];
+			XrSpaceLocationFlags     flags  = tracking_locate(&tracking, source, spaces.base, time, poses, joints);
+			uint64_t                 now    = stm_now();
+
+			bool valid   = (flags & tracking_valid_bits  ) == tracking_valid_bits;
+			bool tracked = (flags & tracking_tracked_bits) == tracking_tracked_bits;
+			rate->samples += 1;
+			if (valid)   rate->valid   += 1;
+			if (tracked) rate->tracked += 1;
+			if (rate->was_valid && !valid) rate->dropouts += 1;
+			rate->was_valid = valid;
+			if (!valid) continue;
+
+			// The first valid read is where counting starts, there's no
+			// telling how old it already was
+			size_t size = sizeof(XrPosef) * source->pose_count;
+			if (rate->has_last && memcmp(rate->last, poses, size) != 0) {
+				if (rate->last_change != 0 && rate->interval_count < capacity)
+					rate->intervals[rate->interval_count++] = (float)stm_ms(stm_diff(now, rate->last_change));
+				rate->last_change = now;
+				rate->changes    += 1;
+			}
+			memcpy(rate->last, poses, size);
+			rate->has_last = true;
+			if (rate->last_change != 0 && rate->staleness_count < capacity)
+				rate->staleness[rate->staleness_count++] = (float)stm_ms(stm_diff(now, rate->last_change));
+		}
+	}
+	double sampled = stm_sec(stm_since(start));
+
+	display_table_t updates = tracking_table("trackingRate", "trackingRateUpdates", "xrLocateSpace",
+		"Source", "Updates per second", "Between updates p50 / p99 (ms)");
+	display_table_t stale = tracking_table("trackingRate", "trackingRateStaleness", "xrLocateSpace",
+		"Source", "Staleness p50 / p99 / max (ms)", "Notes");
+	display_table_t flags = tracking_table("trackingRate", "trackingRateFlags", "XrSpaceLocationFlags",
+		"Source", "Valid / tracked reads", "Lost valid");
+	for (int32_t s = 0; s < tracking.count; s++) {
+		tracking_rate_t *rate = &rates[s];
+		const char      *name = tracking.sources[s].name;
+		qsort(rate->intervals, rate->interval_count,  sizeof(float), stats_float_cmp);
+		qsort(rate->staleness, rate->staleness_count, sizeof(float), stats_float_cmp);
+
+		updates.cols[0].add({ name });
+		updates.cols[1].add({ rate->changes > 0 ? new_string("%.1f", rate->changes / sampled) : "Never changed" });
+		updates.cols[2].add({ rate->interval_count > 0
+			? new_string("%.2f / %.2f", stats_percentile(rate->intervals, rate->interval_count, 0.5f), stats_percentile(rate->intervals, rate->interval_count, 0.99f))
+			: "-" });
+
+		stale.cols[0].add({ name });
+		stale.cols[1].add({ rate->staleness_count > 0
+			? new_string("%.2f / %.2f / %.2f",
+				stats_percentile(rate->staleness, rate->staleness_count, 0.5f),
+				stats_percentile(rate->staleness, rate->staleness_count, 0.99f),
+				stats_percentile(rate->staleness, rate->staleness_count, 1.0f))
+			: "-" });
+		if      (rate->valid == 0)                                       stale.cols[2].add({ "Never valid" });
+		else if (rate->changes >= rate->valid * tracking_extrapolated)   stale.cols[2].add({ "Changes on nearly every read, the runtime extrapolates to the time asked for" });
+		else if (rate->changes == 0)                                     stale.cols[2].add({ "Valid, but never moved" });
+		else                                                             stale.cols[2].add({ "Time since the pose last changed, each time it was read" });
+
+		flags.cols[0].add({ name });
+		flags.cols[1].add({ new_string("%.2f%% / %.2f%%", rate->valid * 100.0 / rate->samples, rate->tracked * 100.0 / rate->samples) });
+		flags.cols[2].add({ new_string("%lld times, %.1f per minute", (long long)rate->dropouts, rate->dropouts * 60.0 / sampled) });
+	}
+	tracking_add_unavailable(&updates, &spaces, &tracking);
+	updates.cols[0].add({ "Sampling" });
+	updates.cols[1].add({ new_string("%.0f reads per second", reads / sampled) });
+	updates.cols[2].add({ has_clock ? "Every source, at the time of each read" : "Every source, at the latest predicted display time" });
+	xr_tables.add(updates);
+	xr_tables.add(stale);
+	xr_tables.add(flags);
+
+	for (int32_t s = 0; s < tracking.count; s++) {
+		free(rates[s].intervals);
+		free(rates[s].staleness);
+	}
+	tracking_destroy(&tracking);
+	spaces_session_stop(&spaces);
+}
+
+///////////////////////////////////////////
+
+void tracking_prediction(xr_settings_t settings, float seconds, const char *csv_file) {
+	settings = session_settings(settings);
+
+	display_table_t table = tracking_table("trackingPrediction", "trackingPredictionError", "xrLocateSpace",
+		"Source, horizon", "Position error p50 / p95 / p99 (mm)", "Angle error p50 / p95 / p99 (deg)");
+
+	spaces_t       spaces = {};
+	spaces_frame_t frame  = {};
+	const char    *error  = spaces_session_start(settings, &spaces, &frame);
+	if (error) {
+		table.error = error;
+		xr_tables.add(table);
+		return;
+	}
+	// Predictions are asked for from now, which needs the runtime's clock
+	if (session_xr_time(stm_now()) == 0) {
+		table.error = "Needs XR_KHR_convert_timespec_time, or XR_KHR_win32_convert_performance_counter_time on Windows";
+		xr_tables.add(table);
+		spaces_session_stop(&spaces);
+		return;
+	}
+	tracking_t tracking = {};
+	tracking_create(&tracking, &spaces);
+
+	tracking_pending_t *pending = (tracking_pending_t *)malloc(sizeof(tracking_pending_t) * tracking_pending_max * tracking_horizon_count);
+	int64_t             heads[tracking_horizon_count] = {};
+	int64_t             tails[tracking_horizon_count] = {};
+	tracking_ring_t     ring = {};
+	ring.capacity = tracking_ring_capacity;
+	ring.errors   = (tracking_error_t *)malloc(sizeof(tracking_error_t) * ring.capacity);
+	XrPosef                poses [XR_HAND_JOINT_COUNT_EXT];
+	XrHandJointLocationEXT joints[XR_HAND_JOINT_COUNT_EXT];
+
+	// Queries stop after `seconds`, and the last of them are checked once
+	// they've settled
+	int64_t  queries  = 0;
+	int64_t  skipped  = 0;
+	uint64_t start    = stm_now();
+	XrTime   start_xr = session_xr_time(start);
+	while (stm_sec(stm_since(start)) < seconds + tracking_settle_ms / 1000.0f) {
+		double next_ns = queries * (tracking_query_ms * 1000000.0);
+		while (stm_ns(stm_since(start)) < next_ns) {
+			if (next_ns - stm_ns(stm_since(start)) > 200000) std::this_thread::sleep_for(std::chrono::microseconds(100));
+			else                                            std::this_thread::yield();
+		}
+		queries += 1;
+
+		XrTime now = session_xr_time(stm_now());
+		if (stm_sec(stm_since(start)) < seconds) {
+			for (int32_t h = 0; h < tracking_horizon_count; h++) {
+				if (tails[h] - heads[h] >= tracking_pending_max) continue;
+				tracking_pending_t *entry = &pending[h * tracking_pending_max + tails[h] % tracking_pending_max];
+				entry->target = now + (XrTime)(tracking_horizons_ms[h] * 1000000);
+				for (int32_t s = 0; s < tracking.count; s++) {
+					XrSpaceLocationFlags flags = tracking_locate(&tracking, &tracking.sources[s], spaces.base, entry->target, poses, joints);
+					entry->valid[s] = (flags & tracking_valid_bits) == tracking_valid_bits;
+					entry->poses[s] = poses[XR_HAND_JOINT_PALM_EXT];
+				}
+				tails[h] += 1;
+			}
+		}
+
+		for (int32_t h = 0; h < tracking_horizon_count; h++) {
+			while (heads[h] < tails[h]) {
+				tracking_pending_t *entry = &pending[h * tracking_pending_max + heads[h] % tracking_pending_max];
+				if (entry->target + (XrTime)(tracking_settle_ms * 1000000) > now) break;
+				for (int32_t s = 0; s < tracking.count; s++) {
+					XrSpaceLocationFlags flags = tracking_locate(&tracking, &tracking.sources[s], spaces.base, entry->target, poses, joints);
+					if (!entry->valid[s] || (flags & tracking_valid_bits) != tracking_valid_bits) {
+						skipped += 1;
+						continue;
+					}
+					tracking_error_t result = tracking_pose_error(&entry->poses[s], &poses[XR_HAND_JOINT_PALM_EXT]);
+					result.time_ms = (float)((entry->target - (XrTime)(tracking_horizons_ms[h] * 1000000) - start_xr) / 1000000.0);
+					result.source  = (uint8_t)s;
+					result.horizon = (uint8_t)h;
+					tracking_ring_add(&ring, &result);
+				}
+				heads[h] += 1;
+			}
+		}
+	}
+
+	// Percentiles for each source and horizon, from what's still in the ring
+	int32_t kept     = ring.count < ring.capacity ? (int32_t)ring.count : ring.capacity;
+	float  *position = (float *)malloc(sizeof(float) * kept);
+	float  *angle    = (float *)malloc(sizeof(float) * kept);
+	for (int32_t s = 0; s < tracking.count; s++) {
+		for (int32_t h = 0; h < tracking_horizon_count; h++) {
+			int32_t count = 0;
+			for (int32_t i = 0; i < kept; i++) {
+				const tracking_error_t *e = &ring.errors[i];
+				if (e->source != s || e->horizon != h) continue;
+				position[count] = e->position_mm;
+				angle   [count] = e->angle_deg;
+				count += 1;
+			}
+			qsort(position, count, sizeof(float), stats_float_cmp);
+			qsort(angle,    count, sizeof(float), stats_float_cmp);
+
+			table.cols[0].add({ new_string("%s, +%g ms", tracking.sources[s].name, tracking_horizons_ms[h]) });
+			if (count == 0) {
+				table.cols[1].add({ "Never valid" });
+				table.cols[2].add({ "-" });
+				continue;
+			}
+			table.cols[1].add({ new_string("%.2f / %.2f / %.2f",
+				stats_percentile(position, count, 0.5f), stats_percentile(position, count, 0.95f), stats_percentile(position, count, 0.99f)) });
+			table.cols[2].add({ new_string("%.2f / %.2f / %.2f",
+				stats_percentile(angle, count, 0.5f), stats_percentile(angle, count, 0.95f), stats_percentile(angle, count, 0.99f)) });
+		}
+	}
+	tracking_add_unavailable(&table, &spaces, &tracking);
+	table.cols[0].add({ "Errors" });
+	table.cols[1].add({ ring.count > ring.capacity
+		? new_string("%lld, the latest %d kept", (long long)ring.count, ring.capacity)
+		: new_string("%lld", (long long)ring.count) });
+	table.cols[2].add({ new_string("%lld left out for an invalid pose, each located again %g ms after its time", (long long)skipped, tracking_settle_ms) });
+	xr_tables.add(table);
+
+	if (csv_file && ring.count > 0) {
+		if (tracking_csv(&ring, &tracking, csv_file)) printf("Wrote %d errors to %s\n", kept, csv_file);
+		else                                          printf("Couldn't write %s\n", csv_file);
+	}
+
+	free(position);
+	free(angle);
+	free(ring.errors);
+	free(pending);
+	tracking_destroy(&tracking);
+	spaces_session_stop(&spaces);
+}
+
+///////////////////////////////////////////
+
+static void tracking_ring_add(tracking_ring_t *ring, const tracking_error_t *error) {
+	ring->errors[ring->count % ring->capacity] = *error;
+	ring->count += 1;
+}
+
+///////////////////////////////////////////
+
+static tracking_error_t tracking_pose_error(const XrPosef *predicted, const XrPosef *actual) {
+	tracking_error_t result = {};
+	float dx = predicted->position.x - actual->position.x;
+	float dy = predicted->position.y - actual->position.y;
+	float dz = predicted->position.z - actual->position.z;
+	result.position_mm = sqrtf(dx*dx + dy*dy + dz*dz) * 1000;
+
+	// The angle of the rotation between them, either sign of quaternion
+	const XrQuaternionf *a = &predicted->orientation;
+	const XrQuaternionf *b = &actual   ->orientation;
+	float dot = fabsf(a->x*b->x + a->y*b->y + a->z*b->z + a->w*b->w);
+	if (dot > 1) dot = 1;
+	result.angle_deg = 2 * acosf(dot) * (180.0f / 3.14159265f);
+	return result;
+}
+
+///////////////////////////////////////////
+
+static bool tracking_csv(const tracking_ring_t *ring, const tracking_t *tracking, const char *csv_file) {
+	FILE *fp = fopen(csv_file, "w");
+	if (!fp) return false;
+
+	// Oldest first
+	int64_t first = ring->count > ring->capacity ? ring->count - ring->capacity : 0;
+	fprintf(fp, "time_ms,source,horizon_ms,position_error_mm,angle_error_deg\n");
+	for (int64_t i = first; i < ring->count; i++) {
+		const tracking_error_t *e = &ring->errors[i % ring->capacity];
+		fprintf(fp, "%.3f,%s,%g,%.4f,%.4f\n",
+			e->time_ms,
+			tracking->sources[e->source].name,
+			tracking_horizons_ms[e->horizon],
+			e->position_mm,
+			e->angle_deg);
+	}
+	fclose(fp);
+	return true;
+}
+
+///////////////////////////////////////////
+
+static void tracking_add_unavailable(display_table_t *table, const spaces_t *spaces, const tracking_t *tracking) {
+	if (spaces->action_error) {
+		table->cols[0].add({ "Controllers" });
+		table->cols[1].add({ "-" });
+		table->cols[2].add({ spaces->action_error });
+	}
+	if (tracking->hand_error) {
+		table->cols[0].add({ "Hands" });
+		table->cols[1].add({ "-" });
+		table->cols[2].add({ tracking->hand_error });
+	}
+	if (spaces->gaze_error) {
+		table->cols[0].add({ "Eye gaze" });
+		table->cols[1].add({ "-" });
+		table->cols[2].add({ spaces->gaze_error });
+	}
+}
+
+///////////////////////////////////////////
+
+static display_table_t tracking_table(const char *name_func, const char *name_type, const char *spec, const char *col0, const char *col1, const char *col2) {
+	display_table_t table = {};
+	table.name_func    = name_func;
+	table.name_type    = name_type;
+	table.spec         = spec;
+	table.tag          = display_tag_misc;
+	table.column_count = 3;
+	table.header_row   = true;
+	table.cols[0].add({ col0 });
+	table.cols[1].add({ col1 });
+	table.cols[2].add({ col2 });
+	return table;
+}
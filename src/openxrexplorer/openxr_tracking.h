@@ -0,0 +1,28 @@
+#pragma once
+
+#include "openxr_info.h"
+
+#include <stdint.h>
+
+// How the runtime's tracking behaves over time, from a thread of its own
+// while the session runs, see openxr_spaces.h. The sources are the head
+// (the VIEW space), the controllers' grip and aim poses, the hands'
+// joints with XR_EXT_hand_tracking, and the eye gaze with
+// XR_EXT_eye_gaze_interaction, each where the runtime has them.
+
+/*** Signatures **************************/
+
+// -trackingRate: locates every source, 2000 times a second for `seconds`,
+// and counts a new sample each time a pose comes back different. Reports
+// the effective update rate of each source, how stale poses are by the
+// time they're read, and how often they lose their valid and tracked
+// flags. Everything is allocated before sampling starts.
+void tracking_rate(xr_settings_t settings, float seconds);
+
+// -trackingPrediction: every 10 ms for `seconds`, locates every source at
+// now plus 0 to 50 ms, and locates the same times again once they're
+// 100 ms in the past, when the runtime has real samples for them. Reports
+// the position and angle error of each horizon for each source, and
+// writes every error to csv_file if it isn't null. Errors go in a ring of
+// fixed size, so a long run keeps only the latest of them.
+void tracking_prediction(xr_settings_t settings, float seconds, const char *csv_file);
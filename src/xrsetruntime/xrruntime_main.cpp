@@ -1,9 +1,15 @@
 #include "xrruntime.h"
+#include "xrmanifest.h"
+#include "xrpreflight.h"
 
 #include <stdint.h>
 #include <stdio.h>
 #include <string.h>
 #include <ctype.h>
+#include <stdlib.h>
+#include <chrono>
+
+#include <nlohmann/json.hpp>
 
 /*** Global Variables ********************/
 
@@ -15,12 +21,20 @@ int32_t    runtime_count = 0;
 void show_runtimes   ();
 void show_help       ();
 bool set_runtime     (const char *flag);
-bool activate_runtime(int32_t index);
+bool activate_runtime(const char *manifest_file);
 int  strcmp_nocase   (char const *a, char const *b);
+void bench_manifests (const char **files, int32_t file_count);
+char*read_file       (const char *file);
 
 /*** Code ********************************/
 
 int main(int32_t arg_count, const char **args) {
+#if !defined(_WIN32)
+	// runtime_preflight starts us like this from --list, it never returns
+	if (arg_count == 4 && strcmp(args[1], "-preflightWorker") == 0)
+		runtime_preflight_worker(args[2], args[3]);
+#endif
+
 	if (!load_runtimes("runtimes.txt", &runtimes, &runtime_count))
 		return -1;
 
@@ -32,6 +46,11 @@ int main(int32_t arg_count, const char **args) {
 		else if (strcmp(args[i], "--help") == 0 || strcmp(args[i], "-h") == 0 || strcmp(args[i], "/?") == 0) {
 			show_help();
 		}
+		else if (strcmp(args[i], "--bench-manifests") == 0) {
+			// Everything after this is a manifest file
+			bench_manifests(&args[i+1], arg_count - (i+1));
+			break;
+		}
 		else if (!set_runtime(args[i])) {
 			show_help();
 		}
@@ -43,10 +62,21 @@ int main(int32_t arg_count, const char **args) {
 ///////////////////////////////////////////
 
 void show_runtimes() {
+	// Load-test each runtime's library, so ones that are installed but
+	// broken don't look the same as ones that work.
+	preflight_result_t *results = (preflight_result_t*)malloc(sizeof(preflight_result_t) * (runtime_count > 0 ? runtime_count : 1));
+	runtime_preflight(runtimes, runtime_count, 5000, results);
+
 	for (int32_t i=0; i<runtime_count; i+=1) {
-		if (runtimes[i].present)
-			printf("%s\n", runtimes[i].name);
+		if (!runtimes[i].present) continue;
+
+		const preflight_result_t *result = &results[i];
+		if (result->status == preflight_ok)
+			printf("%-24s ok, %.1f ms, %+.1f MB\n", runtimes[i].name, result->load_ms, result->rss_delta / (1024.0 * 1024.0));
+		else
+			printf("%-24s %s: %s\n", runtimes[i].name, preflight_status_str(result->status), result->reason);
 	}
+	free(results);
 	if (runtime_count == 0) {
 		printf("No runtime found! Do you have one installed, and is it listed in xrsetruntime's xr_runtimes.txt file?\n");
 	}
@@ -61,8 +91,18 @@ Usage: xrsetruntime [option]
 Options:
 	--list      Displays a list of runtimes that are on the system and
 	            available. This list can be updated by modifying the 
-	            accompanying 'xr_runtimes.txt' file.
+	            accompanying 'xr_runtimes.txt' file. On Linux, manifests
+	            in the standard openxr/1 folders are found automatically.
+	            Each runtime's library is test loaded, and the load time,
+	            memory cost, or reason it failed is shown next to it.
 	--help      Show this help information!
+	--[manifest path]
+	            Sets the runtime that manifest file describes as active,
+	            listed or not. Under sudo, runtimes in your own folders
+	            may not be found by name, but their path always works.
+	--bench-manifests [manifest files...]
+	            Times the manifest parser against a full JSON DOM parse,
+	            using the given manifests or every one that was found.
 
 )_");
 	for (int32_t i=0; i<runtime_count; i+=1) {
@@ -79,11 +119,25 @@ Options:
 bool set_runtime(const char *flag) {
 	bool matched = false;
 	while (*flag == '-') flag++;
+
+	// A path is a manifest file rather than a runtime name
+	if (strchr(flag, '/') || strchr(flag, '\\')) {
+		runtime_manifest_t manifest;
+		if (!manifest_load_runtime(flag, &manifest) || manifest.library_path[0] == '\0') {
+			printf("%s isn't a runtime manifest!\n", flag);
+			return true;
+		}
+		if (activate_runtime(flag)) {
+			printf("Activated %s!\n", manifest.name[0] ? manifest.name : flag);
+		}
+		return true;
+	}
+
 	for (int32_t i = 0; i < runtime_count; i++) {
 		if (strcmp_nocase(flag, runtimes[i].name) == 0) {
 			matched = true;
 			if (runtimes[i].present) {
-				if (activate_runtime(i)) {
+				if (activate_runtime(runtimes[i].file)) {
 					printf("Activated %s!\n", runtimes[i].name);
 				}
 				return true;
@@ -99,6 +153,81 @@ bool set_runtime(const char *flag) {
 
 ///////////////////////////////////////////
 
+// The way load_runtimes used to read manifests, kept for comparison.
+static bool bench_parse_dom(const char *file, runtime_manifest_t *out_manifest) {
+	*out_manifest = {};
+	char *json = read_file(file);
+	if (!json) return false;
+
+	bool result = true;
+	try {
+		const auto manifest = nlohmann::json::parse(json);
+		auto copy = [](const nlohmann::json &obj, const char *key, char *dest, size_t dest_size) {
+			if (!obj.contains(key) || !obj.at(key).is_string()) return;
+			auto str = obj.at(key).get<std::string>();
+			if (str.size() + 1 <= dest_size) memcpy(dest, str.c_str(), str.size() + 1);
+		};
+		copy(manifest, "file_format_version", out_manifest->file_format_version, sizeof(out_manifest->file_format_version));
+		if (manifest.contains("runtime") && manifest.at("runtime").is_object()) {
+			const auto &runtime = manifest.at("runtime");
+			copy(runtime, "name",         out_manifest->name,         sizeof(out_manifest->name));
+			copy(runtime, "library_path", out_manifest->library_path, sizeof(out_manifest->library_path));
+			if (runtime.contains("functions") && runtime.at("functions").is_object())
+				copy(runtime.at("functions"), "xrNegotiateLoaderRuntimeInterface", out_manifest->negotiate_function, sizeof(out_manifest->negotiate_function));
+		}
+	} catch (const nlohmann::json::exception&) {
+		result = false;
+	}
+	free(json);
+	return result;
+}
+
+///////////////////////////////////////////
+
+void bench_manifests(const char **files, int32_t file_count) {
+	// With no files given, use every manifest load_runtimes could read
+	const char **found = nullptr;
+	if (file_count == 0) {
+		found = (const char **)malloc(sizeof(char *) * (runtime_count + 1));
+		for (int32_t i = 0; i < runtime_count; i++) {
+			if (runtimes[i].library_path[0] || runtimes[i].file_format_version[0])
+				found[file_count++] = runtimes[i].file;
+		}
+		files = found;
+	}
+	if (file_count == 0) {
+		printf("No runtime manifests to benchmark!\n");
+		return;
+	}
+
+	const int32_t iterations = 2000;
+	double total_dom  = 0;
+	double total_scan = 0;
+	printf("| %-48s | %10s | %10s | %7s | %-5s |\n", "manifest", "dom (us)", "scan (us)", "speedup", "match");
+	for (int32_t f = 0; f < file_count; f++) {
+		runtime_manifest_t dom, scan;
+
+		auto start = std::chrono::steady_clock::now();
+		for (int32_t i = 0; i < iterations; i++) bench_parse_dom(files[f], &dom);
+		auto mid   = std::chrono::steady_clock::now();
+		for (int32_t i = 0; i < iterations; i++) manifest_load_runtime(files[f], &scan);
+		auto end   = std::chrono::steady_clock::now();
+
+		double dom_us  = std::chrono::duration<double, std::micro>(mid - start).count() / iterations;
+		double scan_us = std::chrono::duration<double, std::micro>(end - mid  ).count() / iterations;
+		bool   match   = memcmp(&dom, &scan, sizeof(dom)) == 0;
+		total_dom  += dom_us;
+		total_scan += scan_us;
+
+		const char *name = strlen(files[f]) > 48 ? files[f] + strlen(files[f]) - 48 : files[f];
+		printf("| %-48s | %10.2f | %10.2f | %6.1fx | %-5s |\n", name, dom_us, scan_us, dom_us / scan_us, match ? "yes" : "NO");
+	}
+	printf("| %-48s | %10.2f | %10.2f | %6.1fx |       |\n", "total", total_dom, total_scan, total_dom / total_scan);
+	free(found);
+}
+
+///////////////////////////////////////////
+
 int32_t strcmp_nocase(char const *a, char const *b) {
 	for (;; a++, b++) {
 		int d = tolower((unsigned char)*a) - tolower((unsigned char)*b);
@@ -114,7 +243,7 @@ int32_t strcmp_nocase(char const *a, char const *b) {
 
 #define WIN32_LEAN_AND_MEAN
 #include <windows.h>
-bool activate_runtime(int32_t index) {
+bool activate_runtime(const char *manifest_file) {
 	// Reference powershell script, does the same thing
 	// Set-ItemProperty -Path $key -Name $name -Value $runtime
 	// $key     = "HKLM:\SOFTWARE\Khronos\OpenXR\1"
@@ -130,7 +259,7 @@ bool activate_runtime(int32_t index) {
 		return false;
 	}
 
-	if (RegSetValueEx(key, "ActiveRuntime", 0, REG_SZ, (LPBYTE)runtimes[index].file, (DWORD)(strlen(runtimes[index].file)+1)) != ERROR_SUCCESS) {
+	if (RegSetValueEx(key, "ActiveRuntime", 0, REG_SZ, (LPBYTE)manifest_file, (DWORD)(strlen(manifest_file)+1)) != ERROR_SUCCESS) {
 		printf("Failed to set registry key!\n");
 		RegCloseKey(key);
 		return false;
@@ -144,18 +273,26 @@ bool activate_runtime(int32_t index) {
 #include <unistd.h>
 #include <sys/stat.h>
 #include <errno.h>
+#include <limits.h>
 
-bool activate_runtime(int32_t index) {
+bool activate_runtime(const char *manifest_file) {
 	struct stat buffer;
 
 	const char *active_file = "/etc/xdg/openxr/1/active_runtime.json";
 
+	// The link has to work from wherever the loader reads it
+	char full_path[PATH_MAX];
+	if (realpath(manifest_file, full_path) == nullptr) {
+		perror("Couldn't find manifest - ");
+		return false;
+	}
+
 	if (lstat(active_file, &buffer) == 0) {
 		if (unlink(active_file) == -1) {
 			perror("Couldn't unlink manifest - ");
 			return false;
 		}
-		if (symlink(runtimes[index].file, active_file) == 0) {
+		if (symlink(full_path, active_file) == 0) {
 			return true;
 		}
 		perror("Couldn't link new manifest - ");